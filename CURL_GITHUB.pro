@@ -18,23 +18,60 @@ INCLUDEPATH += /usr/local/mysql/include/
 
 LIBS += -L/usr/local/mysql/lib -lmysqlclient
 LIBS += -lcurl
+LIBS += -lz
 
 HEADERS += \
           SysConfig.h \
+          ccoursereplica.h \
+          ccoursesnapshot.h \
+          ccoursetable.h \
+          ccurlmultiloop.h \
+          ccurlshare.h \
+          cdbasyncengine.h \
+          cdbbatchwriter.h \
           cdbconnectpool.h \
           cdbmanager.h \
+          cdnscache.h \
+          cftpasyncengine.h \
+          cftpscheduler.h \
           cftpsclient.h \
+          chttpasyncengine.h \
+          chttpcache.h \
           chttpclient.h \
+          chttphostlimiter.h \
+          chttpmetrics.h \
+          chttpretrypolicy.h \
+          clatencyhistogram.h \
           cmysql.h \
           cresourceinit.h \
+          csqlformat.h \
+          ctemporalparser.h \
+          cwkbparser.h \
           data_type_defination.h \
           threadPool.hpp
 
 SOURCES += \
+        ccoursereplica.cpp \
+        ccoursesnapshot.cpp \
+        ccoursetable.cpp \
+        ccurlmultiloop.cpp \
+        ccurlshare.cpp \
+        cdbasyncengine.cpp \
+        cdbbatchwriter.cpp \
         cdbconnectpool.cpp \
         cdbmanager.cpp \
+        cdnscache.cpp \
+        cftpasyncengine.cpp \
+        cftpscheduler.cpp \
         cftpsclient.cpp \
+        chttpasyncengine.cpp \
+        chttpcache.cpp \
         chttpclient.cpp \
+        chttphostlimiter.cpp \
+        chttpmetrics.cpp \
+        chttpretrypolicy.cpp \
+        clatencyhistogram.cpp \
         cmysql.cpp \
         cresourceinit.cpp \
+        csqlformat.cpp \
         main.cpp
@@ -0,0 +1,181 @@
+#include "ccoursereplica.h"
+
+#include "cmysql.h"
+#include "csqlformat.h"
+
+CCourseReplica::CCourseReplica(const std::chrono::milliseconds pollInterval/*=1000ms*/, const std::string & strVersionColumn/*=updated_at*/,
+                               CDBManager & dbManager/*=DBOPT*/, const std::chrono::milliseconds overlap/*=5000ms*/)
+    : m_dbManager(dbManager), m_strVersionColumn(strVersionColumn), m_pollInterval(pollInterval), m_overlap(overlap),
+      m_pState(std::make_shared<const StReplicaState>())
+{
+    this->reload();
+    this->m_pollThread = std::thread(&CCourseReplica::pollLoop, this);
+}
+
+CCourseReplica::~CCourseReplica()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxPoll);
+        this->m_bStop = true;
+    }
+    this->m_cvPoll.notify_one();
+    this->m_pollThread.join();
+}
+
+std::shared_ptr<const CCourseReplica::StReplicaState> CCourseReplica::snapshot() const
+{
+    return std::atomic_load(&this->m_pState);
+}
+
+std::optional<StCourse> CCourseReplica::find(const std::int64_t nID) const
+{
+    auto && pState = this->snapshot();
+    auto iter = pState->mpCourses.find(nID);
+    if(pState->mpCourses.end() == iter)
+        return std::nullopt;
+
+    return iter->second;
+}
+
+size_t CCourseReplica::size() const
+{
+    return this->snapshot()->mpCourses.size();
+}
+
+bool CCourseReplica::reload()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxWriter);
+    return this->reloadLocked();
+}
+
+bool CCourseReplica::reloadLocked()
+{
+    auto && records = this->fetch(std::string());
+    if(!records.has_value())
+        return false;
+
+    auto pState = std::make_shared<StReplicaState>();
+    try{
+        pState->mpCourses.reserve(records->size());
+        for(size_t ii = 0; ii < records->size(); ii++){
+            StCourse && stCourse = CMySQL::toCourse(*records, ii);
+            pState->mpCourses[stCourse.nID] = std::move(stCourse);
+        }
+
+        if(!records->empty())
+            pState->strWatermark = this->watermarkOf(*records);
+    }catch(const std::exception & e){
+        this->setErrMsg(std::string("failed to decode course:") + e.what());
+        return false;
+    }
+
+    pState->nGeneration = std::atomic_load(&this->m_pState)->nGeneration + 1;
+    std::atomic_store(&this->m_pState, std::shared_ptr<const StReplicaState>(std::move(pState)));
+    return true;
+}
+
+bool CCourseReplica::refresh()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxWriter);
+
+    auto && pCurrent = std::atomic_load(&this->m_pState);
+    if(pCurrent->strWatermark.empty()){
+        //nothing loaded yet, such as the table being empty or the initial load failed
+        return this->reloadLocked();
+    }
+
+    //'>=' rather than '>', the rows committed later but having the same version as the watermark NOT being missed, and
+    //the overlap behind it being re-read for the ones having an older version, the rows fetched again being applied idempotently
+    std::string strCondition = this->m_strVersionColumn + std::string(" >= ") + CSQLFormat::quote(pCurrent->strWatermark);
+    if(this->m_overlap.count() > 0)
+        strCondition += std::string(" - interval ") + std::to_string(this->m_overlap.count() * 1000) + std::string(" microsecond");
+
+    auto && records = this->fetch(strCondition);
+    if(!records.has_value())
+        return false;
+
+    //nothing changed besides the rows in the overlap, which being compared before copying the state
+    std::vector<StCourse> vecChanged;
+    std::string strWatermark = pCurrent->strWatermark;
+    try{
+        for(size_t ii = 0; ii < records->size(); ii++){
+            StCourse && stCourse = CMySQL::toCourse(*records, ii);
+            auto iter = pCurrent->mpCourses.find(stCourse.nID);
+            if(pCurrent->mpCourses.end() == iter || CSQLFormat::toValues(iter->second) != CSQLFormat::toValues(stCourse))
+                vecChanged.emplace_back(std::move(stCourse));
+        }
+
+        if(!records->empty())
+            strWatermark = this->watermarkOf(*records);
+    }catch(const std::exception & e){
+        this->setErrMsg(std::string("failed to decode course:") + e.what());
+        return false;
+    }
+
+    if(vecChanged.empty())
+        return true;
+
+    //copy on write, the readers holding the current state NOT being affected
+    auto pState = std::make_shared<StReplicaState>(*pCurrent);
+    for(auto & stCourse : vecChanged)
+        pState->mpCourses[stCourse.nID] = std::move(stCourse);
+
+    pState->strWatermark = std::move(strWatermark);
+    pState->nGeneration = pCurrent->nGeneration + 1;
+    std::atomic_store(&this->m_pState, std::shared_ptr<const StReplicaState>(std::move(pState)));
+    return true;
+}
+
+std::string CCourseReplica::getErrMsg() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxErrMsg);
+    return this->m_strErrMsg;
+}
+
+void CCourseReplica::setErrMsg(const std::string & strErrMsg)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxErrMsg);
+    this->m_strErrMsg = strErrMsg;
+}
+
+void CCourseReplica::pollLoop()
+{
+    std::unique_lock<std::mutex> lock(this->m_mtxPoll);
+    while(!this->m_bStop){
+        this->m_cvPoll.wait_for(lock, this->m_pollInterval, [this](){ return this->m_bStop; });
+        if(this->m_bStop)
+            break;
+
+        lock.unlock();
+        this->refresh();
+        lock.lock();
+    }
+}
+
+//the raw cell rather than getItem, which stopping at the first space, such '2024-05-01 12:34:56' NOT being cut to the date
+std::string CCourseReplica::watermarkOf(const query_result & records) const
+{
+    return records.at(records.size() - 1).at(this->m_strVersionColumn);
+}
+
+std::optional<query_result> CCourseReplica::fetch(const std::string & strCondition)
+{
+    std::string strSQL = std::string("select * from course");
+    if(!strCondition.empty())
+        strSQL += std::string(" where ") + strCondition;
+    strSQL += std::string(" order by ") + this->m_strVersionColumn;
+
+    auto && query_result = this->m_dbManager.query(strSQL);
+    if(!query_result.has_value()){
+        this->setErrMsg(std::string("failed to submit query:") + strSQL);
+        return std::nullopt;
+    }
+
+    auto && pairResult = query_result->get();
+    if(!pairResult.first.empty()){
+        this->setErrMsg(pairResult.first);
+        return std::nullopt;
+    }
+
+    return std::move(pairResult.second);
+}
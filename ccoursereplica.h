@@ -0,0 +1,105 @@
+#ifndef CCOURSEREPLICA_H
+#define CCOURSEREPLICA_H
+
+/*
+ * CCourseReplica keeps an in-process copy of table course fresh by polling only the rows changed since the last poll,
+ * such the table having a monotonically increasing version column, such as
+ *
+ *  updated_at timestamp(6) NOT NULL DEFAULT CURRENT_TIMESTAMP(6) ON UPDATE CURRENT_TIMESTAMP(6), INDEX(updated_at)
+ *
+ * The rows being kept in an immutable state indexed by the primary key, and each refresh copying the state, applying
+ * the changed rows onto the copy and publishing it by std::atomic_store, the readers keeping the state they loaded
+ * valid as long as they holding it. NOTE: std::atomic_load and std::atomic_store of std::shared_ptr NOT being lock
+ * free, libstdc++ guarding them by a spinlock of a global pool, so the readers taking that lock for the copy of the
+ * pointer only, NOT the lock of the writer, and never waiting for a refresh querying the database or copying the rows.
+ *
+ * The version being taken by the row when written rather than when committed, a transaction committing after a poll
+ * may carry a version older than the watermark of that poll, so each poll re-reading the window of overlap behind the
+ * watermark, the rows fetched again being compared and applied idempotently. The overlap must be longer than the
+ * longest transaction writing the table, the rows committed later than that being picked up by reload only, and being
+ * 0 for the version column NOT being a time, such as an integer one, which being compared as '>=' the watermark then.
+ *
+ * The rows deleted being invisible to the version column, which being picked up by reload only, so the soft delete
+ * being preferred for such the tables.
+ */
+
+#include "cdbmanager.h"
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <optional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+
+class CCourseReplica
+{
+public:
+    typedef struct ST_replicaState{
+        std::unordered_map<std::int64_t, StCourse> mpCourses;//indexed by id
+        std::string strWatermark;//the largest version fetched
+        std::uint64_t nGeneration = 0;//increased on each change applied
+    }StReplicaState;
+
+    //load the whole table, then poll the changed rows every interval in the background, the overlap behind the watermark
+    //being re-read by each poll
+    explicit CCourseReplica(const std::chrono::milliseconds pollInterval = std::chrono::milliseconds(1000),
+                            const std::string & strVersionColumn = std::string("updated_at"), CDBManager & dbManager = DBOPT,
+                            const std::chrono::milliseconds overlap = std::chrono::milliseconds(5000));
+    ~CCourseReplica();
+
+    //copy constructor and assignment operator prohibited
+    CCourseReplica(const CCourseReplica & ) = delete;
+    CCourseReplica(const CCourseReplica && ) = delete;
+    CCourseReplica & operator=(const CCourseReplica &) = delete;
+    CCourseReplica & operator=(const CCourseReplica &&) = delete;
+
+    //the current state, the rows in it never changing, NOT waiting for the refreshes, holding it rather than calling
+    //this for each row, each call taking the spinlock of std::atomic_load
+    std::shared_ptr<const StReplicaState> snapshot() const;
+
+    std::optional<StCourse> find(const std::int64_t nID) const;
+    size_t size() const;
+
+    //reload the whole table, the rows deleted being removed
+    bool reload();
+
+    //fetch and apply the rows changed since the last refresh right now
+    bool refresh();
+
+    std::string getErrMsg() const;
+
+private:
+    void pollLoop();
+    bool reloadLocked();//m_mtxWriter being held
+    void setErrMsg(const std::string & strErrMsg);
+
+    //the version of the last row of the records, being ordered by the version column
+    std::string watermarkOf(const query_result & records) const;
+
+    //query the rows of the given condition, ordered by the version column
+    std::optional<query_result> fetch(const std::string & strCondition);
+
+private:
+    CDBManager & m_dbManager;
+    std::string m_strVersionColumn;
+    std::chrono::milliseconds m_pollInterval;
+    std::chrono::milliseconds m_overlap;
+
+    //accessed by std::atomic_load and std::atomic_store only
+    std::shared_ptr<const StReplicaState> m_pState;
+
+    std::mutex m_mtxWriter;//serializing reload and refresh
+
+    mutable std::mutex m_mtxErrMsg;
+    std::string m_strErrMsg;
+
+    std::mutex m_mtxPoll;
+    std::condition_variable m_cvPoll;
+    bool m_bStop = false;
+    std::thread m_pollThread;
+};
+
+#endif // CCOURSEREPLICA_H
@@ -0,0 +1,286 @@
+#include "ccoursesnapshot.h"
+
+#include "cmysql.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <vector>
+
+namespace {
+    constexpr size_t g_nAlignment = 64;//cache line, the columns being aligned for the vectorized kernels
+
+    size_t alignUp(const size_t nValue)
+    {
+        return (nValue + g_nAlignment - 1) / g_nAlignment * g_nAlignment;
+    }
+
+    //write all the bytes, retrying on the partial writes
+    bool writeAll(const int nFd, const void * pData, size_t nSize)
+    {
+        const char * pBytes = static_cast<const char *>(pData);
+        while(nSize > 0){
+            const ssize_t nWritten = write(nFd, pBytes, nSize);
+            if(nWritten < 0){
+                if(EINTR == errno)
+                    continue;
+                return false;
+            }
+
+            pBytes += nWritten;
+            nSize -= static_cast<size_t>(nWritten);
+        }
+
+        return true;
+    }
+
+    //make the rename in the directory of the file durable, the new entry being lost on a crash otherwise
+    bool syncDir(const std::string & strPath)
+    {
+        const size_t nSlash = strPath.rfind('/');
+        const std::string strDir = std::string::npos == nSlash ? std::string(".") : (0 == nSlash ? std::string("/") : strPath.substr(0, nSlash));
+
+        const int nFd = open(strDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(-1 == nFd)
+            return false;
+
+        const bool bOK = 0 == fsync(nFd);
+        close(nFd);
+        return bOK;
+    }
+}
+
+CCourseSnapshot::CCourseSnapshot(const std::string & strPath, const bool bVerify/*=true*/)
+{
+    const int nFd = open(strPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(-1 == nFd){
+        this->m_strErrMsg = std::string("failed to open snapshot ") + strPath + std::string(":") + strerror(errno);
+        return ;
+    }
+
+    struct stat stStat{};
+    if(-1 == fstat(nFd, &stStat) || static_cast<size_t>(stStat.st_size) < sizeof(StSnapshotHeader)){
+        this->m_strErrMsg = std::string("invalid snapshot size:") + strPath;
+        close(nFd);
+        return ;
+    }
+
+    //the mapping staying valid after the fd closed, and after the file being replaced by rename
+    void * pMapped = mmap(nullptr, static_cast<size_t>(stStat.st_size), PROT_READ, MAP_PRIVATE, nFd, 0);
+    close(nFd);
+    if(MAP_FAILED == pMapped){
+        this->m_strErrMsg = std::string("failed to map snapshot ") + strPath + std::string(":") + strerror(errno);
+        return ;
+    }
+
+    this->m_pData = static_cast<const unsigned char *>(pMapped);
+    this->m_nMappedSize = static_cast<size_t>(stStat.st_size);
+
+    const StSnapshotHeader * pHeader = reinterpret_cast<const StSnapshotHeader *>(this->m_pData);
+    const StSnapshotHeader stExpected;
+    if(0 != std::memcmp(pHeader->szMagic, stExpected.szMagic, sizeof(stExpected.szMagic))){
+        this->m_strErrMsg = std::string("invalid snapshot magic:") + strPath;
+        return ;
+    }
+
+    if(pHeader->nVersion != stExpected.nVersion || pHeader->nByteOrder != stExpected.nByteOrder){
+        this->m_strErrMsg = std::string("unsupported snapshot version or byte order:") + strPath;
+        return ;
+    }
+
+    //the size of each column being checked against the row count, such the accessors never reading beyond the mapping
+    const std::uint64_t nRows = pHeader->nRowCount;
+    const size_t arrElementSize[_EN_INVALID_COL_LAST_] = {
+        sizeof(std::int64_t), sizeof(std::int64_t), sizeof(float), sizeof(double), sizeof(int), sizeof(StDate),
+        sizeof(StTime), sizeof(StDateTime), sizeof(StPoint<int>), sizeof(StRect<int>), sizeof(std::uint64_t), 1
+    };
+
+    std::uint64_t nChecksum = 0;
+    for(int ii = 0; ii < _EN_INVALID_COL_LAST_; ii++){
+        const StSnapshotColumn & stColumn = pHeader->arrColumns[ii];
+        const std::uint64_t nRowsExpected = (_EN_COL_NAME_OFFSET_ == ii) ? nRows + 1 : nRows;
+        const bool bSizeOK = (_EN_COL_NAME_ARENA_ == ii) || (stColumn.nSize == nRowsExpected * arrElementSize[ii]);
+        if(!bSizeOK || 0 != stColumn.nOffset % g_nAlignment || stColumn.nOffset < sizeof(StSnapshotHeader)
+            || stColumn.nOffset > this->m_nMappedSize || stColumn.nSize > this->m_nMappedSize - stColumn.nOffset){
+            this->m_strErrMsg = std::string("invalid snapshot column layout:") + strPath;
+            return ;
+        }
+
+        if(bVerify)
+            nChecksum = nChecksum * 31 + checksum(this->m_pData + stColumn.nOffset, stColumn.nSize);
+    }
+
+    if(bVerify && nChecksum != pHeader->nChecksum){
+        this->m_strErrMsg = std::string("snapshot checksum mismatch:") + strPath;
+        return ;
+    }
+
+    this->m_pHeader = pHeader;
+}
+
+CCourseSnapshot::~CCourseSnapshot()
+{
+    if(this->m_pData)
+        munmap(const_cast<unsigned char *>(this->m_pData), this->m_nMappedSize);
+}
+
+bool CCourseSnapshot::isValid() const
+{
+    return nullptr != this->m_pHeader;
+}
+
+const std::string & CCourseSnapshot::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+size_t CCourseSnapshot::size() const
+{
+    return this->m_pHeader ? static_cast<size_t>(this->m_pHeader->nRowCount) : 0;
+}
+
+std::uint64_t CCourseSnapshot::createTime() const
+{
+    return this->m_pHeader ? this->m_pHeader->nCreateTime : 0;
+}
+
+std::string_view CCourseSnapshot::name(const size_t nIndex) const
+{
+    if(nIndex >= this->size())
+        throw std::out_of_range("invalid nIndex access...");
+
+    const std::uint64_t * pOffsets = this->column<std::uint64_t>(_EN_COL_NAME_OFFSET_);
+    const std::uint64_t nArenaSize = this->m_pHeader->arrColumns[_EN_COL_NAME_ARENA_].nSize;
+    if(pOffsets[nIndex] > pOffsets[nIndex + 1] || pOffsets[nIndex + 1] > nArenaSize)
+        throw std::out_of_range("invalid name offset in snapshot");
+
+    return std::string_view(this->column<char>(_EN_COL_NAME_ARENA_) + pOffsets[nIndex], pOffsets[nIndex + 1] - pOffsets[nIndex]);
+}
+
+StCourse CCourseSnapshot::row(const size_t nIndex) const
+{
+    StCourse stCourse;
+    stCourse.strCourseName = std::string(this->name(nIndex));//checking nIndex
+    stCourse.nID = this->ids()[nIndex];
+    stCourse.nRelatedID = this->relatedIDs()[nIndex];
+    stCourse.fFloat = this->floats()[nIndex];
+    stCourse.fDouble = this->doubles()[nIndex];
+    stCourse.nDecimal = this->decimals()[nIndex];
+    stCourse.date = this->dates()[nIndex];
+    stCourse.time = this->times()[nIndex];
+    stCourse.datetime = this->datetimes()[nIndex];
+    stCourse.point = this->points()[nIndex];
+    stCourse.rect = this->rects()[nIndex];
+    return stCourse;
+}
+
+bool CCourseSnapshot::save(const CCourseTable & table, const std::string & strPath, std::string & strErrMsg)
+{
+    const std::pair<const void *, size_t> arrColumns[_EN_INVALID_COL_LAST_] = {
+        {table.ids().data(), table.ids().size() * sizeof(std::int64_t)},
+        {table.relatedIDs().data(), table.relatedIDs().size() * sizeof(std::int64_t)},
+        {table.floats().data(), table.floats().size() * sizeof(float)},
+        {table.doubles().data(), table.doubles().size() * sizeof(double)},
+        {table.decimals().data(), table.decimals().size() * sizeof(int)},
+        {table.dates().data(), table.dates().size() * sizeof(StDate)},
+        {table.times().data(), table.times().size() * sizeof(StTime)},
+        {table.datetimes().data(), table.datetimes().size() * sizeof(StDateTime)},
+        {table.points().data(), table.points().size() * sizeof(StPoint<int>)},
+        {table.rects().data(), table.rects().size() * sizeof(StRect<int>)},
+        {table.nameOffsets().data(), table.nameOffsets().size() * sizeof(std::uint64_t)},
+        {table.nameArena().data(), table.nameArena().size()},
+    };
+
+    StSnapshotHeader stHeader;
+    stHeader.nRowCount = table.size();
+    stHeader.nCreateTime = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                                      std::chrono::system_clock::now().time_since_epoch()).count());
+
+    size_t nOffset = alignUp(sizeof(StSnapshotHeader));
+    for(int ii = 0; ii < _EN_INVALID_COL_LAST_; ii++){
+        stHeader.arrColumns[ii].nOffset = nOffset;
+        stHeader.arrColumns[ii].nSize = arrColumns[ii].second;
+        stHeader.nChecksum = stHeader.nChecksum * 31 + checksum(static_cast<const unsigned char *>(arrColumns[ii].first), arrColumns[ii].second);
+        nOffset = alignUp(nOffset + arrColumns[ii].second);
+    }
+
+    //written into the temporary file in the same directory, then renamed, which being atomic, the file being unique
+    //for each save, so the saves running at once NOT truncating or renaming the file of each other
+    std::string strTempPath = strPath + std::string(".XXXXXX");
+    const int nFd = mkostemp(strTempPath.data(), O_CLOEXEC);
+    if(-1 == nFd){
+        strErrMsg = std::string("failed to create ") + strTempPath + std::string(":") + strerror(errno);
+        return false;
+    }
+
+    //mkostemp creating the file with 0600
+    bool bOK = 0 == fchmod(nFd, 0644);
+
+    const std::vector<char> vecPadding(g_nAlignment, 0);
+    bOK = bOK && writeAll(nFd, &stHeader, sizeof(stHeader))
+              && writeAll(nFd, vecPadding.data(), alignUp(sizeof(stHeader)) - sizeof(stHeader));
+    for(int ii = 0; bOK && ii < _EN_INVALID_COL_LAST_; ii++){
+        bOK = writeAll(nFd, arrColumns[ii].first, arrColumns[ii].second)
+              && writeAll(nFd, vecPadding.data(), alignUp(arrColumns[ii].second) - arrColumns[ii].second);
+    }
+
+    bOK = bOK && 0 == fsync(nFd);
+    if(!bOK)
+        strErrMsg = std::string("failed to write ") + strTempPath + std::string(":") + strerror(errno);
+
+    close(nFd);
+    if(bOK && 0 != rename(strTempPath.c_str(), strPath.c_str())){
+        strErrMsg = std::string("failed to rename ") + strTempPath + std::string(":") + strerror(errno);
+        bOK = false;
+    }
+
+    if(!bOK){
+        unlink(strTempPath.c_str());
+        return false;
+    }
+
+    if(!syncDir(strPath)){
+        strErrMsg = std::string("failed to sync the directory of ") + strPath + std::string(":") + strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+std::future<std::pair<bool, std::string>> CCourseSnapshot::refresh_async(const std::string & strPath)
+{
+    //the DB load being kept off the startup path, note strPath can NOT captured by reference, and the exceptions being
+    //delivered by the future
+    return std::async(std::launch::async, [strPath]()->std::pair<bool, std::string>{
+        CMySQL sql;
+        CCourseTable table;
+        if(!sql.query_table(table))
+            return std::make_pair(false, std::string("failed to query table course"));
+
+        std::string strErrMsg;
+        const bool bOK = save(table, strPath, strErrMsg);
+        return std::make_pair(bOK, strErrMsg);
+    });
+}
+
+//FNV-1a over 64 bits words, 8 times faster than over bytes
+std::uint64_t CCourseSnapshot::checksum(const unsigned char * pData, const size_t nSize)
+{
+    std::uint64_t nHash = 0xcbf29ce484222325ULL;
+    size_t ii = 0;
+    for(; ii + 8 <= nSize; ii += 8){
+        std::uint64_t nWord = 0;
+        std::memcpy(&nWord, pData + ii, sizeof(nWord));
+        nHash = (nHash ^ nWord) * 0x100000001b3ULL;
+    }
+
+    for(; ii < nSize; ii++)
+        nHash = (nHash ^ pData[ii]) * 0x100000001b3ULL;
+
+    return nHash;
+}
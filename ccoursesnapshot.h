@@ -0,0 +1,121 @@
+#ifndef CCOURSESNAPSHOT_H
+#define CCOURSESNAPSHOT_H
+
+/*
+ * CCourseSnapshot is the on-disk binary image of CCourseTable, which being memory mapped and used in place, so the
+ * service could start serving right after the mapping rather than re-querying the whole table from MySQL.
+ *
+ *  StSnapshotHeader, 64 bytes aligned
+ *  column 0 ~ column N, each being the raw array of the same layout as CCourseTable, 64 bytes aligned
+ *
+ * The header carrying the magic, the format version, the byte order, the row count, the offset and the size of
+ * each column, and the checksum of the data of the columns, each column being hashed by FNV-1a and combined in the
+ * order of the columns. The header itself and the padding NOT being covered, the header being validated by the magic,
+ * the version and the layout of the columns against the row count instead. The snapshot being written into a temporary
+ * file and renamed, such the readers never seeing a partial file, and the mapping opened before the rename
+ * staying valid until being unmapped.
+ */
+
+#include "data_type_defination.h"
+#include "ccoursetable.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <future>
+#include <utility>
+
+class CCourseSnapshot
+{
+public:
+    enum SnapshotColumn{
+        _EN_COL_ID_ = 0,
+        _EN_COL_RELATED_ID_,
+        _EN_COL_FLOAT_,
+        _EN_COL_DOUBLE_,
+        _EN_COL_DECIMAL_,
+        _EN_COL_DATE_,
+        _EN_COL_TIME_,
+        _EN_COL_DATETIME_,
+        _EN_COL_POINT_,
+        _EN_COL_RECT_,
+        _EN_COL_NAME_OFFSET_,
+        _EN_COL_NAME_ARENA_,
+
+        //Do NOT Use the below
+        _EN_INVALID_COL_LAST_,
+    };
+
+    typedef struct ST_snapshotColumn{
+        std::uint64_t nOffset = 0;//from the beginning of the file
+        std::uint64_t nSize = 0;//in bytes
+    }StSnapshotColumn;
+
+    typedef struct ST_snapshotHeader{
+        char szMagic[8] = {'C', 'R', 'S', 'S', 'N', 'A', 'P', '\0'};
+        std::uint32_t nVersion = 1;
+        std::uint32_t nByteOrder = 0x01020304;//being read back as 0x04030201 on a host of the other byte order
+        std::uint64_t nRowCount = 0;
+        std::uint64_t nChecksum = 0;
+        std::uint64_t nCreateTime = 0;//seconds since epoch
+        StSnapshotColumn arrColumns[_EN_INVALID_COL_LAST_];
+    }StSnapshotHeader;
+
+    //map the snapshot file, the checksum being verified when bVerify being true, which touching all the pages
+    explicit CCourseSnapshot(const std::string & strPath, const bool bVerify = true);
+    ~CCourseSnapshot();
+
+    //copy constructor and assignment operator prohibited
+    CCourseSnapshot(const CCourseSnapshot & ) = delete;
+    CCourseSnapshot(const CCourseSnapshot && ) = delete;
+    CCourseSnapshot & operator=(const CCourseSnapshot &) = delete;
+    CCourseSnapshot & operator=(const CCourseSnapshot &&) = delete;
+
+    bool isValid() const;
+    const std::string & getErrMsg() const;
+
+    size_t size() const;
+    std::uint64_t createTime() const;
+
+    //the columns being pointed into the mapping directly, for the kernels of CCourseTable
+    const std::int64_t * ids() const { return this->column<std::int64_t>(_EN_COL_ID_); }
+    const std::int64_t * relatedIDs() const { return this->column<std::int64_t>(_EN_COL_RELATED_ID_); }
+    const float * floats() const { return this->column<float>(_EN_COL_FLOAT_); }
+    const double * doubles() const { return this->column<double>(_EN_COL_DOUBLE_); }
+    const int * decimals() const { return this->column<int>(_EN_COL_DECIMAL_); }
+    const StDate * dates() const { return this->column<StDate>(_EN_COL_DATE_); }
+    const StTime * times() const { return this->column<StTime>(_EN_COL_TIME_); }
+    const StDateTime * datetimes() const { return this->column<StDateTime>(_EN_COL_DATETIME_); }
+    const StPoint<int> * points() const { return this->column<StPoint<int>>(_EN_COL_POINT_); }
+    const StRect<int> * rects() const { return this->column<StRect<int>>(_EN_COL_RECT_); }
+
+    std::string_view name(const size_t nIndex) const;
+    StCourse row(const size_t nIndex) const;
+
+    //write the table into the snapshot file, by a unique temporary file renamed into strPath, the directory being
+    //synced after the rename, so the saves running at once being safe and the new snapshot surviving a crash
+    static bool save(const CCourseTable & table, const std::string & strPath, std::string & strErrMsg);
+
+    //query the table from MySQL and rewrite the snapshot file in the background, the result being whether OK and the error message,
+    //the snapshot mapped currently NOT being affected, and the caller reopening the file to pick up the new one. The future being
+    //of std::async, whose destructor waiting for the refresh, such the refresh never outliving the caller dropping it
+    static std::future<std::pair<bool, std::string>> refresh_async(const std::string & strPath);
+
+private:
+    template<class T>
+    const T * column(const SnapshotColumn enColumn) const
+    {
+        return reinterpret_cast<const T *>(this->m_pData + this->m_pHeader->arrColumns[enColumn].nOffset);
+    }
+
+    static std::uint64_t checksum(const unsigned char * pData, const size_t nSize);
+
+private:
+    std::string m_strErrMsg;
+
+    const unsigned char * m_pData = nullptr;
+    size_t m_nMappedSize = 0;
+    const StSnapshotHeader * m_pHeader = nullptr;//nullptr when the snapshot being invalid
+};
+
+#endif // CCOURSESNAPSHOT_H
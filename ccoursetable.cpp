@@ -0,0 +1,148 @@
+#include "ccoursetable.h"
+
+#include <algorithm>
+
+CCourseTable::CCourseTable(const std::vector<StCourse> & vecRows)
+{
+    size_t nNameBytes = 0;
+    for(const auto & stCourse : vecRows)
+        nNameBytes += stCourse.strCourseName.size();
+
+    this->reserve(vecRows.size(), nNameBytes);
+    for(const auto & stCourse : vecRows)
+        this->append(stCourse);
+}
+
+void CCourseTable::reserve(const size_t nRows, const size_t nNameBytes/*=0*/)
+{
+    this->m_vecID.reserve(nRows);
+    this->m_vecRelatedID.reserve(nRows);
+    this->m_vecFloat.reserve(nRows);
+    this->m_vecDouble.reserve(nRows);
+    this->m_vecDecimal.reserve(nRows);
+    this->m_vecDate.reserve(nRows);
+    this->m_vecTime.reserve(nRows);
+    this->m_vecDateTime.reserve(nRows);
+    this->m_vecPoint.reserve(nRows);
+    this->m_vecRect.reserve(nRows);
+
+    this->m_strNameArena.reserve(nNameBytes);
+    this->m_vecNameOffset.reserve(nRows + 1);
+}
+
+void CCourseTable::append(const StCourse & stCourse)
+{
+    this->m_vecID.emplace_back(stCourse.nID);
+    this->m_vecRelatedID.emplace_back(stCourse.nRelatedID);
+    this->m_vecFloat.emplace_back(stCourse.fFloat);
+    this->m_vecDouble.emplace_back(stCourse.fDouble);
+    this->m_vecDecimal.emplace_back(stCourse.nDecimal);
+    this->m_vecDate.emplace_back(stCourse.date);
+    this->m_vecTime.emplace_back(stCourse.time);
+    this->m_vecDateTime.emplace_back(stCourse.datetime);
+    this->m_vecPoint.emplace_back(stCourse.point);
+    this->m_vecRect.emplace_back(stCourse.rect);
+
+    this->m_strNameArena.append(stCourse.strCourseName);
+    this->m_vecNameOffset.emplace_back(this->m_strNameArena.size());
+}
+
+void CCourseTable::clear()
+{
+    this->m_vecID.clear();
+    this->m_vecRelatedID.clear();
+    this->m_vecFloat.clear();
+    this->m_vecDouble.clear();
+    this->m_vecDecimal.clear();
+    this->m_vecDate.clear();
+    this->m_vecTime.clear();
+    this->m_vecDateTime.clear();
+    this->m_vecPoint.clear();
+    this->m_vecRect.clear();
+
+    this->m_strNameArena.clear();
+    this->m_vecNameOffset.assign(1, 0);
+}
+
+size_t CCourseTable::size() const
+{
+    return this->m_vecID.size();
+}
+
+StCourse CCourseTable::row(const size_t nIndex) const
+{
+    StCourse stCourse;
+    stCourse.nID = this->m_vecID.at(nIndex);
+    stCourse.strCourseName = std::string(this->name(nIndex));
+    stCourse.nRelatedID = this->m_vecRelatedID[nIndex];
+    stCourse.fFloat = this->m_vecFloat[nIndex];
+    stCourse.fDouble = this->m_vecDouble[nIndex];
+    stCourse.nDecimal = this->m_vecDecimal[nIndex];
+    stCourse.date = this->m_vecDate[nIndex];
+    stCourse.time = this->m_vecTime[nIndex];
+    stCourse.datetime = this->m_vecDateTime[nIndex];
+    stCourse.point = this->m_vecPoint[nIndex];
+    stCourse.rect = this->m_vecRect[nIndex];
+    return stCourse;
+}
+
+std::string_view CCourseTable::name(const size_t nIndex) const
+{
+    const std::uint64_t nBegin = this->m_vecNameOffset.at(nIndex);
+    return std::string_view(this->m_strNameArena.data() + nBegin, this->m_vecNameOffset.at(nIndex + 1) - nBegin);
+}
+
+std::unordered_map<std::int64_t, CCourseTable::StGroupAgg> CCourseTable::groupByRelatedID(const selection * pSel/*=nullptr*/) const
+{
+    return groupBy(this->m_vecRelatedID.data(), this->m_vecDouble.data(), this->size(), pSel);
+}
+
+std::unordered_map<std::int64_t, CCourseTable::StGroupAgg> CCourseTable::groupBy(const std::int64_t * pKeys, const double * pValues, const size_t nSize,
+                                                                                 const selection * pSel/*=nullptr*/)
+{
+    std::unordered_map<std::int64_t, StGroupAgg> mpGroups;
+    const size_t nCount = pSel ? pSel->size() : nSize;
+    if(0 == nCount)
+        return mpGroups;
+
+    auto index_lambda = [pSel](const size_t ii){ return pSel ? static_cast<size_t>((*pSel)[ii]) : ii; };
+
+    std::int64_t nMinKey = std::numeric_limits<std::int64_t>::max();
+    std::int64_t nMaxKey = std::numeric_limits<std::int64_t>::lowest();
+    for(size_t ii = 0; ii < nCount; ii++){
+        nMinKey = std::min(nMinKey, pKeys[index_lambda(ii)]);
+        nMaxKey = std::max(nMaxKey, pKeys[index_lambda(ii)]);
+    }
+
+    //the keys being dense, such as the foreign keys, aggregated by a plain array rather than hashing each row
+    const std::uint64_t nRange = static_cast<std::uint64_t>(nMaxKey) - static_cast<std::uint64_t>(nMinKey);
+    if(nRange < nCount + 1024){
+        std::vector<StGroupAgg> vecGroups(nRange + 1);
+        for(size_t ii = 0; ii < nCount; ii++){
+            const size_t nIndex = index_lambda(ii);
+            StGroupAgg & stAgg = vecGroups[static_cast<std::uint64_t>(pKeys[nIndex]) - static_cast<std::uint64_t>(nMinKey)];
+            stAgg.nCount++;
+            stAgg.fSum += pValues[nIndex];
+            stAgg.fMin = std::min(stAgg.fMin, pValues[nIndex]);
+            stAgg.fMax = std::max(stAgg.fMax, pValues[nIndex]);
+        }
+
+        for(size_t ii = 0; ii < vecGroups.size(); ii++){
+            if(vecGroups[ii].nCount)
+                mpGroups.emplace(static_cast<std::int64_t>(static_cast<std::uint64_t>(nMinKey) + ii), vecGroups[ii]);
+        }
+
+        return mpGroups;
+    }
+
+    for(size_t ii = 0; ii < nCount; ii++){
+        const size_t nIndex = index_lambda(ii);
+        StGroupAgg & stAgg = mpGroups[pKeys[nIndex]];
+        stAgg.nCount++;
+        stAgg.fSum += pValues[nIndex];
+        stAgg.fMin = std::min(stAgg.fMin, pValues[nIndex]);
+        stAgg.fMax = std::max(stAgg.fMax, pValues[nIndex]);
+    }
+
+    return mpGroups;
+}
@@ -0,0 +1,183 @@
+#ifndef CCOURSETABLE_H
+#define CCOURSETABLE_H
+
+/*
+ * CCourseTable stores the rows of table course column by column, each field in its own contiguous array and all the
+ * names in a shared byte arena, so a scan on one field touching only the bytes of such the field. The kernels working
+ * on the raw arrays being written branch free, such the compiler could vectorize them(-O2 with -ftree-vectorize or -O3),
+ * and the filters producing the selection vectors, the indexes of the rows matched, which being refined by the further
+ * filters and consumed by the aggregates.
+ */
+
+#include "data_type_defination.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <type_traits>
+
+class CCourseTable
+{
+public:
+    //indexes of the rows selected, 32 bits being enough and halving the memory traffic
+    using selection = std::vector<std::uint32_t>;
+
+    //aggregate of a group
+    typedef struct ST_groupAgg{
+        size_t nCount = 0;
+        double fSum = 0.0;
+        double fMin = std::numeric_limits<double>::max();
+        double fMax = std::numeric_limits<double>::lowest();
+    }StGroupAgg;
+
+    CCourseTable() = default;
+    explicit CCourseTable(const std::vector<StCourse> & vecRows);
+    ~CCourseTable() = default;
+
+    void reserve(const size_t nRows, const size_t nNameBytes = 0);
+    void append(const StCourse & stCourse);
+    void clear();
+    size_t size() const;
+
+    //materialize the given row
+    StCourse row(const size_t nIndex) const;
+    std::string_view name(const size_t nIndex) const;
+
+    //the columns, for the kernels below
+    const std::vector<std::int64_t> & ids() const { return this->m_vecID; }
+    const std::vector<std::int64_t> & relatedIDs() const { return this->m_vecRelatedID; }
+    const std::vector<float> & floats() const { return this->m_vecFloat; }
+    const std::vector<double> & doubles() const { return this->m_vecDouble; }
+    const std::vector<int> & decimals() const { return this->m_vecDecimal; }
+    const std::vector<StDate> & dates() const { return this->m_vecDate; }
+    const std::vector<StTime> & times() const { return this->m_vecTime; }
+    const std::vector<StDateTime> & datetimes() const { return this->m_vecDateTime; }
+    const std::vector<StPoint<int>> & points() const { return this->m_vecPoint; }
+    const std::vector<StRect<int>> & rects() const { return this->m_vecRect; }
+    const std::vector<std::uint64_t> & nameOffsets() const { return this->m_vecNameOffset; }
+    const std::string & nameArena() const { return this->m_strNameArena; }
+
+    //group the given rows, all the rows when pSel being nullptr, by nRelatedID and aggregate fDouble of each group
+    std::unordered_map<std::int64_t, StGroupAgg> groupByRelatedID(const selection * pSel = nullptr) const;
+
+public:
+    //group the given rows by the keys and aggregate the values of each group
+    static std::unordered_map<std::int64_t, StGroupAgg> groupBy(const std::int64_t * pKeys, const double * pValues, const size_t nSize,
+                                                                const selection * pSel = nullptr);
+
+    //count of the values within [lower, upper]
+    template<class T>
+    static size_t countRange(const T * pData, const size_t nSize, const T lower, const T upper)
+    {
+        size_t nCount = 0;
+        for(size_t ii = 0; ii < nSize; ii++)
+            nCount += (pData[ii] >= lower) & (pData[ii] <= upper);
+
+        return nCount;
+    }
+
+    //select the indexes of the values within [lower, upper], the index being always written and the cursor being
+    //advanced by the result of the comparison, so no branch being mispredicted whatever the selectivity
+    template<class T>
+    static size_t selectRange(const T * pData, const size_t nSize, const T lower, const T upper, selection & vecSel)
+    {
+        vecSel.resize(nSize);
+        std::uint32_t * pSel = vecSel.data();
+
+        size_t nCount = 0;
+        for(size_t ii = 0; ii < nSize; ii++){
+            pSel[nCount] = static_cast<std::uint32_t>(ii);
+            nCount += (pData[ii] >= lower) & (pData[ii] <= upper);
+        }
+
+        vecSel.resize(nCount);
+        return nCount;
+    }
+
+    //keep the indexes in the selection whose values within [lower, upper], in place
+    template<class T>
+    static size_t refineRange(const T * pData, const T lower, const T upper, selection & vecSel)
+    {
+        std::uint32_t * pSel = vecSel.data();
+
+        size_t nCount = 0;
+        for(size_t ii = 0; ii < vecSel.size(); ii++){
+            const std::uint32_t nIndex = pSel[ii];
+            pSel[nCount] = nIndex;
+            nCount += (pData[nIndex] >= lower) & (pData[nIndex] <= upper);
+        }
+
+        vecSel.resize(nCount);
+        return nCount;
+    }
+
+    //sum of the values, 4 independent accumulators breaking the dependency chain of the floating point additions
+    template<class T>
+    static auto sum(const T * pData, const size_t nSize)
+    {
+        using sumType = std::conditional_t<std::is_floating_point_v<T>, double, std::int64_t>;
+        sumType sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+        size_t ii = 0;
+        for(; ii + 4 <= nSize; ii += 4){
+            sum0 += pData[ii];
+            sum1 += pData[ii + 1];
+            sum2 += pData[ii + 2];
+            sum3 += pData[ii + 3];
+        }
+
+        for(; ii < nSize; ii++)
+            sum0 += pData[ii];
+
+        return (sum0 + sum1) + (sum2 + sum3);
+    }
+
+    //sum of the values selected
+    template<class T>
+    static auto sum(const T * pData, const selection & vecSel)
+    {
+        using sumType = std::conditional_t<std::is_floating_point_v<T>, double, std::int64_t>;
+        sumType sum0 = 0, sum1 = 0;
+
+        size_t ii = 0;
+        for(; ii + 2 <= vecSel.size(); ii += 2){
+            sum0 += pData[vecSel[ii]];
+            sum1 += pData[vecSel[ii + 1]];
+        }
+
+        for(; ii < vecSel.size(); ii++)
+            sum0 += pData[vecSel[ii]];
+
+        return sum0 + sum1;
+    }
+
+    //gather the values selected into a dense array, for the kernels above running on it
+    template<class T>
+    static void gather(const T * pData, const selection & vecSel, std::vector<T> & vecResult)
+    {
+        vecResult.resize(vecSel.size());
+        for(size_t ii = 0; ii < vecSel.size(); ii++)
+            vecResult[ii] = pData[vecSel[ii]];
+    }
+
+private:
+    std::vector<std::int64_t> m_vecID;
+    std::vector<std::int64_t> m_vecRelatedID;
+    std::vector<float> m_vecFloat;
+    std::vector<double> m_vecDouble;
+    std::vector<int> m_vecDecimal;
+    std::vector<StDate> m_vecDate;
+    std::vector<StTime> m_vecTime;
+    std::vector<StDateTime> m_vecDateTime;
+    std::vector<StPoint<int>> m_vecPoint;
+    std::vector<StRect<int>> m_vecRect;
+
+    //the names being stored back to back, the name of row ii being [m_vecNameOffset[ii], m_vecNameOffset[ii + 1])
+    std::string m_strNameArena;
+    std::vector<std::uint64_t> m_vecNameOffset{0};
+};
+
+#endif // CCOURSETABLE_H
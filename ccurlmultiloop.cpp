@@ -0,0 +1,397 @@
+#include "ccurlmultiloop.h"
+
+#include "cresourceinit.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <memory>
+
+CCurlMultiLoop::CCurlMultiLoop()
+{
+    if(!CResourceInit::init()){
+        this->m_strErrMsg = CResourceInit::getErrMsg();
+        this->m_bStop = true;
+        return ;
+    }
+
+    this->m_nEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    this->m_nEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    this->m_pMulti = curl_multi_init();
+    if(-1 == this->m_nEpollFd || -1 == this->m_nEventFd || nullptr == this->m_pMulti){
+        this->m_strErrMsg = std::string("failed to create the multi handle, epoll or eventfd:") + strerror(errno);
+        this->m_bStop = true;
+        return ;
+    }
+
+    epoll_event stEvent{};
+    stEvent.events = EPOLLIN;
+    stEvent.data.fd = this->m_nEventFd;
+    epoll_ctl(this->m_nEpollFd, EPOLL_CTL_ADD, this->m_nEventFd, &stEvent);
+
+    curl_multi_setopt(this->m_pMulti, CURLMOPT_SOCKETFUNCTION, CCurlMultiLoop::socketCallback);
+    curl_multi_setopt(this->m_pMulti, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(this->m_pMulti, CURLMOPT_TIMERFUNCTION, CCurlMultiLoop::timerCallback);
+    curl_multi_setopt(this->m_pMulti, CURLMOPT_TIMERDATA, this);
+
+    this->m_loopThread = std::thread(&CCurlMultiLoop::eventLoop, this);
+}
+
+CCurlMultiLoop::~CCurlMultiLoop()
+{
+    this->stop();
+
+    if(this->m_pMulti)
+        curl_multi_cleanup(this->m_pMulti);
+    if(-1 != this->m_nEventFd)
+        close(this->m_nEventFd);
+    if(-1 != this->m_nEpollFd)
+        close(this->m_nEpollFd);
+}
+
+bool CCurlMultiLoop::post(task fnTask)
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(this->m_bStop)
+            return false;
+
+        this->m_vecTasks.emplace_back(std::move(fnTask));
+    }
+
+    this->wakeUp();
+    return true;
+}
+
+bool CCurlMultiLoop::postAfter(const std::chrono::milliseconds nDelay, task fnTask)
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(this->m_bStop)
+            return false;
+
+        this->m_mpDelayedTasks.emplace(std::chrono::steady_clock::now() + nDelay, std::move(fnTask));
+    }
+
+    //the timeout of epoll being recomputed
+    this->wakeUp();
+    return true;
+}
+
+bool CCurlMultiLoop::add(CURL * pCurl, doneCallback onDone)
+{
+    if(nullptr == pCurl)
+        return false;
+
+    if(this->isLoopThread())
+        return this->addOnLoop(pCurl, std::move(onDone));
+
+    //std::function being copyable, onDone being shared by the task rather than moved into it
+    auto pOnDone = std::make_shared<doneCallback>(std::move(onDone));
+    return this->post([this, pCurl, pOnDone](){
+        if(!this->addOnLoop(pCurl, std::move(*pOnDone)))
+            (*pOnDone)(pCurl, CURLE_FAILED_INIT);
+    });
+}
+
+bool CCurlMultiLoop::cancel(CURL * pCurl)
+{
+    auto iter = this->m_mpTransfers.find(pCurl);
+    if(this->m_mpTransfers.end() == iter)
+        return false;
+
+    doneCallback onDone = std::move(iter->second);
+    this->m_mpTransfers.erase(iter);
+    curl_multi_remove_handle(this->m_pMulti, pCurl);
+    this->m_mpWatched.erase(pCurl);
+
+    if(onDone)
+        onDone(pCurl, CURLE_ABORTED_BY_CALLBACK);
+    return true;
+}
+
+bool CCurlMultiLoop::isWatched(CURL * pCurl) const
+{
+    auto iter = this->m_mpWatched.find(pCurl);
+    return this->m_mpWatched.end() != iter && iter->second > 0;
+}
+
+void CCurlMultiLoop::drive()
+{
+    if(nullptr == this->m_pMulti)
+        return ;
+
+    int nRunning = 0;
+    curl_multi_perform(this->m_pMulti, &nRunning);
+    this->readInfo();
+}
+
+CURLM * CCurlMultiLoop::multi() const
+{
+    return this->m_pMulti;
+}
+
+bool CCurlMultiLoop::isLoopThread() const
+{
+    return std::this_thread::get_id() == this->m_loopThread.get_id();
+}
+
+size_t CCurlMultiLoop::count() const
+{
+    return this->m_mpTransfers.size();
+}
+
+void CCurlMultiLoop::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_bStop = true;
+    }
+    this->wakeUp();
+
+    if(this->m_loopThread.joinable() && !this->isLoopThread())
+        this->m_loopThread.join();
+}
+
+const std::string & CCurlMultiLoop::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+void CCurlMultiLoop::eventLoop()
+{
+    std::vector<epoll_event> vecEvents(256);
+    while(true){
+        {
+            std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+            if(this->m_bStop)
+                break;
+        }
+
+        //sleep until a socket ready, a task posted, the timer of libcurl expiring or a delayed task due
+        std::optional<std::chrono::steady_clock::time_point> deadline = this->m_timerDeadline;
+        const auto && delayedDeadline = this->nextDelayedTask();
+        if(delayedDeadline.has_value() && (!deadline.has_value() || *delayedDeadline < *deadline))
+            deadline = delayedDeadline;
+
+        int nTimeoutMs = -1;
+        if(deadline.has_value()){
+            //rounded up, such the loop NOT spinning on the deadline less than 1ms away
+            const auto nRemain = std::chrono::duration_cast<std::chrono::microseconds>(*deadline - std::chrono::steady_clock::now()).count();
+            nTimeoutMs = static_cast<int>(std::max<long long>((nRemain + 999) / 1000, 0));
+        }
+
+        const int nCount = epoll_wait(this->m_nEpollFd, vecEvents.data(), static_cast<int>(vecEvents.size()), nTimeoutMs);
+        int nRunning = 0;
+        for(int ii = 0; ii < nCount; ii++){
+            if(vecEvents[ii].data.fd == this->m_nEventFd){
+                std::uint64_t nValue = 0;
+                (void)!read(this->m_nEventFd, &nValue, sizeof(nValue));
+                continue;
+            }
+
+            int nFlags = 0;
+            if(vecEvents[ii].events & (EPOLLIN | EPOLLHUP))
+                nFlags |= CURL_CSELECT_IN;
+            if(vecEvents[ii].events & EPOLLOUT)
+                nFlags |= CURL_CSELECT_OUT;
+            if(vecEvents[ii].events & EPOLLERR)
+                nFlags |= CURL_CSELECT_ERR;
+
+            curl_multi_socket_action(this->m_pMulti, vecEvents[ii].data.fd, nFlags, &nRunning);
+        }
+
+        if(this->m_timerDeadline.has_value() && std::chrono::steady_clock::now() >= *this->m_timerDeadline){
+            this->m_timerDeadline.reset();//being set again by the timer callback if needed
+            curl_multi_socket_action(this->m_pMulti, CURL_SOCKET_TIMEOUT, 0, &nRunning);
+        }
+
+        this->readInfo();
+        this->runTasks();
+    }
+
+    //the tasks posted before stopping being run, then the transfers left being aborted
+    this->runTasks();
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_mpDelayedTasks.clear();
+    }
+    while(!this->m_mpTransfers.empty())
+        this->cancel(this->m_mpTransfers.begin()->first);
+}
+
+void CCurlMultiLoop::runTasks()
+{
+    std::vector<task> vecTasks;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        vecTasks.swap(this->m_vecTasks);
+
+        //the delayed tasks due being run after the ones posted before them
+        const auto now = std::chrono::steady_clock::now();
+        while(!this->m_mpDelayedTasks.empty() && this->m_mpDelayedTasks.begin()->first <= now){
+            vecTasks.emplace_back(std::move(this->m_mpDelayedTasks.begin()->second));
+            this->m_mpDelayedTasks.erase(this->m_mpDelayedTasks.begin());
+        }
+    }
+
+    for(auto & fnTask : vecTasks){
+        try{
+            fnTask();
+        }catch(const std::exception & e){
+            std::cout << "exception from the task of the multi loop:" << e.what() << std::endl;
+        }
+    }
+}
+
+std::optional<std::chrono::steady_clock::time_point> CCurlMultiLoop::nextDelayedTask()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    if(this->m_mpDelayedTasks.empty())
+        return std::nullopt;
+
+    return this->m_mpDelayedTasks.begin()->first;
+}
+
+//dispatch the transfers completed
+void CCurlMultiLoop::readInfo()
+{
+    int nMsgLeft = 0;
+    CURLMsg * pMsg = nullptr;
+    while((pMsg = curl_multi_info_read(this->m_pMulti, &nMsgLeft))){
+        if(CURLMSG_DONE != pMsg->msg)
+            continue;
+
+        CURL * pCurl = pMsg->easy_handle;
+        const CURLcode enCode = pMsg->data.result;//pMsg being invalid after the handle removed
+
+        auto iter = this->m_mpTransfers.find(pCurl);
+        if(this->m_mpTransfers.end() == iter)
+            continue;
+
+        doneCallback onDone = std::move(iter->second);
+        this->m_mpTransfers.erase(iter);
+        curl_multi_remove_handle(this->m_pMulti, pCurl);
+        this->m_mpWatched.erase(pCurl);
+
+        try{
+            if(onDone)
+                onDone(pCurl, enCode);
+        }catch(const std::exception & e){
+            std::cout << "exception from the done callback of the multi loop:" << e.what() << std::endl;
+        }
+    }
+}
+
+void CCurlMultiLoop::wakeUp()
+{
+    const std::uint64_t nValue = 1;
+    if(-1 != this->m_nEventFd)
+        (void)!write(this->m_nEventFd, &nValue, sizeof(nValue));
+}
+
+bool CCurlMultiLoop::addOnLoop(CURL * pCurl, doneCallback && onDone)
+{
+    if(nullptr == this->m_pMulti || this->m_mpTransfers.count(pCurl))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(this->m_bStop)
+            return false;
+    }
+
+    if(CURLM_OK != curl_multi_add_handle(this->m_pMulti, pCurl))
+        return false;
+
+    this->m_mpTransfers.emplace(pCurl, std::move(onDone));
+    return true;
+}
+
+//register, modify or unregister the socket in epoll as libcurl asking
+int CCurlMultiLoop::socketCallback(CURL * pCurl, curl_socket_t nSocket, int nWhat, void * pUserPtr, void * pSocketPtr)
+{
+    (void)pSocketPtr;
+    CCurlMultiLoop * pLoop = static_cast<CCurlMultiLoop *>(pUserPtr);
+
+    //the socket closed being dropped by the kernel already, so ENOENT and EBADF NOT being errors
+    if(CURL_POLL_REMOVE == nWhat){
+        auto iter = pLoop->m_mpSockets.find(nSocket);
+        if(pLoop->m_mpSockets.end() != iter){
+            pLoop->unwatch(iter->second);
+            pLoop->m_mpSockets.erase(iter);
+            epoll_ctl(pLoop->m_nEpollFd, EPOLL_CTL_DEL, nSocket, nullptr);
+        }
+        return 0;
+    }
+
+    epoll_event stEvent{};
+    stEvent.data.fd = nSocket;
+    stEvent.events = 0;
+    if(nWhat & CURL_POLL_IN)
+        stEvent.events |= EPOLLIN;
+    if(nWhat & CURL_POLL_OUT)
+        stEvent.events |= EPOLLOUT;
+
+    //the fd number of a socket closed without CURL_POLL_REMOVE being reused by a new socket, which NOT being in epoll
+    //though in m_mpSockets, and the other way round, so MOD falling back to ADD on ENOENT, and ADD to MOD on EEXIST
+    auto iter = pLoop->m_mpSockets.find(nSocket);
+    const bool bNew = pLoop->m_mpSockets.end() == iter;
+    int nRet = epoll_ctl(pLoop->m_nEpollFd, bNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, nSocket, &stEvent);
+    if(-1 == nRet && !bNew && ENOENT == errno)
+        nRet = epoll_ctl(pLoop->m_nEpollFd, EPOLL_CTL_ADD, nSocket, &stEvent);
+    else if(-1 == nRet && bNew && EEXIST == errno)
+        nRet = epoll_ctl(pLoop->m_nEpollFd, EPOLL_CTL_MOD, nSocket, &stEvent);
+
+    //the transfers of the socket being failed by libcurl rather than waiting for the events never coming
+    if(-1 == nRet){
+        std::cout << "failed to watch the socket " << nSocket << " by epoll:" << strerror(errno) << std::endl;
+        if(!bNew){
+            pLoop->unwatch(iter->second);
+            pLoop->m_mpSockets.erase(iter);
+        }
+        return -1;
+    }
+
+    StSocketWatch & stWatch = bNew ? pLoop->m_mpSockets[nSocket] : iter->second;
+
+    //the handles NOT in flight being NOT counted, such as the handle of libcurl for the connections idle
+    pLoop->unwatch(stWatch);
+    stWatch.pCurl = pCurl;
+    if(pLoop->m_mpTransfers.count(pCurl)){
+        pLoop->m_mpWatched[pCurl]++;
+        stWatch.bCounted = true;
+    }
+
+    return 0;
+}
+
+//the count of a transfer done being erased already, a socket counted for it decreasing the handle reused at worst,
+//which only driving the handle once more
+void CCurlMultiLoop::unwatch(StSocketWatch & stWatch)
+{
+    if(!stWatch.bCounted)
+        return ;
+
+    stWatch.bCounted = false;
+    auto iter = this->m_mpWatched.find(stWatch.pCurl);
+    if(this->m_mpWatched.end() != iter && 0 == --iter->second)
+        this->m_mpWatched.erase(iter);
+}
+
+//-1 deleting the timer, 0 meaning timeout at once
+int CCurlMultiLoop::timerCallback(CURLM * pMulti, long nTimeoutMs, void * pUserPtr)
+{
+    (void)pMulti;
+    CCurlMultiLoop * pLoop = static_cast<CCurlMultiLoop *>(pUserPtr);
+
+    if(nTimeoutMs < 0)
+        pLoop->m_timerDeadline.reset();
+    else
+        pLoop->m_timerDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeoutMs);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#ifndef CCURLMULTILOOP_H
+#define CCURLMULTILOOP_H
+
+/*
+ * CCurlMultiLoop drives the easy handles by a curl multi handle on a single thread, the sockets being watched by
+ * epoll through CURLMOPT_SOCKETFUNCTION and the timeouts of libcurl being honored through CURLMOPT_TIMERFUNCTION,
+ * curl_multi_socket_action being called only for the sockets ready, so the cost of a loop iteration NOT growing with
+ * the count of the transfers in flight.
+ *
+ * The tasks being posted from any thread are run on the loop thread, such the users keeping all their states on the
+ * loop thread without locking. Linux only for epoll and eventfd.
+ */
+
+#include "curl/curl.h"
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <optional>
+#include <string>
+
+class CCurlMultiLoop
+{
+public:
+    //invoked on the loop thread when the transfer done, the handle having been removed from the multi handle
+    using doneCallback = std::function<void(CURL * pCurl, const CURLcode enCode)>;
+    using task = std::function<void()>;
+
+    CCurlMultiLoop();
+    ~CCurlMultiLoop();
+
+    //copy constructor and assignment operator prohibited
+    CCurlMultiLoop(const CCurlMultiLoop & ) = delete;
+    CCurlMultiLoop(const CCurlMultiLoop && ) = delete;
+    CCurlMultiLoop & operator=(const CCurlMultiLoop &) = delete;
+    CCurlMultiLoop & operator=(const CCurlMultiLoop &&) = delete;
+
+    //run the task on the loop thread, return false when the loop being stopped
+    bool post(task fnTask);
+    //run the task on the loop thread after the delay at least, the delayed tasks NOT due being dropped on stopping
+    bool postAfter(const std::chrono::milliseconds nDelay, task fnTask);
+
+    //start the transfer of the handle, being thread-safe, the handle being added at once on the loop thread, otherwise being posted,
+    //return false when the loop being stopped, and onDone would NOT be invoked
+    bool add(CURL * pCurl, doneCallback onDone);
+
+    //abort the transfer of the handle, on the loop thread only, onDone being invoked with CURLE_ABORTED_BY_CALLBACK,
+    //return false when the handle NOT being in the loop
+    bool cancel(CURL * pCurl);
+
+    //whether a socket of the transfer being watched by epoll, on the loop thread only. A transfer in flight NOT watched
+    //being woken by the timer of libcurl only, the sockets shared by several transfers being of the one reported last
+    bool isWatched(CURL * pCurl) const;
+
+    //drive all the transfers in flight by curl_multi_perform and dispatch the transfers done, on the loop thread only, for
+    //the transfers NOT watched while NOT waiting for the timer, the cost growing with the count of the transfers in flight,
+    //so being called for such the transfers found only, NOT periodically at a short interval
+    void drive();
+
+    //the multi handle, for curl_multi_setopt and curl_multi_info, on the loop thread only
+    CURLM * multi() const;
+
+    bool isLoopThread() const;
+    size_t count() const;//transfers in flight, on the loop thread only
+
+    //stop the loop and wait for the loop thread, the transfers in flight being aborted with CURLE_ABORTED_BY_CALLBACK,
+    //being called by the destructor, so the owners whose callbacks touching their members calling it first
+    void stop();
+
+    const std::string & getErrMsg() const;
+
+private:
+    typedef struct ST_socketWatch{
+        CURL * pCurl = nullptr;//the transfer reported last for the socket
+        bool bCounted = false;//being counted in m_mpWatched, the transfer being in flight when reported
+    }StSocketWatch;
+
+    void eventLoop();
+    void runTasks();
+    std::optional<std::chrono::steady_clock::time_point> nextDelayedTask();
+    void readInfo();
+    void wakeUp();
+    bool addOnLoop(CURL * pCurl, doneCallback && onDone);
+    void unwatch(StSocketWatch & stWatch);//the socket NOT being counted for its transfer any more
+
+    static int socketCallback(CURL * pCurl, curl_socket_t nSocket, int nWhat, void * pUserPtr, void * pSocketPtr);
+    static int timerCallback(CURLM * pMulti, long nTimeoutMs, void * pUserPtr);
+
+private:
+    std::string m_strErrMsg;
+    CURLM * m_pMulti = nullptr;
+    int m_nEpollFd = -1;
+    int m_nEventFd = -1;
+
+    //touched by the loop thread only
+    std::unordered_map<CURL *, doneCallback> m_mpTransfers;
+    std::unordered_map<curl_socket_t, StSocketWatch> m_mpSockets;//registered into epoll
+    std::unordered_map<CURL *, size_t> m_mpWatched;//the count of the sockets registered of the transfers in flight
+    std::optional<std::chrono::steady_clock::time_point> m_timerDeadline;
+
+    std::mutex m_mtx;
+    std::vector<task> m_vecTasks;
+    std::multimap<std::chrono::steady_clock::time_point, task> m_mpDelayedTasks;
+    bool m_bStop = false;
+
+    std::thread m_loopThread;
+};
+
+#endif // CCURLMULTILOOP_H
@@ -0,0 +1,116 @@
+#include "ccurlshare.h"
+
+#include "cresourceinit.h"
+
+CCurlShare::CCurlShare()
+{
+    //curl_global_init being called before any other function of libcurl
+    if(!CResourceInit::init()){
+        this->m_strErrMsg = CResourceInit::getErrMsg();
+        return ;
+    }
+
+    this->m_pShare = curl_share_init();
+    if(nullptr == this->m_pShare){
+        this->m_strErrMsg = std::string("failed to init the curl share");
+        return ;
+    }
+
+    curl_share_setopt(this->m_pShare, CURLSHOPT_LOCKFUNC, CCurlShare::lockCallback);
+    curl_share_setopt(this->m_pShare, CURLSHOPT_UNLOCKFUNC, CCurlShare::unlockCallback);
+    curl_share_setopt(this->m_pShare, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(this->m_pShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(this->m_pShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    //NOT CURL_LOCK_DATA_CONNECT, the handles running on the various threads at once, the connections being kept by
+    //each handle instead
+}
+
+CCurlShare::~CCurlShare()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxIdle);
+        for(auto pCurl : this->m_vecIdle)
+            curl_easy_cleanup(pCurl);
+        this->m_vecIdle.clear();
+    }
+
+    //CURLSHE_IN_USE returned when any handle still attached
+    if(this->m_pShare)
+        curl_share_cleanup(this->m_pShare);
+}
+
+CCurlShare & CCurlShare::getInst()
+{
+    static CCurlShare inst;
+    return inst;
+}
+
+CURL * CCurlShare::acquire()
+{
+    CCurlShare & share = CCurlShare::getInst();
+    {
+        std::lock_guard<std::mutex> lock_guard(share.m_mtxIdle);
+        if(!share.m_vecIdle.empty()){
+            CURL * pCurl = share.m_vecIdle.back();
+            share.m_vecIdle.pop_back();
+            return pCurl;
+        }
+    }
+
+    CURL * pCurl = curl_easy_init();
+    if(pCurl && share.m_pShare)
+        curl_easy_setopt(pCurl, CURLOPT_SHARE, share.m_pShare);
+
+    return pCurl;
+}
+
+void CCurlShare::release(CURL * pCurl)
+{
+    if(nullptr == pCurl)
+        return ;
+
+    //the share and the live connections of the handle being kept by curl_easy_reset
+    curl_easy_reset(pCurl);
+
+    CCurlShare & share = CCurlShare::getInst();
+    {
+        std::lock_guard<std::mutex> lock_guard(share.m_mtxIdle);
+        if(share.m_vecIdle.size() < share.m_nMaxIdle){
+            share.m_vecIdle.emplace_back(pCurl);
+            return ;
+        }
+    }
+
+    curl_easy_cleanup(pCurl);
+}
+
+void CCurlShare::setMaxIdle(const size_t nMaxIdle)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxIdle);
+    this->m_nMaxIdle = nMaxIdle;
+    while(this->m_vecIdle.size() > this->m_nMaxIdle){
+        curl_easy_cleanup(this->m_vecIdle.back());
+        this->m_vecIdle.pop_back();
+    }
+}
+
+const std::string & CCurlShare::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+//libcurl locking the data before touching it from any thread, the access mode being ignored for std::mutex NOT being a rwlock
+void CCurlShare::lockCallback(CURL * pCurl, curl_lock_data enData, curl_lock_access enAccess, void * pUserPtr)
+{
+    (void)pCurl;
+    (void)enAccess;
+    if(enData < CURL_LOCK_DATA_LAST)
+        static_cast<CCurlShare *>(pUserPtr)->m_arrMutex[enData].lock();
+}
+
+void CCurlShare::unlockCallback(CURL * pCurl, curl_lock_data enData, void * pUserPtr)
+{
+    (void)pCurl;
+    if(enData < CURL_LOCK_DATA_LAST)
+        static_cast<CCurlShare *>(pUserPtr)->m_arrMutex[enData].unlock();
+}
@@ -0,0 +1,69 @@
+#ifndef CCURLSHARE_H
+#define CCURLSHARE_H
+
+/*
+ * CCurlShare is the process-wide share layer of libcurl, the DNS cache and the TLS sessions being shared by all the
+ * easy handles through a CURLSH, so the requests to the same host skipping the lookups and resuming the TLS sessions
+ * whichever client sending them. The connection cache NOT being shared, libcurl NOT supporting a connection cache used
+ * by the threads concurrently.
+ *
+ * It also keeps a pool of warm easy handles, each keeping its own keep-alive connections, so the next borrower of the
+ * handle reusing them. The handles being borrowed by acquire and given back by release, which having the same
+ * signature as curl_easy_cleanup, so a handle being held by
+ *
+ *  std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> pCurl(CCurlShare::acquire(), &CCurlShare::release);
+ */
+
+#include "curl/curl.h"
+
+#include <mutex>
+#include <vector>
+#include <string>
+
+class CCurlShare
+{
+private:
+    CCurlShare();
+
+public:
+    void * operator new(size_t) = delete;
+    void * operator new[](size_t) = delete;
+
+    ~CCurlShare();
+
+    //copy constructor and assignment operator prohibited
+    CCurlShare(const CCurlShare & ) = delete;
+    CCurlShare(const CCurlShare && ) = delete;
+    CCurlShare & operator=(const CCurlShare &) = delete;
+    CCurlShare & operator=(const CCurlShare &&) = delete;
+
+    static CCurlShare & getInst();
+
+    //borrow an easy handle attached to the share, nullptr on failure
+    static CURL * acquire();
+
+    //give back the handle borrowed, the options being reset and the handle being kept warm for the next borrower
+    static void release(CURL * pCurl);
+
+    //the max count of the idle handles kept, 64 by default
+    void setMaxIdle(const size_t nMaxIdle);
+
+    const std::string & getErrMsg() const;
+
+private:
+    static void lockCallback(CURL * pCurl, curl_lock_data enData, curl_lock_access enAccess, void * pUserPtr);
+    static void unlockCallback(CURL * pCurl, curl_lock_data enData, void * pUserPtr);
+
+private:
+    std::string m_strErrMsg;
+    CURLSH * m_pShare = nullptr;
+
+    //one mutex for each kind of the data shared, such the DNS lookups NOT waiting for the TLS sessions
+    std::mutex m_arrMutex[CURL_LOCK_DATA_LAST];
+
+    std::mutex m_mtxIdle;
+    std::vector<CURL *> m_vecIdle;
+    size_t m_nMaxIdle = 64;
+};
+
+#endif // CCURLSHARE_H
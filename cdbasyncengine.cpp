@@ -0,0 +1,299 @@
+#include "cdbasyncengine.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+CDBAsyncEngine::CDBAsyncEngine(const size_t nConnCount/*=16*/)
+{
+    this->m_nEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    this->m_nEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(-1 == this->m_nEpollFd || -1 == this->m_nEventFd){
+        this->m_strErrMsg = std::string("failed to create epoll or eventfd:") + strerror(errno);
+        return ;
+    }
+
+    epoll_event stEvent{};
+    stEvent.events = EPOLLIN;
+    stEvent.data.ptr = nullptr;//nullptr marking the eventfd
+    epoll_ctl(this->m_nEpollFd, EPOLL_CTL_ADD, this->m_nEventFd, &stEvent);
+
+    for(size_t ii = 0; ii < std::max<size_t>(nConnCount, 1); ii++){
+        auto pConn = std::make_unique<StAsyncConn>();
+        pConn->pConn = CDBConnectPool::createConn(this->m_strErrMsg);
+        if(!pConn->pConn)
+            continue;
+
+        //edge triggered, the non-blocking calls being retried whenever the socket becoming readable or writable
+        stEvent.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        stEvent.data.ptr = pConn.get();
+        epoll_ctl(this->m_nEpollFd, EPOLL_CTL_ADD, pConn->pConn->net.fd, &stEvent);
+
+        this->m_vecConns.emplace_back(std::move(pConn));
+    }
+
+    auto pKillConn = std::make_unique<StAsyncConn>();
+    pKillConn->pConn = CDBConnectPool::createConn(this->m_strErrMsg);
+    if(pKillConn->pConn){
+        stEvent.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        stEvent.data.ptr = pKillConn.get();
+        epoll_ctl(this->m_nEpollFd, EPOLL_CTL_ADD, pKillConn->pConn->net.fd, &stEvent);
+        this->m_pKillConn = std::move(pKillConn);
+    }
+
+    this->m_loopThread = std::thread(&CDBAsyncEngine::eventLoop, this);
+}
+
+CDBAsyncEngine::~CDBAsyncEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_bStop = true;
+    }
+    this->wakeUp();
+
+    if(this->m_loopThread.joinable())
+        this->m_loopThread.join();
+
+    if(-1 != this->m_nEventFd)
+        close(this->m_nEventFd);
+    if(-1 != this->m_nEpollFd)
+        close(this->m_nEpollFd);
+}
+
+std::future<CDBAsyncEngine::queryResult> CDBAsyncEngine::submit(const std::string & strSQL, const std::optional<steadyClock::time_point> & deadline/*=std::nullopt*/,
+                                                                std::function<void()> onDone/*=nullptr*/)
+{
+    StAsyncQuery stQuery;
+    stQuery.strSQL = strSQL;
+    stQuery.deadline = deadline;
+    stQuery.onDone = std::move(onDone);
+    std::future<queryResult> future = stQuery.promise.get_future();
+
+    bool bQueued = false;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(!this->m_bStop && !this->m_vecConns.empty()){
+            this->m_deqPending.emplace_back(std::move(stQuery));
+            bQueued = true;
+        }
+    }
+
+    if(!bQueued){
+        stQuery.promise.set_value({std::string("such the async engine being unavailable:") + this->m_strErrMsg, {}});
+        if(stQuery.onDone)
+            stQuery.onDone();
+        return future;
+    }
+
+    this->wakeUp();
+    return future;
+}
+
+const std::string & CDBAsyncEngine::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+void CDBAsyncEngine::wakeUp()
+{
+    const std::uint64_t nValue = 1;
+    if(-1 != this->m_nEventFd)
+        (void)!write(this->m_nEventFd, &nValue, sizeof(nValue));
+}
+
+void CDBAsyncEngine::eventLoop()
+{
+    std::vector<epoll_event> vecEvents(64);
+    while(true){
+        {
+            std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+            if(this->m_bStop)
+                break;
+        }
+
+        this->expire();
+        this->dispatch();
+
+        //while any query running, wake up periodically to cover the data buffered inside the client library(such as TLS records),
+        //which being invisible to the socket, and to check the deadlines
+        bool bBusy = this->m_pKillConn && _EN_STAGE_IDLE_ != this->m_pKillConn->enStage;
+        for(const auto & pConn : this->m_vecConns)
+            bBusy = bBusy || _EN_STAGE_IDLE_ != pConn->enStage;
+
+        const int nCount = epoll_wait(this->m_nEpollFd, vecEvents.data(), static_cast<int>(vecEvents.size()), bBusy ? 10 : -1);
+        if(0 == nCount){
+            for(auto & pConn : this->m_vecConns)
+                this->advance(*pConn);
+            if(this->m_pKillConn)
+                this->advance(*this->m_pKillConn);
+            continue;
+        }
+
+        for(int ii = 0; ii < nCount; ii++){
+            if(nullptr == vecEvents[ii].data.ptr){
+                std::uint64_t nValue = 0;
+                (void)!read(this->m_nEventFd, &nValue, sizeof(nValue));
+                continue;
+            }
+
+            this->advance(*static_cast<StAsyncConn *>(vecEvents[ii].data.ptr));
+        }
+    }
+
+    //fail all the queries not completed
+    std::deque<StAsyncQuery> deqPending;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        deqPending.swap(this->m_deqPending);
+    }
+
+    for(auto & stQuery : deqPending){
+        stQuery.promise.set_value({std::string("such the async engine had been stopped"), {}});
+        if(stQuery.onDone)
+            stQuery.onDone();
+    }
+
+    for(auto & pConn : this->m_vecConns){
+        if(_EN_STAGE_IDLE_ != pConn->enStage)
+            this->complete(*pConn, {std::string("such the async engine had been stopped"), {}});
+    }
+}
+
+//start the pending queries on the idle conns
+void CDBAsyncEngine::dispatch()
+{
+    for(auto & pConn : this->m_vecConns){
+        if(_EN_STAGE_IDLE_ != pConn->enStage || pConn->bKillPending)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+            if(this->m_deqPending.empty())
+                return;
+
+            pConn->stQuery = std::move(this->m_deqPending.front());
+            this->m_deqPending.pop_front();
+        }
+
+        pConn->enStage = _EN_STAGE_QUERY_;
+        pConn->bKilled = false;
+        this->advance(*pConn);
+    }
+}
+
+//drop the expired queries being queued, and kill the expired queries being running
+void CDBAsyncEngine::expire()
+{
+    const auto now = steadyClock::now();
+
+    std::deque<StAsyncQuery> deqExpired;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        for(auto iter = this->m_deqPending.begin(); iter != this->m_deqPending.end();){
+            if(iter->deadline.has_value() && now >= *iter->deadline){
+                deqExpired.emplace_back(std::move(*iter));
+                iter = this->m_deqPending.erase(iter);
+            }else{
+                ++iter;
+            }
+        }
+    }
+
+    for(auto & stQuery : deqExpired){
+        stQuery.promise.set_value({std::string("query deadline exceeded before being executed"), {}});
+        if(stQuery.onDone)
+            stQuery.onDone();
+    }
+
+    for(auto & pConn : this->m_vecConns){
+        const auto & deadline = pConn->stQuery.deadline;
+        if(_EN_STAGE_IDLE_ == pConn->enStage || pConn->bKilled || !deadline.has_value() || now < *deadline)
+            continue;
+
+        //the query would fail with an error which being reported by advance
+        pConn->bKilled = true;
+        if(this->m_pKillConn){
+            pConn->bKillPending = true;
+            this->m_deqKills.emplace_back(pConn.get());
+        }
+    }
+
+    this->sendKill();
+}
+
+//send 'KILL QUERY' for the next conn on the side conn, being advanced by the loop as the other conns, the conns whose
+//queries completed before the kill being sent being skipped
+void CDBAsyncEngine::sendKill()
+{
+    while(this->m_pKillConn && _EN_STAGE_IDLE_ == this->m_pKillConn->enStage && !this->m_deqKills.empty()){
+        StAsyncConn * pTarget = this->m_deqKills.front();
+        this->m_deqKills.pop_front();
+        if(_EN_STAGE_IDLE_ == pTarget->enStage){
+            pTarget->bKillPending = false;
+            continue;
+        }
+
+        this->m_pKillTarget = pTarget;
+        this->m_pKillConn->stQuery.strSQL = std::string("KILL QUERY ") + std::to_string(mysql_thread_id(pTarget->pConn.get()));
+        this->m_pKillConn->enStage = _EN_STAGE_QUERY_;
+        this->advance(*this->m_pKillConn);
+    }
+}
+
+//step the query of such the conn forward as far as possible without blocking
+void CDBAsyncEngine::advance(StAsyncConn & stConn)
+{
+    MYSQL * pMySQL = stConn.pConn.get();
+
+    if(_EN_STAGE_QUERY_ == stConn.enStage){
+        const auto & strSQL = stConn.stQuery.strSQL;
+        const net_async_status enStatus = mysql_real_query_nonblocking(pMySQL, strSQL.data(), strSQL.size());
+        if(NET_ASYNC_NOT_READY == enStatus)
+            return;
+
+        if(NET_ASYNC_ERROR == enStatus){
+            this->complete(stConn, {std::string(mysql_error(pMySQL)), {}});
+            return;
+        }
+
+        stConn.enStage = _EN_STAGE_STORE_;
+    }
+
+    if(_EN_STAGE_STORE_ == stConn.enStage){
+        MYSQL_RES * pResult = nullptr;
+        const net_async_status enStatus = mysql_store_result_nonblocking(pMySQL, &pResult);
+        if(NET_ASYNC_NOT_READY == enStatus)
+            return;
+
+        std::unique_ptr<MYSQL_RES, decltype(&mysql_free_result)> pRes(pResult, &mysql_free_result);
+        if(NET_ASYNC_ERROR == enStatus || (nullptr == pRes && 0 != mysql_errno(pMySQL))){
+            this->complete(stConn, {std::string(mysql_error(pMySQL)), {}});
+            return;
+        }
+
+        //no result set for the statements such as insert
+        this->complete(stConn, {std::string(), pRes ? CDBManager::fetchResult(pRes.get()) : query_result()});
+    }
+}
+
+void CDBAsyncEngine::complete(StAsyncConn & stConn, queryResult && result)
+{
+    //the kill done or failed, the conn killed taking the next query again, the next kill being sent by expire
+    if(&stConn == this->m_pKillConn.get() && this->m_pKillTarget){
+        this->m_pKillTarget->bKillPending = false;
+        this->m_pKillTarget = nullptr;
+    }
+
+    if(stConn.bKilled && !result.first.empty())
+        result.first = std::string("query deadline exceeded, killed on the server:") + result.first;
+
+    stConn.enStage = _EN_STAGE_IDLE_;
+    stConn.stQuery.promise.set_value(std::move(result));
+    if(stConn.stQuery.onDone)
+        stConn.stQuery.onDone();
+
+    stConn.stQuery = StAsyncQuery();
+}
@@ -0,0 +1,98 @@
+#ifndef CDBASYNCENGINE_H
+#define CDBASYNCENGINE_H
+
+/*
+ * CDBAsyncEngine drives the queries by the non-blocking C API of MySQL 8(mysql_real_query_nonblocking and
+ * mysql_store_result_nonblocking) and an epoll loop, a single thread keeping all its conns busy, so the count
+ * of the queries in flight being capped by the conn count rather than the thread count.
+ *
+ * The conns being dedicated to the engine rather than borrowed from CDBConnectPool, for the non-blocking API
+ * switching the socket into non-blocking mode. Linux only for epoll and eventfd.
+ *
+ * The queries expired while running being killed by 'KILL QUERY' from a side conn, which being driven by the same
+ * loop with the non-blocking API as well, the loop NOT waiting for the round trip, and the conn killed NOT taking
+ * the next query until the kill done, such the kill NOT hitting the next one.
+ */
+
+#include "cdbmanager.h"
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <optional>
+#include <functional>
+
+class CDBAsyncEngine
+{
+public:
+    using steadyClock = std::chrono::steady_clock;
+    using queryResult = std::pair<std::string, query_result>;
+
+    explicit CDBAsyncEngine(const size_t nConnCount = 16);
+    ~CDBAsyncEngine();
+
+    //copy constructor and assignment operator prohibited
+    CDBAsyncEngine(const CDBAsyncEngine & ) = delete;
+    CDBAsyncEngine(const CDBAsyncEngine && ) = delete;
+    CDBAsyncEngine & operator=(const CDBAsyncEngine &) = delete;
+    CDBAsyncEngine & operator=(const CDBAsyncEngine &&) = delete;
+
+    //submit a query, the future being ready when its result arriving, and onDone being invoked on the loop thread right after,
+    //the query being dropped if it expires while queued, and being killed by 'KILL QUERY' if it expires while running
+    std::future<queryResult> submit(const std::string & strSQL, const std::optional<steadyClock::time_point> & deadline = std::nullopt,
+                                    std::function<void()> onDone = nullptr);
+
+    const std::string & getErrMsg() const;
+
+private:
+    enum QueryStage{
+        _EN_STAGE_IDLE_ = 0,    //no query on such the conn
+        _EN_STAGE_QUERY_,       //sending the query and waiting for the result header
+        _EN_STAGE_STORE_,       //reading the rows of the result
+    };
+
+    typedef struct ST_asyncQuery{
+        std::string strSQL;
+        std::optional<steadyClock::time_point> deadline;
+        std::promise<queryResult> promise;
+        std::function<void()> onDone;
+    }StAsyncQuery;
+
+    typedef struct ST_asyncConn{
+        CDBConnectPool::DBConnPtr pConn{nullptr, &mysql_close};
+        QueryStage enStage = _EN_STAGE_IDLE_;
+        StAsyncQuery stQuery;
+        bool bKilled = false;
+        bool bKillPending = false;//'KILL QUERY' for its query NOT done yet, the conn NOT taking the next query
+    }StAsyncConn;
+
+    void eventLoop();
+    void dispatch();
+    void expire();
+    void sendKill();
+    void advance(StAsyncConn & stConn);
+    void complete(StAsyncConn & stConn, queryResult && result);
+    void wakeUp();
+
+private:
+    std::string m_strErrMsg;
+    int m_nEpollFd = -1;
+    int m_nEventFd = -1;//waking up the loop when a query submitted
+
+    //touched by the loop thread only, the addresses being stable for they being registered into epoll
+    std::vector<std::unique_ptr<StAsyncConn>> m_vecConns;
+    std::unique_ptr<StAsyncConn> m_pKillConn;//side conn to kill the expired queries, registered into epoll as well
+    std::deque<StAsyncConn *> m_deqKills;//the conns whose queries to be killed
+    StAsyncConn * m_pKillTarget = nullptr;//the conn being killed by m_pKillConn
+
+    std::mutex m_mtx;
+    std::deque<StAsyncQuery> m_deqPending;
+    bool m_bStop = false;
+
+    std::thread m_loopThread;
+};
+
+#endif // CDBASYNCENGINE_H
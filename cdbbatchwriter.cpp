@@ -0,0 +1,176 @@
+#include "cdbbatchwriter.h"
+
+#include <memory>
+#include <algorithm>
+
+static constexpr size_t g_nMinPacketSize = 4096;//the packet size assumed at least, max_allowed_packet being 1024 at least
+
+CDBBatchWriter::CDBBatchWriter(const std::string & strTable, const std::string & strColumns, const size_t nMaxRows/*=1000*/,
+                               const std::chrono::milliseconds flushInterval/*=50ms*/, CDBManager & dbManager/*=DBOPT*/)
+    : m_dbManager(dbManager), m_flushInterval(flushInterval)
+{
+    if(0 != nMaxRows)
+        this->m_nMaxRows = nMaxRows;
+
+    this->m_strInsertHead = std::string("insert into ") + strTable + std::string(" (") + strColumns + std::string(") values ");
+
+    //the statement being sent as a single packet, so it can NOT be larger than max_allowed_packet of the server,
+    //and the values quoted by CSQLFormat::quote being escaped by backslash, NOT supporting NO_BACKSLASH_ESCAPES
+    auto && query_result = this->m_dbManager.query("select @@max_allowed_packet as max_packet, "
+                                                   "@@sql_mode like '%NO_BACKSLASH_ESCAPES%' as no_backslash");
+    if(query_result.has_value()){
+        auto && pairResult = query_result->get();
+        try{
+            if(pairResult.first.empty() && !pairResult.second.empty()){
+                //headroom for the packet header, the value too small or read as 0 NOT being wrapped around
+                const size_t nPacket = pairResult.second.getItem<size_t>(0, "max_packet");
+                this->m_nMaxPacketSize = std::max(nPacket, g_nMinPacketSize) - 1024;
+
+                if(0 != pairResult.second.getItem<int>(0, "no_backslash"))
+                    std::cout << "NO_BACKSLASH_ESCAPES being NOT supported, the values with backslash being written wrongly" << std::endl;
+            }
+        }catch(const std::exception & e){
+            std::cout << "failed to get max_allowed_packet, using the default:" << e.what() << std::endl;
+        }
+    }
+
+    this->m_flushThread = std::thread(&CDBBatchWriter::flushLoop, this);
+}
+
+CDBBatchWriter::~CDBBatchWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_bStop = true;
+    }
+    this->m_cv.notify_one();
+    this->m_flushThread.join();
+
+    //the callbacks of the batches in flight referring to this object
+    std::unique_lock<std::mutex> lock(this->m_mtxInFlight);
+    this->m_cvInFlight.wait(lock, [this](){ return 0 == this->m_nInFlight; });
+}
+
+std::future<CDBBatchWriter::rowResult> CDBBatchWriter::addRow(std::string strValues)
+{
+    StPendingRow stRow;
+    stRow.strValues = std::move(strValues);
+    std::future<rowResult> future = stRow.promise.get_future();
+
+    //a row NOT fitting in a statement alone being rejected here, otherwise its batch being rolled back with all the others
+    if(this->m_strInsertHead.size() + stRow.strValues.size() > this->m_nMaxPacketSize){
+        stRow.promise.set_value(std::make_pair(false, std::string("Such the row of ") + std::to_string(stRow.strValues.size())
+                                               + std::string(" bytes being larger than max_allowed_packet of ")
+                                               + std::to_string(this->m_nMaxPacketSize) + std::string(" bytes")));
+        return future;
+    }
+
+    bool bFull = false;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(this->m_bStop){
+            stRow.promise.set_value(std::make_pair(false, std::string("Such the batch writer had been stopped")));
+            return future;
+        }
+
+        this->m_nPendingBytes += stRow.strValues.size() + 1;
+        this->m_vecPending.emplace_back(std::move(stRow));
+        bFull = this->m_vecPending.size() >= this->m_nMaxRows || this->m_nPendingBytes >= this->m_nMaxPacketSize;
+    }
+
+    if(bFull)
+        this->m_cv.notify_one();
+
+    return future;
+}
+
+void CDBBatchWriter::flush()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_bFlushRequested = true;
+    }
+    this->m_cv.notify_one();
+}
+
+CDBBatchWriter & CDBBatchWriter::setMaxInFlight(const size_t nMaxInFlight)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxInFlight);
+    if(0 != nMaxInFlight)
+        this->m_nMaxInFlight = nMaxInFlight;
+    return *this;
+}
+
+//flush the pending rows on size or time
+void CDBBatchWriter::flushLoop()
+{
+    while(true){
+        std::vector<StPendingRow> vecRows;
+        {
+            std::unique_lock<std::mutex> lock(this->m_mtx);
+            this->m_cv.wait_for(lock, this->m_flushInterval, [this](){
+                return this->m_bStop || this->m_bFlushRequested || this->m_vecPending.size() >= this->m_nMaxRows
+                       || this->m_nPendingBytes >= this->m_nMaxPacketSize;
+            });
+
+            //woken up by the flush interval elapsing or the conditions above, flush all the pending rows
+            if(this->m_vecPending.empty()){
+                if(this->m_bStop)
+                    return;
+                this->m_bFlushRequested = false;
+                continue;
+            }
+
+            vecRows.swap(this->m_vecPending);
+            this->m_nPendingBytes = 0;
+            this->m_bFlushRequested = false;
+        }
+
+        this->dispatch(std::move(vecRows));
+    }
+}
+
+//coalesce the rows into multi-row insert statements limited by the packet size, and commit them as one batch
+void CDBBatchWriter::dispatch(std::vector<StPendingRow> && vecRows)
+{
+    std::vector<std::string> vecSQL;
+    auto pPromises = std::make_shared<std::vector<std::promise<rowResult>>>();
+    pPromises->reserve(vecRows.size());
+
+    std::string strSQL;
+    for(auto & stRow : vecRows){
+        if(!strSQL.empty() && strSQL.size() + stRow.strValues.size() + 1 > this->m_nMaxPacketSize){
+            vecSQL.emplace_back(std::move(strSQL));
+            strSQL.clear();
+        }
+
+        if(strSQL.empty()){
+            strSQL = this->m_strInsertHead;
+        }else{
+            strSQL += ',';
+        }
+
+        strSQL += stRow.strValues;
+        pPromises->emplace_back(std::move(stRow.promise));
+    }
+    vecSQL.emplace_back(std::move(strSQL));
+
+    //bounded batches in flight, the flush loop being blocked as a backpressure
+    {
+        std::unique_lock<std::mutex> lock(this->m_mtxInFlight);
+        this->m_cvInFlight.wait(lock, [this](){ return this->m_nInFlight < this->m_nMaxInFlight; });
+        ++this->m_nInFlight;
+    }
+
+    this->m_dbManager.execute(vecSQL, [this, pPromises](const std::string & strErrMsg, const std::uint64_t nAffectedRows){
+        (void)nAffectedRows;
+        for(auto & promise : *pPromises){
+            promise.set_value(std::make_pair(strErrMsg.empty(), strErrMsg));
+        }
+
+        //notify with the lock held, the destructor waiting on it being able to return right after the unlock
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxInFlight);
+        --this->m_nInFlight;
+        this->m_cvInFlight.notify_all();
+    });
+}
@@ -0,0 +1,90 @@
+#ifndef CDBBATCHWRITER_H
+#define CDBBATCHWRITER_H
+
+/*
+ * CDBBatchWriter coalesces the appended rows into multi-row 'INSERT ... VALUES' statements, which being
+ * flushed when the pending rows reaching the given count or the max_allowed_packet size, or when the flush
+ * interval elapsing. Every batch being committed once in a transaction through CDBManager::execute, and the
+ * future of each row being ready when the batch containing it committed or rolled back.
+ *
+ * CDBBatchWriter is thread-safe, rows could be appended from various threads.
+ */
+
+#include "cdbmanager.h"
+#include "csqlformat.h"
+
+#include <string>
+#include <vector>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class CDBBatchWriter
+{
+public:
+    using rowResult = std::pair<bool, std::string>;//true on success, otherwise false and relative error message
+
+    CDBBatchWriter(const std::string & strTable, const std::string & strColumns, const size_t nMaxRows = 1000,
+                   const std::chrono::milliseconds flushInterval = std::chrono::milliseconds(50), CDBManager & dbManager = DBOPT);
+
+    //the pending rows being flushed, and waiting for all the batches in flight
+    ~CDBBatchWriter();
+
+    //copy constructor and assignment operator prohibited
+    CDBBatchWriter(const CDBBatchWriter & ) = delete;
+    CDBBatchWriter(const CDBBatchWriter && ) = delete;
+    CDBBatchWriter & operator=(const CDBBatchWriter &) = delete;
+    CDBBatchWriter & operator=(const CDBBatchWriter &&) = delete;
+
+    //append a row formatted as "(v1,v2,...)", the returned future being ready when its batch committed
+    //a row larger than max_allowed_packet with the insert head being rejected, the future being ready with the error
+    std::future<rowResult> addRow(std::string strValues);
+
+    //append a typed row, formatted by CSQLFormat::toValues
+    template<class T>
+    std::future<rowResult> add(const T & row){
+        return this->addRow(CSQLFormat::toValues(row));
+    }
+
+    //flush the pending rows right now without waiting for the flush interval
+    void flush();
+
+    //set the max count of the batches being committed concurrently, 4 by default
+    CDBBatchWriter & setMaxInFlight(const size_t nMaxInFlight);
+
+private:
+    typedef struct ST_pendingRow{
+        std::string strValues;
+        std::promise<rowResult> promise;
+    }StPendingRow;
+
+    void flushLoop();
+    void dispatch(std::vector<StPendingRow> && vecRows);
+
+private:
+    CDBManager & m_dbManager;
+    std::string m_strInsertHead;//"insert into table (columns) values "
+    size_t m_nMaxRows = 1000;
+    size_t m_nMaxPacketSize = 4 * 1024 * 1024;//updated by the server variable max_allowed_packet
+    std::chrono::milliseconds m_flushInterval;
+
+    //rows waiting for being flushed
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::vector<StPendingRow> m_vecPending;
+    size_t m_nPendingBytes = 0;
+    bool m_bFlushRequested = false;
+    bool m_bStop = false;
+
+    //batches being committed
+    std::mutex m_mtxInFlight;
+    std::condition_variable m_cvInFlight;
+    size_t m_nInFlight = 0;
+    size_t m_nMaxInFlight = 4;
+
+    std::thread m_flushThread;
+};
+
+#endif // CDBBATCHWRITER_H
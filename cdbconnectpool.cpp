@@ -25,6 +25,11 @@ void CDBConnectPool::connect2DB()
             continue;
         }
 
+        //NOT allowing 'load data local infile' on the pooled conns, otherwise a rogue server being able to answer any
+        //query with a request for a local file, CDBManager::loadData using a standalone conn instead
+        unsigned int nLocalInfile = 0;
+        mysql_options(pConnTemp.get(), MYSQL_OPT_LOCAL_INFILE, &nLocalInfile);
+
         auto pRet = mysql_real_connect(pConnTemp.get(),
                                        DBparams.strIp.c_str(),
                                        DBparams.strUsername.c_str(),
@@ -77,6 +82,11 @@ std::pair<std::atomic<bool>, CDBConnectPool::DBConnPtr> & CDBConnectPool::getACo
             continue;
         }
 
+        //NOT allowing 'load data local infile' on the pooled conns, otherwise a rogue server being able to answer any
+        //query with a request for a local file, CDBManager::loadData using a standalone conn instead
+        unsigned int nLocalInfile = 0;
+        mysql_options(pConnTemp.get(), MYSQL_OPT_LOCAL_INFILE, &nLocalInfile);
+
         auto pRet = mysql_real_connect(pConnTemp.get(),
                                        DBparams.strIp.c_str(),
                                        DBparams.strUsername.c_str(),
@@ -94,3 +104,28 @@ std::pair<std::atomic<bool>, CDBConnectPool::DBConnPtr> & CDBConnectPool::getACo
         }
     }
 }
+
+CDBConnectPool::DBConnPtr CDBConnectPool::createConn(std::string & strErrMsg, const bool bLocalInfile/*=false*/)
+{
+    DBConnPtr pConn(mysql_init(NULL), &mysql_close);
+    if(!pConn){
+        strErrMsg = std::string("failed to calling 'mysql_init'...");
+        return pConn;
+    }
+
+    unsigned int nLocalInfile = bLocalInfile ? 1 : 0;
+    mysql_options(pConn.get(), MYSQL_OPT_LOCAL_INFILE, &nLocalInfile);
+
+    auto pRet = mysql_real_connect(pConn.get(),
+                                   DBparams.strIp.c_str(),
+                                   DBparams.strUsername.c_str(),
+                                   DBparams.strPassword.c_str(),
+                                   DBparams.strDBName.c_str(),
+                                   DBparams.nPort, NULL, 0);
+    if(nullptr == pRet){
+        strErrMsg = std::string(mysql_error(pConn.get()));
+        pConn.reset();
+    }
+
+    return pConn;
+}
@@ -11,7 +11,7 @@
 
 class CDBConnectPool
 {
-private:
+public:
     using DBConnPtr = std::unique_ptr<MYSQL, decltype(&mysql_close)>;
 
 public:
@@ -23,6 +23,10 @@ public:
 
     std::pair<std::atomic<bool>, DBConnPtr> & getAConn();
 
+    //create a standalone conn NOT managed by the pool, return nullptr and relative error message on failure,
+    //'load data local infile' being allowed only if bLocalInfile, the caller installing its own infile handler then
+    static DBConnPtr createConn(std::string & strErrMsg, const bool bLocalInfile = false);
+
     //manager the DB conn returned by method getAConn
     class ConnManager{
     public:
@@ -1,9 +1,29 @@
 #include "cdbmanager.h"
+#include "cdbasyncengine.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+static constexpr const char * g_szInfileName = "memory_stream";//the only file name served by the infile handler
 
 CDBManager::CDBManager(const size_t nThreadCount/*=4*/, const size_t nConnCount/*=10*/):m_threadPool(nThreadCount), m_connPool(nConnCount)
-{}
+{
+    this->m_watchThread = std::thread(&CDBManager::watchLoop, this);
+}
+
+CDBManager::~CDBManager()
+{
+    this->m_pAsyncEngine.reset();//the queries in it referring to the in-flight count
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxWatch);
+        this->m_bStopWatch = true;
+    }
+    this->m_cvWatch.notify_one();
+    this->m_watchThread.join();
+}
 
 
 template<typename Func, typename... Args>
@@ -13,46 +33,362 @@ auto CDBManager::submit(Func && func, Args&&... args)->std::future<decltype(func
 }
 
 CDBManager::optResult CDBManager::query(const std::string & strSQL)
+{
+    return this->submitQuery(strSQL, std::nullopt);
+}
+
+CDBManager::optResult CDBManager::query(const std::string & strSQL, const std::chrono::milliseconds timeout)
+{
+    return this->submitQuery(strSQL, steadyClock::now() + timeout);
+}
+
+CDBManager & CDBManager::setMaxInFlight(const size_t nMaxInFlight)
+{
+    this->m_nMaxInFlight.store(nMaxInFlight);
+    return *this;
+}
+
+CDBManager & CDBManager::enableAsyncEngine(const size_t nConnCount/*=16*/)
+{
+    this->m_pAsyncEngine = std::make_unique<CDBAsyncEngine>(nConnCount);
+    if(!this->m_pAsyncEngine->getErrMsg().empty())
+        std::cout << "async engine error message:" << this->m_pAsyncEngine->getErrMsg() << std::endl;
+
+    return *this;
+}
+
+CDBManager::optResult CDBManager::submitQuery(const std::string & strSQL, const std::optional<steadyClock::time_point> deadline)
 {
     if(strSQL.empty())
         return std::nullopt;
 
-    auto query_lambda = [this, strSQL]()->std::pair<std::string, query_result>{
+    //fail fast when too many queries in flight, rather than queueing them without bound
+    const size_t nMaxInFlight = this->m_nMaxInFlight.load();
+    if(this->m_nInFlight.fetch_add(1) >= nMaxInFlight && 0 != nMaxInFlight){
+        this->m_nInFlight.fetch_sub(1);
+
+        std::promise<std::pair<std::string, query_result>> promise;
+        promise.set_value({std::string("too many queries in flight, rejected by the admission limit"), {}});
+        return promise.get_future();
+    }
+
+    //the engine killing the expired queries by itself
+    if(this->m_pAsyncEngine){
+        return this->m_pAsyncEngine->submit(strSQL, deadline, [this](){
+            this->m_nInFlight.fetch_sub(1);
+        });
+    }
+
+    auto query_lambda = [this, strSQL, deadline]()->std::pair<std::string, query_result>{
+        //leave the in-flight count whenever such the task returning
+        std::unique_ptr<std::atomic<size_t>, void(*)(std::atomic<size_t> *)> pInFlightGuard(&this->m_nInFlight, [](std::atomic<size_t> * pCount){
+            pCount->fetch_sub(1);
+        });
+
+        //expired while being queued, drop it before taking a conn
+        if(deadline.has_value() && steadyClock::now() >= *deadline)
+            return {std::string("query deadline exceeded before being executed"), {}};
+
         auto & pConn = this->m_connPool.getAConn();
         CDBConnectPool::ConnManager connManger(pConn);
 
         std::cout << "thread_id:" << std::this_thread::get_id() << "  conn_address:" << pConn.second.get() << std::endl;
 
-        //perform db query
-        if (mysql_query(pConn.second.get(), strSQL.c_str())) {
-            return {std::string(mysql_error(pConn.second.get())), {}};
+        if(!deadline.has_value())
+            return runQuery(pConn.second.get(), strSQL);
+
+        //hand the running query to the watchdog, which would kill it when the deadline passing
+        std::uint64_t nToken = 0;
+        {
+            std::lock_guard<std::mutex> lock_guard(this->m_mtxWatch);
+            nToken = ++this->m_nWatchToken;
+            this->m_mpWatching.emplace(nToken, StWatchItem{*deadline, mysql_thread_id(pConn.second.get()), false, false});
         }
+        this->m_cvWatch.notify_one();
+
+        auto && pairResult = runQuery(pConn.second.get(), strSQL);
 
-        //get the result
-        std::unique_ptr<MYSQL_RES, decltype(&mysql_free_result)> pRes(mysql_store_result(pConn.second.get()), &mysql_free_result);
-        if (nullptr == pRes) {
-            return {std::string(mysql_error(pConn.second.get())), {}};
+        //NOTE: the item being killed NOT being erased until 'KILL QUERY' done, so such the conn can NOT be killed after
+        //it returned to the pool and being used by another query
+        std::unique_lock<std::mutex> lock(this->m_mtxWatch);
+        auto iter = this->m_mpWatching.find(nToken);
+        this->m_cvKilled.wait(lock, [&iter](){
+            return !iter->second.bKilling;
+        });
+        if(iter->second.bKilled && !pairResult.first.empty())
+            pairResult.first = std::string("query deadline exceeded, killed on the server:") + pairResult.first;
+        this->m_mpWatching.erase(iter);
+
+        return std::move(pairResult);
+    };
+
+    try{
+        return this->submit(query_lambda);
+    }catch(...){
+        this->m_nInFlight.fetch_sub(1);
+        throw;
+    }
+}
+
+//perform the query and get all the rows of its result
+std::pair<std::string, query_result> CDBManager::runQuery(MYSQL * pMySQL, const std::string & strSQL)
+{
+    //perform db query
+    if (mysql_query(pMySQL, strSQL.c_str())) {
+        return {std::string(mysql_error(pMySQL)), {}};
+    }
+
+    //get the result
+    std::unique_ptr<MYSQL_RES, decltype(&mysql_free_result)> pRes(mysql_store_result(pMySQL), &mysql_free_result);
+    if (nullptr == pRes) {
+        return {std::string(mysql_error(pMySQL)), {}};
+    }
+
+    return {std::string(), fetchResult(pRes.get())};
+}
+
+//get all the rows of the stored result
+query_result CDBManager::fetchResult(MYSQL_RES * pRes)
+{
+    MYSQL_FIELD *fields = mysql_fetch_fields(pRes);
+    int nFiledCount = mysql_num_fields(pRes);
+    MYSQL_ROW row = nullptr;
+
+    int nRowCount = 0;
+    query_result mpResult;
+    while ((row = mysql_fetch_row(pRes))) {
+        hash_map<std::string, std::string> mpFiledValue;//a row, key->field name, value->field value
+        unsigned long * pLengths = mysql_fetch_lengths(pRes);//the binary values such as geometry containing '\0'
+
+        for (int i = 0; i < nFiledCount; i++) {
+            mpFiledValue.emplace(std::string(fields[i].name), row[i] ? std::string(row[i], pLengths[i]) : std::string("NULL"));
         }
 
-        //get the result of the query
-        MYSQL_FIELD *fields = mysql_fetch_fields(pRes.get());
-        int nFiledCount = mysql_num_fields(pRes.get());
-        MYSQL_ROW row = nullptr;
+        mpResult.emplace(nRowCount++, std::move(mpFiledValue));
+    }
+
+    return mpResult;
+}
+
+//kill the running queries whose deadline passed, from a side conn
+void CDBManager::watchLoop()
+{
+    std::unique_lock<std::mutex> lock(this->m_mtxWatch);
+    while(!this->m_bStopWatch){
+        //sleep until the earliest deadline of the queries not killed yet
+        std::optional<steadyClock::time_point> nextDeadline;
+        for(const auto & [nToken, stItem] : this->m_mpWatching){
+            (void)nToken;
+            if(!stItem.bKilled && (!nextDeadline.has_value() || stItem.deadline < *nextDeadline))
+                nextDeadline = stItem.deadline;
+        }
+
+        if(nextDeadline.has_value())
+            this->m_cvWatch.wait_until(lock, *nextDeadline);
+        else
+            this->m_cvWatch.wait(lock);
+
+        //the expired ones being collected with the lock held, and killed without it, the queries registering and
+        //finishing NOT waiting for a conn of the pool and the round trips of 'KILL QUERY'
+        const auto now = steadyClock::now();
+        std::vector<std::pair<std::uint64_t, unsigned long>> vecExpired;//the token and the thread id
+        for(auto & [nToken, stItem] : this->m_mpWatching){
+            if(this->m_bStopWatch || stItem.bKilled || stItem.deadline > now)
+                continue;
+
+            stItem.bKilled = true;
+            stItem.bKilling = true;
+            vecExpired.emplace_back(nToken, stItem.nMySQLThreadId);
+        }
+
+        if(vecExpired.empty())
+            continue;
+
+        lock.unlock();
+        this->killQueries(vecExpired);
+        lock.lock();
+
+        for(const auto & item : vecExpired){
+            auto iter = this->m_mpWatching.find(item.first);
+            if(this->m_mpWatching.end() != iter)
+                iter->second.bKilling = false;
+        }
+        this->m_cvKilled.notify_all();
+    }
+}
 
-        int nRowCount = 0;
-        query_result mpResult;
-        while ((row = mysql_fetch_row(pRes.get()))) {
-            hash_map<std::string, std::string> mpFiledValue;//a row, key->field name, value->field value
+//kill the queries on the server by their thread ids, from a single side conn
+void CDBManager::killQueries(const std::vector<std::pair<std::uint64_t, unsigned long>> & vecExpired)
+{
+    try{
+        auto & pConn = this->m_connPool.getAConn();
+        CDBConnectPool::ConnManager connManger(pConn);
 
-            for (int i = 0; i < nFiledCount; i++) {
-                mpFiledValue.emplace(std::string(fields[i].name), std::string(row[i] ? row[i] : "NULL"));
+        for(const auto & item : vecExpired){
+            const std::string && strKill = std::string("KILL QUERY ") + std::to_string(item.second);
+            if(mysql_query(pConn.second.get(), strKill.c_str())){
+                std::cout << "failed to kill the expired query:" << mysql_error(pConn.second.get()) << std::endl;
             }
+        }
+    }catch(const std::exception & e){
+        std::cout << "failed to kill the expired query:" << e.what() << std::endl;
+    }
+}
+
+bool CDBManager::execute(const std::vector<std::string> & vecSQL, execCallback callback)
+{
+    if(vecSQL.empty() || !callback)
+        return false;
 
-            mpResult.emplace(nRowCount++, std::move(mpFiledValue));
+    auto execute_lambda = [this, vecSQL, callback]()->void{
+        std::pair<std::string, std::uint64_t> pairResult;
+        try{
+            pairResult = this->executeInTransaction(vecSQL);
+        }catch(const std::exception & e){
+            pairResult = {std::string(e.what()), 0};//such as failing to get a conn
         }
 
-        return {std::string(), std::move(mpResult)};
+        callback(pairResult.first, pairResult.second);
     };
 
-    return this->submit(query_lambda);
+    this->submit(execute_lambda);
+    return true;
+}
+
+//return the error message(empty on success) and the affected row count
+std::pair<std::string, std::uint64_t> CDBManager::executeInTransaction(const std::vector<std::string> & vecSQL)
+{
+    auto & pConn = this->m_connPool.getAConn();
+    CDBConnectPool::ConnManager connManger(pConn);
+    MYSQL * pMySQL = pConn.second.get();
+
+    //open a transaction, all the statements being committed once
+    if(mysql_autocommit(pMySQL, false)){
+        return {std::string(mysql_error(pMySQL)), 0};
+    }
+
+    //roll back and restore the autocommit mode of such the conn before it being returned to the pool
+    auto rollback = [pMySQL]()->std::string{
+        std::string strErrMsg(mysql_error(pMySQL));
+        mysql_rollback(pMySQL);
+        mysql_autocommit(pMySQL, true);
+        return strErrMsg;
+    };
+
+    std::uint64_t nAffectedRows = 0;
+    for(const auto & strSQL : vecSQL){
+        if(mysql_real_query(pMySQL, strSQL.data(), strSQL.size())){
+            return {rollback(), 0};
+        }
+
+        nAffectedRows += mysql_affected_rows(pMySQL);
+    }
+
+    if(mysql_commit(pMySQL)){
+        return {rollback(), 0};
+    }
+
+    mysql_autocommit(pMySQL, true);
+    return {std::string(), nAffectedRows};
+}
+
+CDBManager::loadResult CDBManager::loadData(const std::string & strTable, const std::string & strColumns, lineGenerator generator, const LoadFormat enFormat/*=_EN_LOAD_TSV_*/,
+                                            const std::string & strSet/*=std::string()*/)
+{
+    if(strTable.empty() || !generator || enFormat >= _EN_INVALID_LOAD_FORMAT_LAST_)
+        return std::nullopt;
+
+    //the file name being meaningless, the data being provided by the infile handler
+    std::string strSQL = std::string("load data local infile '") + g_szInfileName + std::string("' into table ") + strTable;
+    if(_EN_LOAD_CSV_ == enFormat)
+        strSQL += " fields terminated by ',' optionally enclosed by '\"' lines terminated by '\\n'";
+    else
+        strSQL += " fields terminated by '\\t' escaped by '\\\\' lines terminated by '\\n'";
+
+    if(!strColumns.empty())
+        strSQL += std::string(" (") + strColumns + std::string(")");
+
+    if(!strSet.empty())
+        strSQL += std::string(" set ") + strSet;
+
+    auto load_lambda = [this, strSQL, generator]()->std::pair<std::string, std::uint64_t>{
+        //a standalone conn allowing local infile, closed after the load, the pooled conns NOT allowing it at all
+        std::string strErrMsg;
+        auto pConn = CDBConnectPool::createConn(strErrMsg, true);
+        if(!pConn)
+            return {strErrMsg, 0};
+
+        MYSQL * pMySQL = pConn.get();
+
+        StInfileReader stReader;
+        stReader.generator = generator;
+        mysql_set_local_infile_handler(pMySQL, &CDBManager::infileInit, &CDBManager::infileRead,
+                                       &CDBManager::infileEnd, &CDBManager::infileError, &stReader);
+
+        const int nRet = mysql_real_query(pMySQL, strSQL.data(), strSQL.size());
+        if(nRet){
+            return {std::string(mysql_error(pMySQL)), 0};
+        }
+
+        return {std::string(), mysql_affected_rows(pMySQL)};
+    };
+
+    return this->submit(load_lambda);
+}
+
+/************************************************************
+ ******************load data infile callbacks****************
+ ************************************************************/
+int CDBManager::infileInit(void ** ppReader, const char * pFileName, void * pUserData)
+{
+    *ppReader = pUserData;
+
+    //the server asking for any other file being refused
+    if(nullptr == pFileName || 0 != std::strcmp(pFileName, g_szInfileName)){
+        static_cast<StInfileReader *>(pUserData)->strErrMsg = std::string("refused the local infile requested:")
+                                                              + (nullptr == pFileName ? "" : pFileName);
+        return 1;
+    }
+
+    return 0;
+}
+
+//fill the buffer given by mysql, the rows being produced on demand
+int CDBManager::infileRead(void * pReader, char * pBuf, unsigned int nBufLen)
+{
+    StInfileReader * pInfile = static_cast<StInfileReader *>(pReader);
+
+    //drop the rows already read, and produce rows until enough for the buffer of mysql
+    if(pInfile->nOffset > 0){
+        pInfile->strBuffer.erase(0, pInfile->nOffset);
+        pInfile->nOffset = 0;
+    }
+
+    try{
+        while(!pInfile->bEnd && pInfile->strBuffer.size() < nBufLen){
+            if(!pInfile->generator(pInfile->strBuffer))
+                pInfile->bEnd = true;
+        }
+    }catch(const std::exception & e){
+        pInfile->strErrMsg = std::string("failed to generate rows:") + e.what();
+        return -1;
+    }
+
+    const size_t nCopySize = std::min(static_cast<size_t>(nBufLen), pInfile->strBuffer.size());
+    std::memcpy(pBuf, pInfile->strBuffer.data(), nCopySize);
+    pInfile->nOffset = nCopySize;
+
+    return static_cast<int>(nCopySize);//0 meaning the end of the stream
+}
+
+void CDBManager::infileEnd(void * pReader)
+{
+    (void)pReader;//the reader being owned by the load task
+}
+
+int CDBManager::infileError(void * pReader, char * pErrMsg, unsigned int nErrMsgLen)
+{
+    StInfileReader * pInfile = static_cast<StInfileReader *>(pReader);
+    std::snprintf(pErrMsg, nErrMsgLen, "%s", pInfile->strErrMsg.c_str());
+    return 2000;//CR_UNKNOWN_ERROR
 }
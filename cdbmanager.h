@@ -3,9 +3,17 @@
 
 #include "threadPool.hpp"
 #include "cdbconnectpool.h"
+#include "csqlformat.h"
+#include "ctemporalparser.h"
+#include "cwkbparser.h"
 
 #include <optional>
 #include <sstream>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <map>
+#include <type_traits>
 
 template<typename key, typename value>
 using hash_map = std::unordered_map<key, value>;
@@ -14,7 +22,7 @@ using map_result = hash_map<std::uint64_t, hash_map<std::string, std::string>>;
 class query_result : public map_result{
     public:
     template<class T>
-    T getItem(const size_t nIndex, const std::string & strFieldName)
+    T getItem(const size_t nIndex, const std::string & strFieldName) const
     {
         if(!this->count(nIndex))
             throw std::out_of_range("invalid nIndex access...");
@@ -27,9 +35,27 @@ class query_result : public map_result{
 
         T retValue;
         const std::string & strValue = this->at(nIndex).at(strFieldName);
-        std::istringstream stream(strValue);
-        if (!(stream >> retValue)) {
-            throw std::invalid_argument("invalid conversion from string to " + std::string(typeid(T).name()));
+
+        //the fixed-width temporal values being parsed without iostream, the others falling back to the stream
+        if constexpr (std::is_same_v<T, StDate> || std::is_same_v<T, StTime> || std::is_same_v<T, StDateTime>){
+            if(EN_PARSE_OK == CTemporalParser::parse(strValue, retValue))
+                return retValue;
+        }
+
+        //the geometry columns being returned in the internal binary format of MySQL, decoded without any text,
+        //the geometry values being formatted as text such as '(x,y)' falling back to the stream
+        if constexpr (CWKBParser::isGeometry<T>::value){
+            if(EN_WKB_OK == CWKBParser::decode(strValue, retValue))
+                return retValue;
+        }
+
+        if constexpr (CWKBParser::isCircle<T>::value){
+            throw std::invalid_argument("invalid conversion from binary to " + std::string(typeid(T).name()));
+        }else{
+            std::istringstream stream(strValue);
+            if (!(stream >> retValue)) {
+                throw std::invalid_argument("invalid conversion from string to " + std::string(typeid(T).name()));
+            }
         }
 
         return retValue;
@@ -37,30 +63,139 @@ class query_result : public map_result{
 };
 
 
+class CDBAsyncEngine;
+
+//format of the lines streamed by CDBManager::loadData
+enum LoadFormat{
+    _EN_LOAD_TSV_ = 0,  //tab separated and backslash escaped, the default format of 'load data'
+    _EN_LOAD_CSV_,      //comma separated, the fields optionally enclosed by '"'
+
+    //Do NOT Use the below
+    _EN_INVALID_LOAD_FORMAT_LAST_,
+};
 
 class CDBManager
 {
 public:
     static CDBManager & getInst(){
-        static CDBManager inst(1, 1);
+        static CDBManager inst(4, 10);
         return inst;
     }
 
 public:
     explicit CDBManager(const size_t nThreadCount = 4, const size_t nConnCount = 10);
+    ~CDBManager();
 
     //std::optional<std::future<std::pair<std::string, std::unordered_map<std::uint64_t, std::unordered_map<std::string, std::string>>>>>
     using optResult = std::optional<std::future<std::pair<std::string, query_result>>>;
     optResult query(const std::string & strSQL);
 
+    //query with a deadline, the query being dropped without running if it expires while queued, and being killed
+    //by 'KILL QUERY' from a side conn if it is still running when the deadline passes
+    optResult query(const std::string & strSQL, const std::chrono::milliseconds timeout);
+
+    //max count of the queries in flight(queued or running), the query over it failing fast with an error message
+    //rather than being queued, 0 meaning unlimited by default
+    CDBManager & setMaxInFlight(const size_t nMaxInFlight);
+
+    //drive the queries by the event-driven engine on nConnCount dedicated conns rather than the worker threads,
+    //the signature of query being kept, NOTE: it should be called before any query submitted
+    CDBManager & enableAsyncEngine(const size_t nConnCount = 16);
+
+    //get all the rows of the stored result
+    static query_result fetchResult(MYSQL_RES * pRes);
+
+    //execute the given write statements on one connection within a single transaction, committing once for all of them,
+    //the callback being invoked on the worker thread with the error message(empty on success) and the affected row count
+    using execCallback = std::function<void(const std::string & strErrMsg, const std::uint64_t nAffectedRows)>;
+    bool execute(const std::vector<std::string> & vecSQL, execCallback callback);
+
+    //append the next row(s), each terminated by '\n', into the buffer, return false when no more rows
+    using lineGenerator = std::function<bool(std::string & strBuffer)>;
+    using loadResult = std::optional<std::future<std::pair<std::string, std::uint64_t>>>;
+
+    //bulk load the rows produced by the generator into the table through 'load data local infile', the rows being
+    //produced incrementally while mysql reading and streamed from memory without touching disk,
+    //the future returning the error message(empty on success) and the loaded row count,
+    //strSet being the assignments of the 'set' clause if NOT empty, such as converting the variables of strColumns,
+    //NOTE: the load running on a standalone conn allowing local infile, the pooled conns NOT allowing it
+    loadResult loadData(const std::string & strTable, const std::string & strColumns, lineGenerator generator, const LoadFormat enFormat = _EN_LOAD_TSV_,
+                        const std::string & strSet = std::string());
+
+    //bulk load a vector of typed rows formatted by CSQLFormat::appendTSV, such as the columns
+    //CSQLFormat::g_strCourseLoadColumns with the set clause CSQLFormat::g_strCourseLoadSet for StCourse,
+    //NOTE: vecRows being referred rather than copied, it must be alive until the returned future being ready
+    template<class T>
+    loadResult loadData(const std::string & strTable, const std::string & strColumns, const std::vector<T> & vecRows,
+                        const std::string & strSet = std::string()){
+        auto generator = [&vecRows, nIndex = size_t(0)](std::string & strBuffer) mutable ->bool{
+            if(nIndex >= vecRows.size())
+                return false;
+
+            CSQLFormat::appendTSV(strBuffer, vecRows[nIndex++]);
+            return true;
+        };
+
+        return this->loadData(strTable, strColumns, generator, _EN_LOAD_TSV_, strSet);
+    }
+
 private:
     template<typename Func, typename... Args>
     auto submit(Func && func, Args&&... args)->std::future<decltype(func(args...))>;
 
+    std::pair<std::string, std::uint64_t> executeInTransaction(const std::vector<std::string> & vecSQL);
+
+    using steadyClock = std::chrono::steady_clock;
+    optResult submitQuery(const std::string & strSQL, const std::optional<steadyClock::time_point> deadline);
+
+    static std::pair<std::string, query_result> runQuery(MYSQL * pMySQL, const std::string & strSQL);
+
+    //the watchdog killing the running queries whose deadline passed
+    void watchLoop();
+    void killQueries(const std::vector<std::pair<std::uint64_t, unsigned long>> & vecExpired);
+
+private:
+    //state of a 'load data local infile' being streamed from memory
+    typedef struct ST_infileReader{
+        lineGenerator generator;
+        std::string strBuffer;//rows produced but not read by mysql yet
+        size_t nOffset = 0;
+        bool bEnd = false;
+        std::string strErrMsg;
+    }StInfileReader;
+
+    //callbacks of mysql_set_local_infile_handler, reading the rows from the generator rather than a local file
+    static int infileInit(void ** ppReader, const char * pFileName, void * pUserData);
+    static int infileRead(void * pReader, char * pBuf, unsigned int nBufLen);
+    static void infileEnd(void * pReader);
+    static int infileError(void * pReader, char * pErrMsg, unsigned int nErrMsgLen);
+
+
+private:
+    //running queries having a deadline, key->watch token, the members being declared before the pools
+    //for they being used by the worker threads until the thread pool destructed
+    typedef struct ST_watchItem{
+        steadyClock::time_point deadline;
+        unsigned long nMySQLThreadId = 0;//id of the conn on the server side, being used by 'KILL QUERY'
+        bool bKilled = false;
+        bool bKilling = false;//'KILL QUERY' being sent, the item NOT being erased until it done
+    }StWatchItem;
+
+    std::mutex m_mtxWatch;
+    std::condition_variable m_cvWatch;
+    std::condition_variable m_cvKilled;//the killing of the items done
+    std::map<std::uint64_t, StWatchItem> m_mpWatching;
+    std::uint64_t m_nWatchToken = 0;
+    bool m_bStopWatch = false;
+
+    std::atomic<size_t> m_nInFlight{0};
+    std::atomic<size_t> m_nMaxInFlight{0};
 
 private:
     UT::CThreadPool m_threadPool;
     CDBConnectPool m_connPool;
+    std::thread m_watchThread;
+    std::unique_ptr<CDBAsyncEngine> m_pAsyncEngine;
 };
 
 #define DBOPT CDBManager::getInst()
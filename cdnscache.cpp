@@ -0,0 +1,220 @@
+#include "cdnscache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+static constexpr long g_nStaleRetryMs = 5000;//the refresh failed, being retried after this at the earliest
+
+CDnsCache::CDnsCache(const long nTTLMs/*=60000*/, const long nHappyEyeballsMs/*=200*/)
+    : m_nTTLMs(std::max<long>(nTTLMs, 0)), m_nHappyEyeballsMs(std::max<long>(nHappyEyeballsMs, 0))
+{
+
+}
+
+std::optional<std::vector<std::string>> CDnsCache::resolve(const std::string & strHost)
+{
+    if(strHost.empty())
+        return std::nullopt;
+
+    std::shared_future<std::vector<std::string>> future;
+    std::promise<std::vector<std::string>> promise;
+    bool bOwner = false;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        auto iter = this->m_mpEntries.find(strHost);
+        if(this->m_mpEntries.end() != iter && (iter->second.bPinned || std::chrono::steady_clock::now() < iter->second.expiresAt)){
+            this->m_stStats.nHits++;
+            return iter->second.vecAddrs;
+        }
+
+        //the lookup of the host in progress being waited for rather than being started again
+        auto iterFlight = this->m_mpInFlight.find(strHost);
+        if(this->m_mpInFlight.end() != iterFlight){
+            future = iterFlight->second;
+        }else{
+            future = promise.get_future().share();
+            this->m_mpInFlight.emplace(strHost, future);
+            this->m_stStats.nMisses++;
+            bOwner = true;
+        }
+    }
+
+    if(bOwner)
+        promise.set_value(CDnsCache::lookup(strHost));
+
+    const std::vector<std::string> & vecAddrs = future.get();
+
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    const auto now = std::chrono::steady_clock::now();
+    if(bOwner){
+        this->m_mpInFlight.erase(strHost);
+
+        if(!vecAddrs.empty()){
+            StDnsEntry & stEntry = this->m_mpEntries[strHost];
+            if(!stEntry.bPinned){
+                stEntry.vecAddrs = vecAddrs;
+                stEntry.expiresAt = now + std::chrono::milliseconds(this->m_nTTLMs);
+                stEntry.mpResolve.clear();
+            }
+        }else{
+            this->m_stStats.nFailures++;
+        }
+    }
+
+    if(!vecAddrs.empty())
+        return vecAddrs;
+
+    //the expired addresses being served rather than failing the host known
+    auto iter = this->m_mpEntries.find(strHost);
+    if(this->m_mpEntries.end() == iter)
+        return std::nullopt;
+
+    if(bOwner)
+        iter->second.expiresAt = now + std::chrono::milliseconds(std::min(this->m_nTTLMs, g_nStaleRetryMs));
+
+    this->m_stStats.nStaleServed++;
+    return iter->second.vecAddrs;
+}
+
+size_t CDnsCache::preResolve(const std::vector<std::string> & vecHosts)
+{
+    std::vector<std::future<bool>> vecFutures;
+    vecFutures.reserve(vecHosts.size());
+    for(const auto & strHost : vecHosts){
+        vecFutures.emplace_back(std::async(std::launch::async, [this, &strHost](){
+            return CDnsCache::isIpAddress(strHost) || this->resolve(strHost).has_value();
+        }));
+    }
+
+    size_t nResolved = 0;
+    for(auto & item : vecFutures)
+        nResolved += item.get() ? 1 : 0;
+
+    return nResolved;
+}
+
+void CDnsCache::pin(const std::string & strHost, const std::vector<std::string> & vecAddrs)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StDnsEntry & stEntry = this->m_mpEntries[strHost];
+    stEntry.vecAddrs = vecAddrs;
+    stEntry.bPinned = true;
+    stEntry.mpResolve.clear();
+}
+
+void CDnsCache::remove(const std::string & strHost)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    this->m_mpEntries.erase(strHost);
+}
+
+void CDnsCache::clear()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    this->m_mpEntries.clear();
+}
+
+bool CDnsCache::apply(CURL * pCurl, const std::string & strHost, const std::uint16_t nPort, std::shared_ptr<curl_slist> & pResolve)
+{
+    if(nullptr == pCurl)
+        return false;
+
+    curl_easy_setopt(pCurl, CURLOPT_HAPPY_EYEBALLS_TIMEOUT_MS, this->m_nHappyEyeballsMs.load());
+    if(CDnsCache::isIpAddress(strHost) || !this->resolve(strHost).has_value())
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        auto iter = this->m_mpEntries.find(strHost);
+        if(this->m_mpEntries.end() == iter || iter->second.vecAddrs.empty())
+            return false;
+
+        //being built once each port until the addresses refreshed, the lists in use being kept alive by their holders
+        auto & pList = iter->second.mpResolve[nPort];
+        if(!pList){
+            //"+host:port:addr,[addr6]", the entry timing out of the DNS cache of libcurl as the resolved ones, NOT staying forever
+#if LIBCURL_VERSION_NUM >= 0x074B00
+            std::string strEntry = std::string("+") + strHost + std::string(":") + std::to_string(nPort) + std::string(":");
+#else
+            std::string strEntry = strHost + std::string(":") + std::to_string(nPort) + std::string(":");
+#endif
+            for(size_t ii = 0; ii < iter->second.vecAddrs.size(); ii++){
+                const std::string & strAddr = iter->second.vecAddrs[ii];
+                strEntry += (0 == ii ? std::string("") : std::string(","));
+                strEntry += (std::string::npos == strAddr.find(':')) ? strAddr : std::string("[") + strAddr + std::string("]");
+            }
+
+            pList.reset(curl_slist_append(nullptr, strEntry.c_str()), &curl_slist_free_all);
+        }
+
+        pResolve = pList;
+    }
+
+    return CURLE_OK == curl_easy_setopt(pCurl, CURLOPT_RESOLVE, pResolve.get());
+}
+
+CDnsCache & CDnsCache::setHappyEyeballsTimeout(const long nHappyEyeballsMs)
+{
+    this->m_nHappyEyeballsMs.store(std::max<long>(nHappyEyeballsMs, 0));
+    return *this;
+}
+
+StDnsCacheStats CDnsCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StDnsCacheStats stStats = this->m_stStats;
+    stStats.nEntries = this->m_mpEntries.size();
+    return stStats;
+}
+
+bool CDnsCache::isIpAddress(const std::string & strHost)
+{
+    unsigned char arrAddr[sizeof(struct in6_addr)] = {0};
+    std::string strAddr = strHost;
+    if(strAddr.size() > 2 && '[' == strAddr.front() && ']' == strAddr.back())
+        strAddr = strAddr.substr(1, strAddr.size() - 2);
+
+    return 1 == inet_pton(AF_INET, strAddr.c_str(), arrAddr) || 1 == inet_pton(AF_INET6, strAddr.c_str(), arrAddr);
+}
+
+std::vector<std::string> CDnsCache::lookup(const std::string & strHost)
+{
+    struct addrinfo stHints;
+    memset(&stHints, 0, sizeof(stHints));
+    stHints.ai_family = AF_UNSPEC;
+    stHints.ai_socktype = SOCK_STREAM;
+    stHints.ai_flags = AI_ADDRCONFIG;//the family NOT configured on the host being skipped
+
+    struct addrinfo * pResult = nullptr;
+    if(0 != getaddrinfo(strHost.c_str(), nullptr, &stHints, &pResult))
+        return {};
+
+    std::vector<std::string> vecV6, vecV4;
+    char szAddr[INET6_ADDRSTRLEN] = {0};
+    for(struct addrinfo * pInfo = pResult; nullptr != pInfo; pInfo = pInfo->ai_next){
+        if(AF_INET6 == pInfo->ai_family){
+            const auto * pAddr = reinterpret_cast<const struct sockaddr_in6 *>(pInfo->ai_addr);
+            if(inet_ntop(AF_INET6, &pAddr->sin6_addr, szAddr, sizeof(szAddr)))
+                vecV6.emplace_back(szAddr);
+        }else if(AF_INET == pInfo->ai_family){
+            const auto * pAddr = reinterpret_cast<const struct sockaddr_in *>(pInfo->ai_addr);
+            if(inet_ntop(AF_INET, &pAddr->sin_addr, szAddr, sizeof(szAddr)))
+                vecV4.emplace_back(szAddr);
+        }
+    }
+    freeaddrinfo(pResult);
+
+    //the duplicates of the socket types NOT being requested being removed as well, the order being kept
+    std::vector<std::string> vecAddrs;
+    for(auto * pVec : {&vecV6, &vecV4}){
+        for(auto & strAddr : *pVec){
+            if(vecAddrs.end() == std::find(vecAddrs.begin(), vecAddrs.end(), strAddr))
+                vecAddrs.emplace_back(std::move(strAddr));
+        }
+    }
+
+    return vecAddrs;
+}
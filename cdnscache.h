@@ -0,0 +1,95 @@
+#ifndef CDNSCACHE_H
+#define CDNSCACHE_H
+
+/*
+ * CDnsCache resolves the hosts by getaddrinfo ahead of libcurl and keeps the addresses for the TTL, the addresses
+ * being injected into the handles by CURLOPT_RESOLVE, so the requests to the same host NOT hitting the resolver of
+ * the system each time, and the hosts pre-resolved at startup making the first requests NOT waiting for the lookup.
+ *
+ * getaddrinfo NOT telling the TTL of the records, the TTL being of the cache. The concurrent lookups of the same host
+ * being merged into one, and the addresses expired being served for a while when the refresh failing, such an outage
+ * of the resolver NOT failing the hosts known. The addresses pinned never expiring nor being resolved.
+ *
+ * Both IPv4 and IPv6 addresses being injected, libcurl racing the families by happy eyeballs, the second family being
+ * tried after the timeout set by CURLOPT_HAPPY_EYEBALLS_TIMEOUT_MS when the first NOT connected yet.
+ *
+ * Thread-safe, such a cache being shared by the clients of all the threads, by their setDnsCache.
+ */
+
+#include "curl/curl.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+typedef struct ST_dnsCacheStats{
+    std::uint64_t nHits = 0;
+    std::uint64_t nMisses = 0;          //being resolved, the lookups merged being counted once
+    std::uint64_t nFailures = 0;
+    std::uint64_t nStaleServed = 0;     //the refresh failed, the expired addresses being served
+    size_t nEntries = 0;
+}StDnsCacheStats;
+
+class CDnsCache
+{
+public:
+    explicit CDnsCache(const long nTTLMs = 60000, const long nHappyEyeballsMs = 200);
+    ~CDnsCache() = default;
+
+    //copy constructor and assignment operator prohibited
+    CDnsCache(const CDnsCache & ) = delete;
+    CDnsCache(const CDnsCache && ) = delete;
+    CDnsCache & operator=(const CDnsCache &) = delete;
+    CDnsCache & operator=(const CDnsCache &&) = delete;
+
+    //the addresses of the host, the IPv6 ones first, std::nullopt when NOT resolved
+    std::optional<std::vector<std::string>> resolve(const std::string & strHost);
+
+    //resolve the hosts concurrently, return the count resolved
+    size_t preResolve(const std::vector<std::string> & vecHosts);
+
+    //the host always being connected to the addresses, until being removed
+    void pin(const std::string & strHost, const std::vector<std::string> & vecAddrs);
+    void remove(const std::string & strHost);
+    void clear();
+
+    //inject the addresses of the host into the handle, and set the timeout of happy eyeballs, pResolve holding the list
+    //of CURLOPT_RESOLVE, which must outlive the transfer. Return false when the host being an IP or NOT resolved, the
+    //handle being left to libcurl then
+    bool apply(CURL * pCurl, const std::string & strHost, const std::uint16_t nPort, std::shared_ptr<curl_slist> & pResolve);
+
+    CDnsCache & setHappyEyeballsTimeout(const long nHappyEyeballsMs);
+
+    StDnsCacheStats getStats() const;
+
+    static bool isIpAddress(const std::string & strHost);
+
+private:
+    typedef struct ST_dnsEntry{
+        std::vector<std::string> vecAddrs;
+        std::chrono::steady_clock::time_point expiresAt;
+        bool bPinned = false;
+        std::unordered_map<std::uint16_t, std::shared_ptr<curl_slist>> mpResolve;//the lists of CURLOPT_RESOLVE by the port
+    }StDnsEntry;
+
+    //getaddrinfo without the lock, an empty vector on failure
+    static std::vector<std::string> lookup(const std::string & strHost);
+
+private:
+    const long m_nTTLMs;
+    std::atomic<long> m_nHappyEyeballsMs;
+
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::string, StDnsEntry> m_mpEntries;
+    std::unordered_map<std::string, std::shared_future<std::vector<std::string>>> m_mpInFlight;//the lookups merged
+    StDnsCacheStats m_stStats;
+};
+
+#endif // CDNSCACHE_H
@@ -0,0 +1,355 @@
+#include "cftpasyncengine.h"
+
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+static constexpr long g_nMinNudgeMs = 1;//the transfers started NOT watched being driven after this first
+static constexpr long g_nMaxNudgeMs = 64;//the interval of driving them doubled up to this
+
+CFTPAsyncEngine::CFTPAsyncEngine(const size_t nMaxInFlight/*=256*/, const size_t nMaxPerServer/*=4*/)
+    : m_nMaxInFlight(std::max<size_t>(nMaxInFlight, 1)), m_nMaxPerServer(std::max<size_t>(nMaxPerServer, 1))
+{
+    this->m_strErrMsg = this->m_loop.getErrMsg();
+}
+
+CFTPAsyncEngine::~CFTPAsyncEngine()
+{
+    //the transfers in flight being aborted and completed on the loop thread before it exiting
+    this->m_loop.stop();
+
+    for(auto & pTransfer : this->m_deqPending)
+        pTransfer->promise.set_value(std::make_pair(false, std::string("such the async FTP engine had been stopped")));
+    this->m_deqPending.clear();
+
+    for(auto pCurl : this->m_vecIdleHandles)
+        curl_easy_cleanup(pCurl);
+}
+
+std::future<CFTPAsyncEngine::result> CFTPAsyncEngine::upFile(const StHostInfo & stHost, const std::string & strLocalFile, const std::string & strRemotePath)
+{
+    auto pTransfer = std::make_shared<StFTPTransfer>();
+    pTransfer->bUpload = true;
+    pTransfer->stHost = stHost;
+    pTransfer->strLocalFile = strLocalFile;
+    pTransfer->strRemoteFile = strRemotePath;
+
+    return this->enqueue(std::move(pTransfer));
+}
+
+std::future<CFTPAsyncEngine::result> CFTPAsyncEngine::downFile(const StHostInfo & stHost, const std::string & strLocalFile, const std::string & strRemoteFile)
+{
+    auto pTransfer = std::make_shared<StFTPTransfer>();
+    pTransfer->bUpload = false;
+    pTransfer->stHost = stHost;
+    pTransfer->strLocalFile = strLocalFile;
+    pTransfer->strRemoteFile = strRemoteFile;
+
+    return this->enqueue(std::move(pTransfer));
+}
+
+CFTPAsyncEngine & CFTPAsyncEngine::setMaxInFlight(const size_t nMaxInFlight)
+{
+    this->m_nMaxInFlight.store(std::max<size_t>(nMaxInFlight, 1));
+    return *this;
+}
+
+CFTPAsyncEngine & CFTPAsyncEngine::setMaxPerServer(const size_t nMaxPerServer)
+{
+    this->m_nMaxPerServer.store(std::max<size_t>(nMaxPerServer, 1));
+    return *this;
+}
+
+StFTPEngineStats CFTPAsyncEngine::getStats() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtxStats);
+    StFTPEngineStats stStats = this->m_stStats;
+    if(this->m_busySince.has_value())
+        stStats.fBusySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - *this->m_busySince).count();
+
+    if(stStats.fBusySeconds > 0){
+        stStats.fBytesPerSec = static_cast<double>(stStats.nBytesUp + stStats.nBytesDown) / stStats.fBusySeconds;
+        stStats.fFilesPerSec = static_cast<double>(stStats.nFilesUp + stStats.nFilesDown) / stStats.fBusySeconds;
+    }
+
+    return stStats;
+}
+
+const std::string & CFTPAsyncEngine::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+std::string CFTPAsyncEngine::serverOf(const StHostInfo & stHost)
+{
+    const std::string && strProtocol = (stHost.enMode == _EN_FTPS_) ? std::string("ftps://") : std::string("ftp://");
+    return strProtocol + stHost.strIp + std::string(":") + std::to_string(stHost.nPort);
+}
+
+std::future<CFTPAsyncEngine::result> CFTPAsyncEngine::enqueue(std::shared_ptr<StFTPTransfer> pTransfer)
+{
+    //the connections being reused by the transfers of the same user only
+    pTransfer->strServer = CFTPAsyncEngine::serverOf(pTransfer->stHost) + std::string("|") + pTransfer->stHost.strUserName;
+    std::future<result> future = pTransfer->promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxStats);
+        this->m_stStats.nSubmitted++;
+        this->m_stStats.nPending++;
+    }
+
+    const bool bPosted = this->m_loop.post([this, pTransfer](){
+        this->m_deqPending.emplace_back(pTransfer);
+        this->dispatch();
+    });
+
+    if(!bPosted){
+        {
+            std::lock_guard<std::mutex> lock_guard(this->m_mtxStats);
+            this->m_stStats.nPending--;
+            this->m_stStats.nCompleted++;
+            this->m_stStats.nFailed++;
+        }
+        pTransfer->promise.set_value(std::make_pair(false, std::string("such the async FTP engine being unavailable:") + this->m_strErrMsg));
+    }
+
+    return future;
+}
+
+//start the pending transfers within the caps, the transfers of the servers reaching their caps being skipped rather than
+//blocking the transfers of the other servers
+void CFTPAsyncEngine::dispatch()
+{
+    const size_t nMaxInFlight = this->m_nMaxInFlight.load();
+    const size_t nMaxPerServer = this->m_nMaxPerServer.load();
+
+    for(auto iter = this->m_deqPending.begin(); iter != this->m_deqPending.end() && this->m_nInFlight < nMaxInFlight;){
+        if(this->m_mpServerInFlight[(*iter)->strServer] >= nMaxPerServer){
+            ++iter;
+            continue;
+        }
+
+        std::shared_ptr<StFTPTransfer> pTransfer = std::move(*iter);
+        iter = this->m_deqPending.erase(iter);
+        {
+            std::lock_guard<std::mutex> lock_guard(this->m_mtxStats);
+            this->m_stStats.nPending--;
+        }
+
+        this->start(pTransfer);
+    }
+}
+
+bool CFTPAsyncEngine::start(std::shared_ptr<StFTPTransfer> & pTransfer)
+{
+    CURL * pCurl = this->acquireHandle();
+    if(nullptr == pCurl){
+        this->finish(nullptr, CURLE_FAILED_INIT, pTransfer, std::string("Failed to initialized curl"));
+        return false;
+    }
+
+    const std::optional<std::string> && strErrMsg = this->prepare(pCurl, *pTransfer);
+    if(strErrMsg.has_value()){
+        this->releaseHandle(pCurl);
+        this->finish(nullptr, CURLE_FAILED_INIT, pTransfer, *strErrMsg);
+        return false;
+    }
+
+    this->m_nInFlight++;
+    this->m_mpServerInFlight[pTransfer->strServer]++;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxStats);
+        this->m_stStats.nInFlight = this->m_nInFlight;
+        if(!this->m_busySince.has_value())
+            this->m_busySince = std::chrono::steady_clock::now();
+    }
+
+    const bool bAdded = this->m_loop.add(pCurl, [this, pTransfer](CURL * pDoneCurl, const CURLcode enCode) mutable {
+        this->complete(pDoneCurl, enCode, pTransfer);
+    });
+
+    //the loop being stopped, NOT dispatching again, which being called by dispatch
+    if(!bAdded){
+        this->finish(pCurl, CURLE_FAILED_INIT, pTransfer, std::string("such the async FTP engine had been stopped"));
+        return false;
+    }
+
+    //checked after the first run of the transfer, which being started by the timer of libcurl
+    this->m_setStarting.insert(pCurl);
+    this->m_nNudgeMs = g_nMinNudgeMs;
+    this->scheduleNudge(g_nMinNudgeMs);
+
+    return true;
+}
+
+//open the local file and set the options as the async transfers of CFTPSClient
+std::optional<std::string> CFTPAsyncEngine::prepare(CURL * pCurl, StFTPTransfer & stTransfer)
+{
+    fs::path localPath(stTransfer.strLocalFile);
+    fs::path remotePath(stTransfer.strRemoteFile);
+
+    if(stTransfer.bUpload){
+        if(remotePath.empty() || localPath.empty() || !localPath.has_filename())
+            return std::string("Invalid parameters input");
+
+        stTransfer.fp.reset(fopen(stTransfer.strLocalFile.c_str(), "rb"));
+        if(!stTransfer.fp)
+            return std::string("Failed to open the given local file");
+
+        //when the remote file passed as a directory, set the upload filename as the local filename
+        if(!remotePath.has_filename())
+            remotePath /= localPath.filename();
+
+        std::error_code ec;
+        const std::uintmax_t nFileSize = fs::file_size(localPath, ec);
+        if(ec)
+            return std::string("Failed to open the given local file:") + ec.message();
+
+        curl_easy_setopt(pCurl, CURLOPT_READFUNCTION, CFTPSClient::upReadCallback);
+        curl_easy_setopt(pCurl, CURLOPT_READDATA, stTransfer.fp.get());
+        //the CWD being retried when the MKD failed, such the directory being created by the other transfer concurrently
+        curl_easy_setopt(pCurl, CURLOPT_FTP_CREATE_MISSING_DIRS, CURLFTP_CREATE_DIR_RETRY);
+        curl_easy_setopt(pCurl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(pCurl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(nFileSize));
+    }else{
+        if(remotePath.empty() || localPath.empty() || !remotePath.has_filename())
+            return std::string("Invalid parameters input");
+
+        //create the local file path if not existing
+        auto && pairRet = CFTPSClient::createDirectory(stTransfer.strLocalFile);
+        if(!pairRet.has_value() || !pairRet->first)
+            return std::string("Failed to create the local directory:") + (pairRet.has_value() ? pairRet->second : std::string());
+
+        //when the local file passed as a directory, set the download filename as the remote filename
+        if(!localPath.has_filename())
+            localPath /= remotePath.filename();
+
+        stTransfer.fp.reset(fopen(localPath.string().c_str(), "wb+"));
+        if(!stTransfer.fp)
+            return std::string("Failed to open the given local file");
+
+        curl_easy_setopt(pCurl, CURLOPT_WRITEFUNCTION, CFTPSClient::downWriteCallback);
+        curl_easy_setopt(pCurl, CURLOPT_WRITEDATA, stTransfer.fp.get());
+    }
+
+    const std::string && strURL = CFTPAsyncEngine::serverOf(stTransfer.stHost) + remotePath.string();
+    const std::string && strUserPwd = stTransfer.stHost.strUserName + std::string(":") + stTransfer.stHost.strPassword;
+    curl_easy_setopt(pCurl, CURLOPT_URL, strURL.c_str());
+    curl_easy_setopt(pCurl, CURLOPT_USERPWD, strUserPwd.c_str());
+    curl_easy_setopt(pCurl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(pCurl, CURLOPT_CONNECTTIMEOUT_MS, 3000L);//connect timeout for 3 seconds
+
+    return std::nullopt;
+}
+
+void CFTPAsyncEngine::complete(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StFTPTransfer> & pTransfer)
+{
+    this->finish(pCurl, enCode, pTransfer, CURLE_OK == enCode ? std::string() : std::string(curl_easy_strerror(enCode)));
+    this->dispatch();//the caps being freed
+}
+
+void CFTPAsyncEngine::finish(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StFTPTransfer> & pTransfer, const std::string & strErrMsg)
+{
+    curl_off_t nBytes = 0;
+    long nConnects = 0;
+    if(pCurl){
+        curl_easy_getinfo(pCurl, pTransfer->bUpload ? CURLINFO_SIZE_UPLOAD_T : CURLINFO_SIZE_DOWNLOAD_T, &nBytes);
+        curl_easy_getinfo(pCurl, CURLINFO_NUM_CONNECTS, &nConnects);
+        this->releaseHandle(pCurl);
+        this->m_setStarting.erase(pCurl);
+
+        this->m_nInFlight--;
+        auto iter = this->m_mpServerInFlight.find(pTransfer->strServer);
+        if(this->m_mpServerInFlight.end() != iter && 0 == --iter->second)
+            this->m_mpServerInFlight.erase(iter);
+    }
+
+    //the file being closed before the result delivered, such the file downloaded being complete on the disk
+    pTransfer->fp.reset();
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtxStats);
+        this->m_stStats.nCompleted++;
+        this->m_stStats.nFailed += (CURLE_OK == enCode) ? 0 : 1;
+        this->m_stStats.nNewConnections += static_cast<std::uint64_t>(std::max<long>(nConnects, 0));
+        (pTransfer->bUpload ? this->m_stStats.nBytesUp : this->m_stStats.nBytesDown) += static_cast<std::uint64_t>(std::max<curl_off_t>(nBytes, 0));
+        if(CURLE_OK == enCode)
+            (pTransfer->bUpload ? this->m_stStats.nFilesUp : this->m_stStats.nFilesDown)++;
+
+        this->m_stStats.nInFlight = this->m_nInFlight;
+        if(0 == this->m_nInFlight && this->m_busySince.has_value()){
+            this->m_stStats.fBusySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - *this->m_busySince).count();
+            this->m_busySince.reset();
+        }
+    }
+
+    pTransfer->promise.set_value(std::make_pair(CURLE_OK == enCode, strErrMsg));
+}
+
+//the reply of EPSV being read at once on the control connection reused, libcurl preparing the data connection without
+//connecting it, neither telling a socket nor setting a timer but the connect timeout, and then connecting it without
+//telling the socket until the timer of happy eyeballs. Such the transfers being found by NOT being watched after their
+//first run, and being driven until watched, at the intervals doubled, rather than driving all the transfers periodically
+void CFTPAsyncEngine::nudge()
+{
+    if(this->m_nudgeAt.has_value() && *this->m_nudgeAt <= std::chrono::steady_clock::now())
+        this->m_nudgeAt.reset();
+
+    if(!this->pruneStarting())
+        return ;
+
+    this->m_loop.drive();
+    if(!this->pruneStarting())
+        return ;
+
+    this->m_nNudgeMs = std::min(this->m_nNudgeMs * 2, g_nMaxNudgeMs);
+    this->scheduleNudge(this->m_nNudgeMs);
+}
+
+//at most a timer pending, unless the new one being earlier
+void CFTPAsyncEngine::scheduleNudge(const long nWaitMs)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto deadline = now + std::chrono::milliseconds(nWaitMs);
+    if(this->m_nudgeAt.has_value() && *this->m_nudgeAt > now && *this->m_nudgeAt <= deadline)
+        return ;
+
+    this->m_nudgeAt = deadline;
+    this->m_loop.postAfter(std::chrono::milliseconds(nWaitMs), [this](){
+        this->nudge();
+    });
+}
+
+//drop the transfers started being watched, return true when any left NOT watched
+bool CFTPAsyncEngine::pruneStarting()
+{
+    for(auto iter = this->m_setStarting.begin(); iter != this->m_setStarting.end();){
+        if(this->m_loop.isWatched(*iter))
+            iter = this->m_setStarting.erase(iter);
+        else
+            ++iter;
+    }
+
+    return !this->m_setStarting.empty();
+}
+
+//the handles being reused, the options being reset while the connections kept by the multi handle
+CURL * CFTPAsyncEngine::acquireHandle()
+{
+    if(this->m_vecIdleHandles.empty())
+        return curl_easy_init();
+
+    CURL * pCurl = this->m_vecIdleHandles.back();
+    this->m_vecIdleHandles.pop_back();
+    return pCurl;
+}
+
+void CFTPAsyncEngine::releaseHandle(CURL * pCurl)
+{
+    curl_easy_reset(pCurl);
+    this->m_vecIdleHandles.emplace_back(pCurl);
+}
@@ -0,0 +1,132 @@
+#ifndef CFTPASYNCENGINE_H
+#define CFTPASYNCENGINE_H
+
+/*
+ * CFTPAsyncEngine runs the FTP uploads and downloads on a CCurlMultiLoop, thousands of transfers being in flight on
+ * a single thread rather than a thread or a worker each. The control connections logged in being kept by the multi
+ * handle after the transfers, and being reused by the next transfers to the same server and user, without logging in
+ * again, the failed transfers closing their connections.
+ *
+ * At most nMaxPerServer transfers to a server running at once, each holding a control and a data connection, the
+ * transfers of the servers reaching their caps being kept in the queue rather than blocking the other servers, and
+ * being started as the earlier ones completing. The local files being opened when the transfers started, so the
+ * transfers queued NOT holding any descriptor.
+ *
+ * The bytes and the files transferred being counted, the throughput being of the time with the transfers in flight,
+ * the time idle NOT lowering it. The results being delivered by futures, being ready on the loop thread.
+ */
+
+#include "ccurlmultiloop.h"
+#include "cftpsclient.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+typedef struct ST_ftpEngineStats{
+    std::uint64_t nSubmitted = 0;
+    std::uint64_t nCompleted = 0;
+    std::uint64_t nFailed = 0;
+    std::uint64_t nFilesUp = 0;
+    std::uint64_t nFilesDown = 0;
+    std::uint64_t nBytesUp = 0;
+    std::uint64_t nBytesDown = 0;
+    std::uint64_t nNewConnections = 0;  //the connections opened, the control and the data ones
+    size_t nPending = 0;
+    size_t nInFlight = 0;
+    double fBusySeconds = 0;            //the time with the transfers in flight
+    double fBytesPerSec = 0;            //the bytes up and down over fBusySeconds
+    double fFilesPerSec = 0;
+}StFTPEngineStats;
+
+class CFTPAsyncEngine
+{
+public:
+    using result = std::optional<std::pair<bool, std::string>>;//the same as the async transfers of CFTPSClient
+
+    explicit CFTPAsyncEngine(const size_t nMaxInFlight = 256, const size_t nMaxPerServer = 4);
+    ~CFTPAsyncEngine();
+
+    //copy constructor and assignment operator prohibited
+    CFTPAsyncEngine(const CFTPAsyncEngine & ) = delete;
+    CFTPAsyncEngine(const CFTPAsyncEngine && ) = delete;
+    CFTPAsyncEngine & operator=(const CFTPAsyncEngine &) = delete;
+    CFTPAsyncEngine & operator=(const CFTPAsyncEngine &&) = delete;
+
+    //upload the local file to the remote path of the host, the remote path ending with '/' being a directory, the missing
+    //directories being created
+    std::future<result> upFile(const StHostInfo & stHost, const std::string & strLocalFile, const std::string & strRemotePath);
+
+    //download the remote file of the host to the local path, the local path ending with '/' being a directory, the missing
+    //local directories being created
+    std::future<result> downFile(const StHostInfo & stHost, const std::string & strLocalFile, const std::string & strRemoteFile);
+
+    //the caps being applied to the transfers started later
+    CFTPAsyncEngine & setMaxInFlight(const size_t nMaxInFlight);
+    CFTPAsyncEngine & setMaxPerServer(const size_t nMaxPerServer);
+
+    StFTPEngineStats getStats() const;
+
+    const std::string & getErrMsg() const;
+
+    //"ftp://ip:port" or "ftps://ip:port" of the host
+    static std::string serverOf(const StHostInfo & stHost);
+
+private:
+    typedef struct ST_ftpTransfer{
+        bool bUpload = true;
+        StHostInfo stHost;
+        std::string strServer;//the key of the per server cap, the server with the user
+        std::string strLocalFile;
+        std::string strRemoteFile;
+        std::unique_ptr<FILE, decltype(&fclose)> fp{nullptr, &fclose};
+        std::promise<result> promise;
+    }StFTPTransfer;
+
+    std::future<result> enqueue(std::shared_ptr<StFTPTransfer> pTransfer);
+
+    //all on the loop thread
+    void dispatch();
+    bool start(std::shared_ptr<StFTPTransfer> & pTransfer);
+    std::optional<std::string> prepare(CURL * pCurl, StFTPTransfer & stTransfer);//the error message on failure
+    void complete(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StFTPTransfer> & pTransfer);
+    void finish(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StFTPTransfer> & pTransfer, const std::string & strErrMsg);
+    void nudge();
+    void scheduleNudge(const long nWaitMs);
+    bool pruneStarting();
+    CURL * acquireHandle();
+    void releaseHandle(CURL * pCurl);
+
+private:
+    std::string m_strErrMsg;
+
+    //touched by the loop thread only
+    std::deque<std::shared_ptr<StFTPTransfer>> m_deqPending;
+    std::unordered_map<std::string, size_t> m_mpServerInFlight;
+    size_t m_nInFlight = 0;
+    std::vector<CURL *> m_vecIdleHandles;
+    std::unordered_set<CURL *> m_setStarting;//the transfers started NOT watched yet
+    long m_nNudgeMs = 0;
+    std::optional<std::chrono::steady_clock::time_point> m_nudgeAt;
+
+    std::atomic<size_t> m_nMaxInFlight;
+    std::atomic<size_t> m_nMaxPerServer;
+
+    mutable std::mutex m_mtxStats;
+    StFTPEngineStats m_stStats;
+    std::optional<std::chrono::steady_clock::time_point> m_busySince;//the transfers being in flight since
+
+    CCurlMultiLoop m_loop;//the last member, the loop thread being started after all the others initialized
+};
+
+#endif // CFTPASYNCENGINE_H
@@ -0,0 +1,318 @@
+#include "cftpscheduler.h"
+#include "cresourceinit.h"
+
+#include <algorithm>
+#include <iostream>
+
+static constexpr long g_nMinNudgeMs = 1;//the handle waiting NO socket being driven again after this first
+static constexpr long g_nMaxNudgeMs = 64;//the interval doubled up to this
+static constexpr long g_nMaxWaitMs = 1000;//the same as curl_easy_perform without any timeout of libcurl
+static thread_local CURLM * t_pMulti = nullptr;//the multi handle of the job running on the worker
+
+CFTPScheduler::CFTPScheduler(const size_t nWorkers/*=8*/, const size_t nMaxPerServer/*=4*/, const size_t nMaxIdle/*=32*/)
+    : m_nMaxPerServer(std::max<size_t>(nMaxPerServer, 1)), m_nMaxIdle(nMaxIdle)
+{
+    CResourceInit::init();
+
+    const size_t nCount = std::max<size_t>(nWorkers, 1);
+    this->m_vecWorkers.reserve(nCount);
+    for(size_t ii = 0; ii < nCount; ii++)
+        this->m_vecWorkers.emplace_back(&CFTPScheduler::workLoop, this);
+}
+
+CFTPScheduler::~CFTPScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_bStop = true;
+    }
+    this->m_cv.notify_all();
+
+    for(auto & worker : this->m_vecWorkers){
+        if(worker.joinable())
+            worker.join();
+    }
+
+    //the jobs left being told the scheduler stopped by nullptr
+    for(auto & item : this->m_mpServers){
+        for(auto & stJob : item.second.deqJobs){
+            try{
+                stJob.fnJob(nullptr);
+            }catch(const std::exception & e){
+                std::cout << "exception from the FTP job:" << e.what() << std::endl;
+            }
+        }
+    }
+    this->m_mpServers.clear();
+    this->m_deqReady.clear();
+    this->m_nPending = 0;
+
+    for(auto & item : this->m_deqIdleOrder)
+        CFTPScheduler::closeHandle(item.second);
+}
+
+CFTPScheduler & CFTPScheduler::getInst()
+{
+    static CFTPScheduler schedulerInstance;
+    return schedulerInstance;
+}
+
+bool CFTPScheduler::submit(const std::string & strServer, job fnJob)
+{
+    if(!fnJob)
+        return false;
+
+    bool bReady = false;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(this->m_bStop)
+            return false;
+
+        StFTPServer & stServer = this->m_mpServers[strServer];
+        stServer.deqJobs.emplace_back(StFTPJob{strServer, std::move(fnJob)});
+        this->m_nPending++;
+        this->m_stStats.nSubmitted++;
+        bReady = this->markReady(strServer, stServer);
+    }
+
+    //NOT waking any worker for the server at its cap, or being ready already and its worker woken
+    if(bReady)
+        this->m_cv.notify_one();
+    return true;
+}
+
+CURLcode CFTPScheduler::perform(CURL * pCurl)
+{
+    CURLM * pMulti = t_pMulti;
+    if(nullptr == pMulti)
+        return curl_easy_perform(pCurl);
+
+    if(CURLM_OK != curl_multi_add_handle(pMulti, pCurl))
+        return CURLE_FAILED_INIT;
+
+    CURLcode enCode = CURLE_OK;
+    int nRunning = 1;
+    long nNudgeMs = g_nMinNudgeMs;
+    while(nRunning > 0){
+        if(CURLM_OK != curl_multi_perform(pMulti, &nRunning)){
+            enCode = CURLE_FAILED_INIT;
+            break;
+        }
+
+        if(0 == nRunning)
+            break;
+
+        long nTimeoutMs = -1;
+        curl_multi_timeout(pMulti, &nTimeoutMs);
+        if(nTimeoutMs < 0 || nTimeoutMs > g_nMaxWaitMs)
+            nTimeoutMs = g_nMaxWaitMs;
+
+        //the data connection NOT connected yet being started by curl_multi_perform only, NOT by any socket or timer
+        if(CFTPScheduler::isWaitingSocket(pMulti)){
+            nNudgeMs = g_nMinNudgeMs;
+        }else{
+            nTimeoutMs = std::min(nTimeoutMs, nNudgeMs);
+            nNudgeMs = std::min(nNudgeMs * 2, g_nMaxNudgeMs);
+        }
+
+        curl_multi_poll(pMulti, nullptr, 0, static_cast<int>(nTimeoutMs), nullptr);
+    }
+
+    int nLeft = 0;
+    while(CURLMsg * pMsg = curl_multi_info_read(pMulti, &nLeft)){
+        if(CURLMSG_DONE == pMsg->msg && pCurl == pMsg->easy_handle)
+            enCode = pMsg->data.result;
+    }
+
+    //the connection being kept by the multi handle for the next job
+    curl_multi_remove_handle(pMulti, pCurl);
+    return enCode;
+}
+
+StFTPSchedulerStats CFTPScheduler::getStats() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StFTPSchedulerStats stStats = this->m_stStats;
+    stStats.nPending = this->m_nPending;
+    stStats.nIdleHandles = this->m_deqIdleOrder.size();
+    stStats.nRunning = 0;
+    for(const auto & item : this->m_mpServers)
+        stStats.nRunning += item.second.nRunning;
+
+    return stStats;
+}
+
+void CFTPScheduler::workLoop()
+{
+    std::unique_lock<std::mutex> lock(this->m_mtx);
+    while(true){
+        StFTPJob stJob;
+        this->m_cv.wait(lock, [this, &stJob](){
+            return this->m_bStop || this->takeJob(stJob);
+        });
+
+        if(!stJob.fnJob)
+            return ;//being stopped, the jobs left being failed by the destructor
+
+        //the next ready server being taken by another worker, a worker being woken each job runnable
+        if(!this->m_deqReady.empty())
+            this->m_cv.notify_one();
+
+        StFTPHandle stHandle = this->acquireHandle(stJob.strServer);
+        lock.unlock();
+
+        bool bReusable = false;
+        t_pMulti = stHandle.pMulti;
+        try{
+            bReusable = stJob.fnJob(stHandle.pCurl);
+        }catch(const std::exception & e){
+            std::cout << "exception from the FTP job:" << e.what() << std::endl;
+        }
+        t_pMulti = nullptr;
+
+        long nConnects = 0;
+        if(stHandle.pCurl)
+            curl_easy_getinfo(stHandle.pCurl, CURLINFO_NUM_CONNECTS, &nConnects);
+
+        if(stHandle.pCurl && !bReusable){
+            CFTPScheduler::closeHandle(stHandle);
+            stHandle = StFTPHandle();
+        }
+
+        lock.lock();
+        this->m_stStats.nCompleted++;
+        this->m_stStats.nNewConnections += static_cast<std::uint64_t>(std::max<long>(nConnects, 0));
+        if(stHandle.pCurl)
+            this->releaseHandle(stJob.strServer, stHandle);
+
+        //the server below its cap now being ready again, its job being taken by this worker at once, the predicate
+        //being checked before waiting, so NOT waking any other worker
+        auto iter = this->m_mpServers.find(stJob.strServer);
+        if(this->m_mpServers.end() != iter){
+            StFTPServer & stServer = iter->second;
+            stServer.nRunning--;
+            this->markReady(iter->first, stServer);
+            if(0 == stServer.nRunning && stServer.deqJobs.empty())
+                this->m_mpServers.erase(iter);
+        }
+    }
+}
+
+bool CFTPScheduler::takeJob(StFTPJob & stJob)
+{
+    while(!this->m_deqReady.empty()){
+        auto iter = this->m_mpServers.find(this->m_deqReady.front());
+        this->m_deqReady.pop_front();
+        if(this->m_mpServers.end() == iter)
+            continue;
+
+        StFTPServer & stServer = iter->second;
+        stServer.bReady = false;
+        if(stServer.deqJobs.empty() || stServer.nRunning >= this->m_nMaxPerServer)
+            continue;
+
+        stJob = std::move(stServer.deqJobs.front());
+        stServer.deqJobs.pop_front();
+        stServer.nRunning++;
+        this->m_nPending--;
+
+        //the server with the jobs left and below its cap being put at the back, the servers being served in turn
+        this->markReady(iter->first, stServer);
+        return true;
+    }
+
+    return false;
+}
+
+bool CFTPScheduler::markReady(const std::string & strServer, StFTPServer & stServer)
+{
+    if(stServer.bReady || stServer.deqJobs.empty() || stServer.nRunning >= this->m_nMaxPerServer)
+        return false;
+
+    stServer.bReady = true;
+    this->m_deqReady.emplace_back(strServer);
+    return true;
+}
+
+//the handle being reset, the options of the last job being cleared while its connections kept
+CFTPScheduler::StFTPHandle CFTPScheduler::acquireHandle(const std::string & strServer)
+{
+    auto iter = this->m_mpIdle.find(strServer);
+    if(this->m_mpIdle.end() == iter || iter->second.empty()){
+        StFTPHandle stHandle;
+        stHandle.pCurl = curl_easy_init();
+        stHandle.pMulti = curl_multi_init();
+        if(nullptr == stHandle.pCurl || nullptr == stHandle.pMulti){
+            CFTPScheduler::closeHandle(stHandle);
+            return StFTPHandle();
+        }
+
+        this->m_stStats.nHandlesCreated++;
+        return stHandle;
+    }
+
+    StFTPHandle stHandle = iter->second.back();
+    iter->second.pop_back();
+    if(iter->second.empty())
+        this->m_mpIdle.erase(iter);
+
+    auto iterOrder = std::find(this->m_deqIdleOrder.begin(), this->m_deqIdleOrder.end(), std::make_pair(strServer, stHandle));
+    if(this->m_deqIdleOrder.end() != iterOrder)
+        this->m_deqIdleOrder.erase(iterOrder);
+
+    curl_easy_reset(stHandle.pCurl);
+    return stHandle;
+}
+
+void CFTPScheduler::releaseHandle(const std::string & strServer, const StFTPHandle & stHandle)
+{
+    this->m_mpIdle[strServer].emplace_back(stHandle);
+    this->m_deqIdleOrder.emplace_back(strServer, stHandle);
+
+    //the handle idle the longest being closed, with its connection logged in
+    while(this->m_deqIdleOrder.size() > this->m_nMaxIdle){
+        auto stOldest = this->m_deqIdleOrder.front();
+        this->m_deqIdleOrder.pop_front();
+
+        auto iter = this->m_mpIdle.find(stOldest.first);
+        if(this->m_mpIdle.end() != iter){
+            auto & vecHandles = iter->second;
+            vecHandles.erase(std::remove(vecHandles.begin(), vecHandles.end(), stOldest.second), vecHandles.end());
+            if(vecHandles.empty())
+                this->m_mpIdle.erase(iter);
+        }
+
+        CFTPScheduler::closeHandle(stOldest.second);
+    }
+}
+
+bool CFTPScheduler::isWaitingSocket(CURLM * pMulti)
+{
+#if LIBCURL_VERSION_NUM >= 0x080800
+    unsigned int nFds = 0;
+    if(CURLM_OK != curl_multi_waitfds(pMulti, nullptr, 0, &nFds))
+        return false;
+
+    return nFds > 0;
+#else
+    //no curl_multi_waitfds before libcurl 8.8.0, the sockets NOT below FD_SETSIZE being NOT told by curl_multi_fdset,
+    //such the handle being only driven more often then
+    fd_set stRead, stWrite, stExcept;
+    FD_ZERO(&stRead);
+    FD_ZERO(&stWrite);
+    FD_ZERO(&stExcept);
+    int nMaxFd = -1;
+    if(CURLM_OK != curl_multi_fdset(pMulti, &stRead, &stWrite, &stExcept, &nMaxFd))
+        return false;
+
+    return nMaxFd >= 0;
+#endif
+}
+
+void CFTPScheduler::closeHandle(const StFTPHandle & stHandle)
+{
+    if(stHandle.pCurl)
+        curl_easy_cleanup(stHandle.pCurl);
+    if(stHandle.pMulti)
+        curl_multi_cleanup(stHandle.pMulti);
+}
@@ -0,0 +1,118 @@
+#ifndef CFTPSCHEDULER_H
+#define CFTPSCHEDULER_H
+
+/*
+ * CFTPScheduler runs the FTP transfers queued on a fixed count of worker threads, rather than a thread and a login
+ * each transfer. The easy handles being kept by the server after the transfers, such the control connections
+ * logged in being reused by the next transfers to the same server, without logging in again.
+ *
+ * At most nMaxPerServer transfers to a server running at once, so the connections to a server being bounded as well.
+ * The jobs being queued by the server, and the servers with the jobs and below their caps being kept in a ready list,
+ * such the workers taking the jobs from the ready servers in turn, the servers reaching their caps being NOT scanned
+ * at all rather than blocking the jobs of the other servers, and a single worker being woken each job runnable.
+ *
+ * The jobs performing the handle by CFTPScheduler::perform rather than curl_easy_perform, the handle being driven by
+ * a multi handle of its own, which keeping the connections. On the connection reused with the reply of EPSV read at
+ * once, libcurl preparing the data connection without connecting it, and waiting NO socket and NO timer for it, so
+ * curl_easy_perform sleeping a second for each such transfer. The handle being driven again after g_nMinNudgeMs up to
+ * g_nMaxNudgeMs doubled while libcurl waiting NO socket, and by the timeout of libcurl otherwise.
+ *
+ * The jobs NOT run yet being invoked with nullptr on destruction, such their futures NOT being left pending.
+ */
+
+#include "curl/curl.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+
+typedef struct ST_ftpSchedulerStats{
+    std::uint64_t nSubmitted = 0;
+    std::uint64_t nCompleted = 0;
+    std::uint64_t nHandlesCreated = 0;
+    std::uint64_t nNewConnections = 0;  //the control connections opened, each being a login
+    size_t nPending = 0;
+    size_t nRunning = 0;
+    size_t nIdleHandles = 0;
+}StFTPSchedulerStats;
+
+class CFTPScheduler
+{
+public:
+    //the handle being reset and ready for the options of the job, nullptr when NOT available, the job must NOT keep it,
+    //return false to close the handle rather than reusing it, such as the transfer failed and the connection NOT trusted
+    using job = std::function<bool(CURL * pCurl)>;
+
+    explicit CFTPScheduler(const size_t nWorkers = 8, const size_t nMaxPerServer = 4, const size_t nMaxIdle = 32);
+    ~CFTPScheduler();
+
+    //copy constructor and assignment operator prohibited
+    CFTPScheduler(const CFTPScheduler & ) = delete;
+    CFTPScheduler(const CFTPScheduler && ) = delete;
+    CFTPScheduler & operator=(const CFTPScheduler &) = delete;
+    CFTPScheduler & operator=(const CFTPScheduler &&) = delete;
+
+    //the scheduler of the async transfers of CFTPSClient by default
+    static CFTPScheduler & getInst();
+
+    //queue the job to the server, such as "ftp://user@host:port", return false when being stopped, fnJob NOT being invoked then
+    bool submit(const std::string & strServer, job fnJob);
+
+    //perform the handle given to the job, curl_easy_perform when NOT being called from a job
+    static CURLcode perform(CURL * pCurl);
+
+    StFTPSchedulerStats getStats() const;
+
+private:
+    typedef struct ST_ftpJob{
+        std::string strServer;
+        job fnJob;
+    }StFTPJob;
+
+    typedef struct ST_ftpServer{
+        std::deque<StFTPJob> deqJobs;
+        size_t nRunning = 0;
+        bool bReady = false;//in m_deqReady
+    }StFTPServer;
+
+    typedef struct ST_ftpHandle{
+        CURL * pCurl = nullptr;
+        CURLM * pMulti = nullptr;//keeping the connections of the handle
+
+        bool operator==(const ST_ftpHandle & other) const{
+            return this->pCurl == other.pCurl;
+        }
+    }StFTPHandle;
+
+    void workLoop();
+    bool takeJob(StFTPJob & stJob);//with m_mtx held, the first job of the first ready server
+    bool markReady(const std::string & strServer, StFTPServer & stServer);//with m_mtx held, return true when being added
+    StFTPHandle acquireHandle(const std::string & strServer);//with m_mtx held
+    void releaseHandle(const std::string & strServer, const StFTPHandle & stHandle);//with m_mtx held
+    static void closeHandle(const StFTPHandle & stHandle);
+    static bool isWaitingSocket(CURLM * pMulti);//whether libcurl waiting any socket of the transfers
+
+private:
+    const size_t m_nMaxPerServer;
+    const size_t m_nMaxIdle;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::unordered_map<std::string, StFTPServer> m_mpServers;//the servers with the jobs queued or running
+    std::deque<std::string> m_deqReady;//the servers with the jobs queued and below their caps
+    size_t m_nPending = 0;
+    std::unordered_map<std::string, std::vector<StFTPHandle>> m_mpIdle;//the handles logged in by the server
+    std::deque<std::pair<std::string, StFTPHandle>> m_deqIdleOrder;//the idle handles from the oldest, being evicted over m_nMaxIdle
+    StFTPSchedulerStats m_stStats;
+    bool m_bStop = false;
+
+    std::vector<std::thread> m_vecWorkers;
+};
+
+#endif // CFTPSCHEDULER_H
@@ -1,6 +1,8 @@
 #include "cftpsclient.h"
 
 #include "cresourceinit.h"
+#include "cdnscache.h"
+#include "cftpscheduler.h"
 
 #include <sstream>
 #include <cstdio>   //for tempfile()
@@ -97,6 +99,18 @@ CFTPSClient & CFTPSClient::setMode(const FTPMode enMode)
     return *this;
 }
 
+CFTPSClient & CFTPSClient::setDnsCache(CDnsCache * pDnsCache)
+{
+    this->m_pDnsCache = pDnsCache;
+    return *this;
+}
+
+CFTPSClient & CFTPSClient::setScheduler(CFTPScheduler * pScheduler)
+{
+    this->m_pScheduler = pScheduler;
+    return *this;
+}
+
 const StHostInfo & CFTPSClient::getParams() const
 {
     return this->m_stParams;
@@ -524,11 +538,11 @@ std::optional<bool> CFTPSClient::upFile(const std::string & strLocalFile, const
 //async file upload, return true on success, otherwise return false and relative error message
 std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::upFile_async(const std::string & strLocalFile, const std::string & strRemotePath)
 {
-    std::promise<std::optional<std::pair<bool, std::string>>> promise;
-    std::future<std::optional<std::pair<bool, std::string>>> future = promise.get_future();
+    auto pPromise = std::make_shared<std::promise<std::optional<std::pair<bool, std::string>>>>();
+    std::future<std::optional<std::pair<bool, std::string>>> future = pPromise->get_future();
 
     //async file upload, note strLocalFile and strRemotePath can NOT captured by reference
-    auto async_upFile = [strIpPort = this->getIp_Port(), strUserPwd = this->getUser_Pwd(), strLocalFile, strRemotePath, promiseUpload = std::move(promise)]() mutable ->void{
+    auto async_upFile = [strIpPort = this->getIp_Port(), strUserPwd = this->getUser_Pwd(), pDnsCache = this->m_pDnsCache, stHost = this->m_stParams, strLocalFile, strRemotePath, pPromise](CURL * pCurl) ->bool{
         try{
             std::optional<std::pair<bool, std::string>> bRet;
             {
@@ -537,16 +551,16 @@ std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::upFile_asy
 
                 if(remotePath.empty() || localPath.empty() || localPath.has_filename() == false){
                     bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_INVALID_INPUT_ARGS));
-                    promiseUpload.set_value(bRet);
-                    return ;
+                    pPromise->set_value(bRet);
+                    return true;
                 }
             }
 
-            std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> pCurl(curl_easy_init(), &curl_easy_cleanup);
-            if(!pCurl){
+            //the handle of the scheduler, being reused with its connection logged in
+            if(nullptr == pCurl){
                 bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_RESOURCE_INIT_ERROR));
-                promiseUpload.set_value(bRet);
-                return ;
+                pPromise->set_value(bRet);
+                return false;
             }
 
             //open the local file to upload， NOTE:the difference of the decltype(&fclose) and decltype(fclose)
@@ -555,8 +569,8 @@ std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::upFile_asy
             std::unique_ptr<FILE, decltype(&fclose)> fp(fopen(strLocalFile.c_str(), "rb"), &fclose);
             if (!fp){
                 bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_FAILED_TO_OPEN_LOCAL_FILE));
-                promiseUpload.set_value(bRet);
-                return ;
+                pPromise->set_value(bRet);
+                return true;
             }
 
             //when the remote file passed as a directory, set the upload filename as the local filename
@@ -570,32 +584,45 @@ std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::upFile_asy
             size_t nFileSize = fs::file_size(strLocalFile);
             std::string && strURL = strIpPort  + remotePath.string();
 
-            curl_easy_setopt(pCurl.get(), CURLOPT_URL, strURL.c_str());
-            curl_easy_setopt(pCurl.get(), CURLOPT_USERPWD, strUserPwd.c_str());
-            curl_easy_setopt(pCurl.get(), CURLOPT_READFUNCTION, CFTPSClient::upReadCallback);
-            curl_easy_setopt(pCurl.get(), CURLOPT_READDATA, fp.get());
-            curl_easy_setopt(pCurl.get(), CURLOPT_FTP_CREATE_MISSING_DIRS, 1);
-            curl_easy_setopt(pCurl.get(), CURLOPT_UPLOAD, 1);
-            curl_easy_setopt(pCurl.get(), CURLOPT_INFILESIZE, nFileSize);
-            curl_easy_setopt(pCurl.get(), CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(pCurl.get(), CURLOPT_SSL_VERIFYHOST, 0L);
-            curl_easy_setopt(pCurl.get(), CURLOPT_CONNECTTIMEOUT_MS, 3000L);//connect timeout for 3 seconds
+            curl_easy_setopt(pCurl, CURLOPT_URL, strURL.c_str());
+            curl_easy_setopt(pCurl, CURLOPT_USERPWD, strUserPwd.c_str());
+            curl_easy_setopt(pCurl, CURLOPT_READFUNCTION, CFTPSClient::upReadCallback);
+            curl_easy_setopt(pCurl, CURLOPT_READDATA, fp.get());
+            //the CWD being retried when the MKD failed, such the directory being created by the other transfer concurrently
+            curl_easy_setopt(pCurl, CURLOPT_FTP_CREATE_MISSING_DIRS, CURLFTP_CREATE_DIR_RETRY);
+            curl_easy_setopt(pCurl, CURLOPT_UPLOAD, 1);
+            curl_easy_setopt(pCurl, CURLOPT_INFILESIZE, nFileSize);
+            curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYHOST, 0L);
+            curl_easy_setopt(pCurl, CURLOPT_CONNECTTIMEOUT_MS, 3000L);//connect timeout for 3 seconds
+
+            std::shared_ptr<curl_slist> pResolve;
+            if(pDnsCache)
+                pDnsCache->apply(pCurl, stHost.strIp, stHost.nPort, pResolve);
 
             //perform the file upload request
-            CURLcode enRet = curl_easy_perform(pCurl.get());
+            CURLcode enRet = CFTPScheduler::perform(pCurl);
             if (CURLE_OK == enRet){
                 bRet = std::make_pair(true, std::string());
             }else{
                 bRet = std::make_pair(false, std::string(curl_easy_strerror(enRet)));
             }
 
-            promiseUpload.set_value(bRet);
+            pPromise->set_value(bRet);
+
+            //the connection failed being closed, libcurl NOT tracking the working directory of the server after a failure
+            return CURLE_OK == enRet;
         }catch(...){
-            promiseUpload.set_exception(std::current_exception());
+            pPromise->set_exception(std::current_exception());
+            return false;
         }
     };
 
-    std::thread(std::move(async_upFile)).detach();
+    //queued to the workers of the scheduler rather than a thread each
+    CFTPScheduler & scheduler = this->m_pScheduler ? *this->m_pScheduler : CFTPScheduler::getInst();
+    if(!scheduler.submit(this->getIp_Port() + std::string("|") + this->m_stParams.strUserName, std::move(async_upFile)))
+        pPromise->set_value(std::make_pair(false, std::string("such the FTP scheduler had been stopped")));
+
     return future;
 }
 
@@ -650,11 +677,11 @@ std::optional<bool> CFTPSClient::downFile(const std::string & strLocalFile , con
 //async file download, return true on success, otherwise return false
 std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::downFile_async(const std::string & strLocalFile, const std::string & strRemoteFile)
 {
-    std::promise<std::optional<std::pair<bool, std::string>>> promise;
-    std::future<std::optional<std::pair<bool, std::string>>> future = promise.get_future();
+    auto pPromise = std::make_shared<std::promise<std::optional<std::pair<bool, std::string>>>>();
+    std::future<std::optional<std::pair<bool, std::string>>> future = pPromise->get_future();
 
     //async file download, NOTE: strLocalFile and strRemotePath can NOT captured by reference
-    auto async_downFile = [strIpPort = this->getIp_Port(), strUserPwd = this->getUser_Pwd(), strRemoteFile, strLocalFile, promiseDownload = std::move(promise)]() mutable ->void{
+    auto async_downFile = [strIpPort = this->getIp_Port(), strUserPwd = this->getUser_Pwd(), pDnsCache = this->m_pDnsCache, stHost = this->m_stParams, strRemoteFile, strLocalFile, pPromise](CURL * pCurl) ->bool{
         try{
             std::optional<std::pair<bool, std::string>> bRet;
             {
@@ -663,24 +690,24 @@ std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::downFile_a
 
                 if(remoteFile.empty() || localFile.empty() || remoteFile.has_filename() == false){
                     bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_INVALID_INPUT_ARGS));
-                    promiseDownload.set_value(bRet);
-                    return ;
+                    pPromise->set_value(bRet);
+                    return true;
                 }
             }
 
-            std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> pCurl(curl_easy_init(), &curl_easy_cleanup);
-            if(!pCurl){
+            //the handle of the scheduler, being reused with its connection logged in
+            if(nullptr == pCurl){
                 bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_RESOURCE_INIT_ERROR));
-                promiseDownload.set_value(bRet);
-                return ;
+                pPromise->set_value(bRet);
+                return false;
             }
 
             //create the local file path if not existing
             auto && pairRet = CFTPSClient::createDirectory(strLocalFile);
             if(!pairRet.has_value() || !pairRet->first){
                 bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_FAILED_TO_CREATE_LOCAL_DIR) + pairRet->second);
-                promiseDownload.set_value(bRet);
-                return ;
+                pPromise->set_value(bRet);
+                return true;
             }
 
             //when the remote file passed as a directory, set the upload filename as the local filename
@@ -693,34 +720,46 @@ std::future<std::optional<std::pair<bool, std::string>>> CFTPSClient::downFile_a
             std::unique_ptr<FILE, decltype(&fclose)> fp(fopen(strLocalFileTemp.c_str(), "wb+"), &fclose);
             if(!fp){
                 bRet = std::make_pair(false, g_mpFtpsErrMsg.at(EN_FTPS_FAILED_TO_OPEN_LOCAL_FILE));
-                promiseDownload.set_value(bRet);
-                return ;
+                pPromise->set_value(bRet);
+                return true;
             }
 
             std::string && strURL = strIpPort + strRemoteFile;
 
-            curl_easy_setopt(pCurl.get(), CURLOPT_URL, strURL.c_str());
-            curl_easy_setopt(pCurl.get(), CURLOPT_USERPWD, strUserPwd.c_str());
-            curl_easy_setopt(pCurl.get(), CURLOPT_WRITEFUNCTION, CFTPSClient::downWriteCallback);
-            curl_easy_setopt(pCurl.get(), CURLOPT_WRITEDATA, fp.get());
-            curl_easy_setopt(pCurl.get(), CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(pCurl.get(), CURLOPT_SSL_VERIFYHOST, 0L);
+            curl_easy_setopt(pCurl, CURLOPT_URL, strURL.c_str());
+            curl_easy_setopt(pCurl, CURLOPT_USERPWD, strUserPwd.c_str());
+            curl_easy_setopt(pCurl, CURLOPT_WRITEFUNCTION, CFTPSClient::downWriteCallback);
+            curl_easy_setopt(pCurl, CURLOPT_WRITEDATA, fp.get());
+            curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYPEER, 0L);
+            curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+            std::shared_ptr<curl_slist> pResolve;
+            if(pDnsCache)
+                pDnsCache->apply(pCurl, stHost.strIp, stHost.nPort, pResolve);
 
             //perform the download request
-            CURLcode enRet = curl_easy_perform(pCurl.get());
+            CURLcode enRet = CFTPScheduler::perform(pCurl);
             if (CURLE_OK == enRet){
                 bRet = std::make_pair(true, std::string());
             }else{
                 bRet = std::make_pair(false, std::string(curl_easy_strerror(enRet)));
             }
 
-            promiseDownload.set_value(bRet);
+            pPromise->set_value(bRet);
+
+            //the connection failed being closed, libcurl NOT tracking the working directory of the server after a failure
+            return CURLE_OK == enRet;
         }catch(...){
-            promiseDownload.set_exception(std::current_exception());
+            pPromise->set_exception(std::current_exception());
+            return false;
         }
     };
 
-    std::thread(std::move(async_downFile)).detach();
+    //queued to the workers of the scheduler rather than a thread each
+    CFTPScheduler & scheduler = this->m_pScheduler ? *this->m_pScheduler : CFTPScheduler::getInst();
+    if(!scheduler.submit(this->getIp_Port() + std::string("|") + this->m_stParams.strUserName, std::move(async_downFile)))
+        pPromise->set_value(std::make_pair(false, std::string("such the FTP scheduler had been stopped")));
+
     return future;
 }
 
@@ -898,6 +937,8 @@ void CFTPSClient::generalSetting(const std::string & strURL)
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_USERPWD, this->getUser_Pwd().c_str());
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_SSL_VERIFYHOST, 0L);
+    if(this->m_pDnsCache)
+        this->m_pDnsCache->apply(this->m_pCurl.get(), this->m_stParams.strIp, this->m_stParams.nPort, this->m_pResolve);
 }
 
 std::string CFTPSClient::getIp_Port()
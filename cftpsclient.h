@@ -18,6 +18,9 @@
 #include <future>
 #include <memory>
 
+class CDnsCache;
+class CFTPScheduler;
+
 //file detailed infomation struct
 typedef struct STFileInfo{
     std::string strPermission;  //file read write permission
@@ -58,6 +61,9 @@ private:
     StHostInfo m_stParams;//ftp connection parameters
     std::string m_strErrMsg = "";//error message of the last operation
     std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> m_pCurl;
+    CDnsCache * m_pDnsCache = nullptr;//NOT being owned
+    std::shared_ptr<curl_slist> m_pResolve;//the list of CURLOPT_RESOLVE of the handle
+    CFTPScheduler * m_pScheduler = nullptr;//NOT being owned, CFTPScheduler::getInst() by default
 
 public:
     CFTPSClient(const StHostInfo & stInfo);
@@ -78,6 +84,13 @@ public:
     CFTPSClient & setPort(const std::uint16_t nPort);
     CFTPSClient & setIP(const std::string & strIP);
     CFTPSClient & setMode(const FTPMode enMode);
+
+    //the host being resolved through the cache rather than by libcurl each connection, the cache must outlive the client,
+    //nullptr to disable
+    CFTPSClient & setDnsCache(CDnsCache * pDnsCache);
+
+    //the async transfers being run by the scheduler, which must outlive the transfers, nullptr for CFTPScheduler::getInst()
+    CFTPSClient & setScheduler(CFTPScheduler * pScheduler);
     const StHostInfo & getParams() const;
 
     //to verify the parameters valid or not, return true when parameters valid,otherwise return false
@@ -120,13 +133,13 @@ public:
     //upload the given local file to the remote path, return true on success, otherwise return false
     std::optional<bool> upFile(const std::string & strLocalFile, const std::string & strRemotePath);
 
-    //async file upload, return true on success, otherwise return false and relative error message
+    //async file upload, being queued to the scheduler, return true on success, otherwise return false and relative error message
     std::future<std::optional<std::pair<bool, std::string>>> upFile_async(const std::string & strLocalFile, const std::string & strRemotePath);
 
     //download the given remote file to the local path, return true on success, otherwise return false
     std::optional<bool> downFile(const std::string & strLocalFile, const std::string & strRemoteFile);
 
-    //async file download, return true on success, otherwise return false and relative error message
+    //async file download, being queued to the scheduler, return true on success, otherwise return false and relative error message
     std::future<std::optional<std::pair<bool, std::string>>> downFile_async(const std::string & strLocalFile, const std::string & strRemotePath);
 
     //copy the given remote file into the given remote directory
@@ -157,6 +170,8 @@ private:
     void generalSetting(const std::string & strURL);
 
 private:
+    friend class CFTPAsyncEngine;//the transfers of the engine being read and written by the callbacks below
+
     //upload read callback, being used to read the local file to upload
     static size_t upReadCallback(void * ptr, size_t size, size_t nmemb, void * stream);
 
@@ -0,0 +1,436 @@
+#include "chttpasyncengine.h"
+
+#include <iostream>
+#include <algorithm>
+
+CHTTPAsyncEngine::CHTTPAsyncEngine(const size_t nMaxInFlight/*=1024*/, const size_t nMaxPerHost/*=64*/)
+    : m_nMaxInFlight(std::max<size_t>(nMaxInFlight, 1)), m_nMaxPerHost(std::max<size_t>(nMaxPerHost, 1))
+{
+    this->m_strErrMsg = this->m_loop.getErrMsg();
+}
+
+CHTTPAsyncEngine::~CHTTPAsyncEngine()
+{
+    //the transfers in flight being aborted and completed on the loop thread before it exiting
+    this->m_bStopping.store(true);
+    this->m_loop.stop();
+
+    for(auto & item : this->m_mpHosts){
+        for(auto & pTransfer : item.second.deqPending){
+            pTransfer->stResponse.strErrMsg = std::string("such the async HTTP engine had been stopped");
+            if(pTransfer->callback)
+                pTransfer->callback(std::move(pTransfer->stResponse));
+        }
+    }
+    this->m_mpHosts.clear();
+
+    for(auto pCurl : this->m_vecIdleHandles)
+        curl_easy_cleanup(pCurl);
+}
+
+std::future<StHTTPResponse> CHTTPAsyncEngine::submit(StHTTPRequest stRequest)
+{
+    auto pPromise = std::make_shared<std::promise<StHTTPResponse>>();
+    std::future<StHTTPResponse> future = pPromise->get_future();
+
+    this->submit(std::move(stRequest), [pPromise](StHTTPResponse && stResponse){
+        pPromise->set_value(std::move(stResponse));
+    });
+
+    return future;
+}
+
+void CHTTPAsyncEngine::submit(StHTTPRequest stRequest, responseCallback callback)
+{
+    auto pTransfer = std::make_shared<StTransfer>();
+    pTransfer->strHost = hostOf(stRequest.strURL);
+    pTransfer->stRequest = std::move(stRequest);
+    pTransfer->callback = std::move(callback);
+
+    this->enqueue(std::move(pTransfer));
+}
+
+std::future<size_t> CHTTPAsyncEngine::getMany(std::vector<std::string> vecURLs, itemCallback onItem, const size_t nParallel/*=16*/,
+                                              const StHTTPRequest & stTemplate/*=StHTTPRequest()*/)
+{
+    auto pBatch = std::make_shared<StBatch>();
+    pBatch->vecURLs = std::move(vecURLs);
+    pBatch->onItem = std::move(onItem);
+    pBatch->stTemplate = stTemplate;
+    pBatch->stTemplate.strMethod = "GET";
+    pBatch->stTemplate.strBody.clear();
+
+    std::future<size_t> future = pBatch->promise.get_future();
+    if(pBatch->vecURLs.empty()){
+        pBatch->promise.set_value(0);
+        return future;
+    }
+
+    //each URL done launching the next one, such at most nParallel in flight
+    const size_t nWindow = std::min(std::max<size_t>(nParallel, 1), pBatch->vecURLs.size());
+    for(size_t ii = 0; ii < nWindow; ii++)
+        this->launchNext(pBatch);
+
+    return future;
+}
+
+CHTTPAsyncEngine & CHTTPAsyncEngine::setMaxInFlight(const size_t nMaxInFlight)
+{
+    this->m_nMaxInFlight.store(std::max<size_t>(nMaxInFlight, 1));
+    return *this;
+}
+
+CHTTPAsyncEngine & CHTTPAsyncEngine::setMaxPerHost(const size_t nMaxPerHost)
+{
+    this->m_nMaxPerHost.store(std::max<size_t>(nMaxPerHost, 1));
+    return *this;
+}
+
+CHTTPAsyncEngine & CHTTPAsyncEngine::setHTTPVersion(const HTTPVersion enVersion, const size_t nMaxStreams/*=100*/, const size_t nMaxHostConns/*=1*/)
+{
+    //the cap of the connections and the waiting being applied only when HTTP/2 requested
+    const bool bMultiplex = _EN_HTTP_1_1_ != enVersion;
+    this->m_enVersion.store(enVersion);
+    this->m_bPipeWait.store(bMultiplex);
+
+    //the multi handle being touched on the loop thread only
+    this->m_loop.post([this, bMultiplex, nMaxStreams, nMaxHostConns](){
+        curl_multi_setopt(this->m_loop.multi(), CURLMOPT_PIPELINING, bMultiplex ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+        curl_multi_setopt(this->m_loop.multi(), CURLMOPT_MAX_CONCURRENT_STREAMS, static_cast<long>(std::max<size_t>(nMaxStreams, 1)));
+        //otherwise a new connection being opened for each request beyond the stream limit
+        curl_multi_setopt(this->m_loop.multi(), CURLMOPT_MAX_HOST_CONNECTIONS, bMultiplex ? static_cast<long>(nMaxHostConns) : 0L);
+    });
+
+    return *this;
+}
+
+CHTTPAsyncEngine & CHTTPAsyncEngine::setMetrics(CHTTPMetrics * pMetrics)
+{
+    this->m_pMetrics.store(pMetrics);
+    return *this;
+}
+
+CHTTPAsyncEngine & CHTTPAsyncEngine::setLimiter(CHTTPHostLimiter * pLimiter)
+{
+    this->m_pLimiter.store(pLimiter);
+    //the requests held by the limiter before being released from it
+    this->m_loop.post([this](){
+        this->retryLimited();
+        this->dispatch();
+    });
+
+    return *this;
+}
+
+const std::string & CHTTPAsyncEngine::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+std::string CHTTPAsyncEngine::hostOf(const std::string & strURL)
+{
+    size_t nBegin = strURL.find("://");
+    nBegin = (std::string::npos == nBegin) ? 0 : nBegin + 3;
+
+    const size_t nEnd = strURL.find_first_of("/?#", nBegin);
+    std::string strHost = strURL.substr(nBegin, std::string::npos == nEnd ? std::string::npos : nEnd - nBegin);
+
+    //the user info such as "user:password@" NOT being a part of the host
+    const size_t nAt = strHost.rfind('@');
+    if(std::string::npos != nAt)
+        strHost.erase(0, nAt + 1);
+
+    return strHost;
+}
+
+void CHTTPAsyncEngine::enqueue(std::shared_ptr<StTransfer> pTransfer)
+{
+    const bool bPosted = this->m_loop.post([this, pTransfer](){
+        StHostQueue & stHost = this->m_mpHosts[pTransfer->strHost];
+        stHost.deqPending.emplace_back(pTransfer);
+        this->markRunnable(pTransfer->strHost, stHost, this->m_nMaxPerHost.load());
+        this->dispatch();
+    });
+
+    if(!bPosted){
+        pTransfer->stResponse.strErrMsg = std::string("such the async HTTP engine being unavailable:") + this->m_strErrMsg;
+        if(pTransfer->callback)
+            pTransfer->callback(std::move(pTransfer->stResponse));
+    }
+}
+
+void CHTTPAsyncEngine::launchNext(const std::shared_ptr<StBatch> & pBatch)
+{
+    const size_t nIndex = pBatch->nNext.fetch_add(1);
+    if(nIndex >= pBatch->vecURLs.size())
+        return ;
+
+    //the engine NOT accepting, the URLs left being failed here rather than launching each other recursively
+    if(this->m_bStopping.load() || !this->m_strErrMsg.empty()){
+        for(size_t ii = nIndex; ii < pBatch->vecURLs.size(); ii = pBatch->nNext.fetch_add(1)){
+            StHTTPResponse stResponse;
+            stResponse.strErrMsg = std::string("such the async HTTP engine being unavailable:") + this->m_strErrMsg;
+            this->deliver(pBatch, ii, std::move(stResponse));
+        }
+
+        return ;
+    }
+
+    StHTTPRequest stRequest = pBatch->stTemplate;
+    stRequest.strURL = pBatch->vecURLs[nIndex];
+    this->submit(std::move(stRequest), [this, pBatch, nIndex](StHTTPResponse && stResponse){
+        this->deliver(pBatch, nIndex, std::move(stResponse));
+        this->launchNext(pBatch);
+    });
+}
+
+void CHTTPAsyncEngine::deliver(const std::shared_ptr<StBatch> & pBatch, const size_t nIndex, StHTTPResponse && stResponse)
+{
+    if(!stResponse.strErrMsg.empty() || stResponse.nStatus >= 400)
+        pBatch->nFailed++;
+
+    try{
+        if(pBatch->onItem)
+            pBatch->onItem(nIndex, std::move(stResponse));
+    }catch(const std::exception & e){
+        std::cout << "exception from the HTTP batch callback:" << e.what() << std::endl;
+    }
+
+    if(pBatch->vecURLs.size() == ++pBatch->nDone)
+        pBatch->promise.set_value(pBatch->nFailed.load());
+}
+
+//start the pending requests of the runnable hosts within the caps, the hosts reaching their caps NOT being in the
+//list rather than blocking the requests of the other hosts, and the limiter being consulted once each host
+void CHTTPAsyncEngine::dispatch()
+{
+    const size_t nMaxInFlight = this->m_nMaxInFlight.load();
+    const size_t nMaxPerHost = this->m_nMaxPerHost.load();
+    CHTTPHostLimiter * pLimiter = this->m_pLimiter.load();
+    long nMinWaitMs = 0;//the limited host ready the soonest
+
+    while(this->m_nInFlight < nMaxInFlight && !this->m_deqRunnable.empty()){
+        const std::string strHost = std::move(this->m_deqRunnable.front());
+        this->m_deqRunnable.pop_front();
+
+        auto iter = this->m_mpHosts.find(strHost);
+        if(this->m_mpHosts.end() == iter)
+            continue;
+
+        StHostQueue & stHost = iter->second;
+        stHost.bRunnable = false;
+        if(stHost.deqPending.empty() || stHost.nInFlight >= nMaxPerHost)
+            continue;//the cap lowered, being runnable again on a request of the host done
+
+        //limited by the concurrency, nWaitMs being 0, a request done dispatching again
+        long nWaitMs = 0;
+        if(pLimiter && !pLimiter->tryAcquire(strHost, nWaitMs)){
+            if(nWaitMs > 0 && (0 == nMinWaitMs || nWaitMs < nMinWaitMs))
+                nMinWaitMs = nWaitMs;
+
+            if(!stHost.bLimited){
+                stHost.bLimited = true;
+                this->m_vecLimited.emplace_back(strHost);
+            }
+            continue;
+        }
+
+        std::shared_ptr<StTransfer> pTransfer = std::move(stHost.deqPending.front());
+        stHost.deqPending.pop_front();
+        pTransfer->pLimiter = pLimiter;
+        pTransfer->startedAt = std::chrono::steady_clock::now();
+        this->start(pTransfer);
+
+        //the host with the requests left being put at the back, the entry being found again, which possibly erased by
+        //the transfer failed to start
+        iter = this->m_mpHosts.find(strHost);
+        if(this->m_mpHosts.end() != iter){
+            this->markRunnable(strHost, iter->second, nMaxPerHost);
+            this->eraseIfIdle(iter);
+        }
+    }
+
+    if(nMinWaitMs > 0)
+        this->scheduleDispatch(nMinWaitMs);
+}
+
+void CHTTPAsyncEngine::markRunnable(const std::string & strHost, StHostQueue & stHost, const size_t nMaxPerHost)
+{
+    if(stHost.bRunnable || stHost.bLimited || stHost.deqPending.empty() || stHost.nInFlight >= nMaxPerHost)
+        return ;
+
+    stHost.bRunnable = true;
+    this->m_deqRunnable.emplace_back(strHost);
+}
+
+void CHTTPAsyncEngine::retryLimited()
+{
+    const size_t nMaxPerHost = this->m_nMaxPerHost.load();
+    std::vector<std::string> vecLimited;
+    vecLimited.swap(this->m_vecLimited);
+    for(const auto & strHost : vecLimited){
+        auto iter = this->m_mpHosts.find(strHost);
+        if(this->m_mpHosts.end() == iter)
+            continue;
+
+        iter->second.bLimited = false;
+        this->markRunnable(strHost, iter->second, nMaxPerHost);
+    }
+}
+
+void CHTTPAsyncEngine::eraseIfIdle(std::unordered_map<std::string, StHostQueue>::iterator iter)
+{
+    const StHostQueue & stHost = iter->second;
+    if(0 == stHost.nInFlight && stHost.deqPending.empty() && !stHost.bRunnable && !stHost.bLimited)
+        this->m_mpHosts.erase(iter);
+}
+
+//at most a timer pending, unless the new one being earlier
+void CHTTPAsyncEngine::scheduleDispatch(const long nWaitMs)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto deadline = now + std::chrono::milliseconds(nWaitMs);
+    if(this->m_redispatchAt.has_value() && *this->m_redispatchAt > now && *this->m_redispatchAt <= deadline)
+        return ;
+
+    this->m_redispatchAt = deadline;
+    this->m_loop.postAfter(std::chrono::milliseconds(nWaitMs), [this](){
+        if(this->m_redispatchAt.has_value() && *this->m_redispatchAt <= std::chrono::steady_clock::now())
+            this->m_redispatchAt.reset();
+
+        this->retryLimited();
+        this->dispatch();
+    });
+}
+
+bool CHTTPAsyncEngine::start(std::shared_ptr<StTransfer> & pTransfer)
+{
+    CURL * pCurl = this->acquireHandle();
+    if(nullptr == pCurl){
+        this->finish(nullptr, CURLE_FAILED_INIT, pTransfer);
+        return false;
+    }
+
+    StHTTPRequest & stRequest = pTransfer->stRequest;
+    curl_easy_setopt(pCurl, CURLOPT_URL, stRequest.strURL.c_str());
+    curl_easy_setopt(pCurl, CURLOPT_TIMEOUT_MS, stRequest.nTimeoutMs);
+    curl_easy_setopt(pCurl, CURLOPT_CONNECTTIMEOUT_MS, stRequest.nConnectTimeoutMs);
+    curl_easy_setopt(pCurl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(pCurl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+    //waiting for the connection in progress to know whether it could multiplex, rather than opening a new one at once
+    curl_easy_setopt(pCurl, CURLOPT_HTTP_VERSION, CHTTPClient::toCurlVersion(this->m_enVersion.load()));
+    if(this->m_bPipeWait.load())
+        curl_easy_setopt(pCurl, CURLOPT_PIPEWAIT, 1L);
+
+    curl_easy_setopt(pCurl, CURLOPT_WRITEFUNCTION, CHTTPAsyncEngine::writeCallback);
+    curl_easy_setopt(pCurl, CURLOPT_WRITEDATA, &pTransfer->stResponse.strBody);
+    curl_easy_setopt(pCurl, CURLOPT_HEADERFUNCTION, CHTTPAsyncEngine::writeCallback);
+    curl_easy_setopt(pCurl, CURLOPT_HEADERDATA, &pTransfer->stResponse.strHeader);
+
+    //the body being owned by the transfer, which being alive until the transfer completed, so NOT being copied by libcurl
+    if("HEAD" == stRequest.strMethod){
+        curl_easy_setopt(pCurl, CURLOPT_NOBODY, 1L);
+    }else if("GET" != stRequest.strMethod){
+        if("POST" != stRequest.strMethod)
+            curl_easy_setopt(pCurl, CURLOPT_CUSTOMREQUEST, stRequest.strMethod.c_str());
+
+        if("POST" == stRequest.strMethod || !stRequest.strBody.empty()){
+            curl_easy_setopt(pCurl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(stRequest.strBody.size()));
+            curl_easy_setopt(pCurl, CURLOPT_POSTFIELDS, stRequest.strBody.c_str());
+        }
+    }
+
+    for(const auto & strHeader : stRequest.vecHeaders)
+        pTransfer->pHeaders.reset(curl_slist_append(pTransfer->pHeaders.release(), strHeader.c_str()));
+    if(pTransfer->pHeaders)
+        curl_easy_setopt(pCurl, CURLOPT_HTTPHEADER, pTransfer->pHeaders.get());
+
+    this->m_nInFlight++;
+    this->m_mpHosts[pTransfer->strHost].nInFlight++;
+
+    const bool bAdded = this->m_loop.add(pCurl, [this, pTransfer](CURL * pDoneCurl, const CURLcode enCode) mutable {
+        this->complete(pDoneCurl, enCode, pTransfer);
+    });
+
+    //the loop being stopped, NOT dispatching again, which being called by dispatch
+    if(!bAdded){
+        pTransfer->stResponse.strErrMsg = std::string("such the async HTTP engine had been stopped");
+        this->finish(pCurl, CURLE_FAILED_INIT, pTransfer);
+    }
+
+    return bAdded;
+}
+
+void CHTTPAsyncEngine::complete(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StTransfer> & pTransfer)
+{
+    this->finish(pCurl, enCode, pTransfer);
+
+    //the caps being freed, the hosts held by the limiter being consulted again, once each
+    this->retryLimited();
+    this->dispatch();
+}
+
+void CHTTPAsyncEngine::finish(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StTransfer> & pTransfer)
+{
+    StHTTPResponse & stResponse = pTransfer->stResponse;
+    if(pCurl){
+        curl_easy_getinfo(pCurl, CURLINFO_RESPONSE_CODE, &stResponse.nStatus);
+        CHTTPClient::readTransferInfo(pCurl, stResponse.stStats);
+        stResponse.stStats.nDownloadBody = static_cast<curl_off_t>(stResponse.strBody.size());
+        if(CHTTPMetrics * pMetrics = this->m_pMetrics.load())
+            pMetrics->record(pTransfer->strHost, stResponse.stStats, CURLE_OK == enCode);
+
+        this->releaseHandle(pCurl);
+
+        this->m_nInFlight--;
+        auto iter = this->m_mpHosts.find(pTransfer->strHost);
+        if(this->m_mpHosts.end() != iter){
+            iter->second.nInFlight--;
+            this->markRunnable(iter->first, iter->second, this->m_nMaxPerHost.load());
+            this->eraseIfIdle(iter);
+        }
+    }
+
+    //the transfer failed being released with 0, neither growing nor shrinking the limit
+    if(pTransfer->pLimiter){
+        const long nStatus = CURLE_OK == enCode ? stResponse.nStatus : 0;
+        const std::optional<long> nRetryAfterMs = (429 == nStatus || 503 == nStatus) ? CHTTPHostLimiter::retryAfterMs(stResponse.strHeader) : std::nullopt;
+        pTransfer->pLimiter->release(pTransfer->strHost, pTransfer->startedAt, nStatus, nRetryAfterMs);
+        pTransfer->pLimiter = nullptr;
+    }
+
+    if(CURLE_OK != enCode && stResponse.strErrMsg.empty())
+        stResponse.strErrMsg = std::string(curl_easy_strerror(enCode));
+
+    try{
+        if(pTransfer->callback)
+            pTransfer->callback(std::move(stResponse));
+    }catch(const std::exception & e){
+        std::cout << "exception from the HTTP response callback:" << e.what() << std::endl;
+    }
+}
+
+//the handles being reused, the options being reset while the connections kept by the multi handle
+CURL * CHTTPAsyncEngine::acquireHandle()
+{
+    if(this->m_vecIdleHandles.empty())
+        return curl_easy_init();
+
+    CURL * pCurl = this->m_vecIdleHandles.back();
+    this->m_vecIdleHandles.pop_back();
+    return pCurl;
+}
+
+void CHTTPAsyncEngine::releaseHandle(CURL * pCurl)
+{
+    curl_easy_reset(pCurl);
+    this->m_vecIdleHandles.emplace_back(pCurl);
+}
+
+size_t CHTTPAsyncEngine::writeCallback(void * contents, size_t size, size_t nmemb, void * pUserData)
+{
+    static_cast<std::string *>(pUserData)->append(static_cast<char *>(contents), size * nmemb);
+    return size * nmemb;
+}
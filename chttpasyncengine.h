@@ -0,0 +1,172 @@
+#ifndef CHTTPASYNCENGINE_H
+#define CHTTPASYNCENGINE_H
+
+/*
+ * CHTTPAsyncEngine runs the HTTP requests asynchronously on a CCurlMultiLoop, thousands of requests being in flight
+ * on a single thread rather than a thread each. The requests beyond the global cap or the cap of their host being
+ * queued and started as the earlier ones completing, and the easy handles being reused, such the connections, the
+ * DNS cache and the TLS sessions kept by the multi handle being reused as well.
+ *
+ * The results being delivered by futures or by callbacks, the callbacks being invoked on the loop thread, so they
+ * should NOT block.
+ *
+ * The requests being queued by the host, and the hosts with the requests queued and below their caps being kept in a
+ * runnable list, such a request done NOT scanning the requests of the hosts at their caps, and the hosts being served
+ * in turn.
+ *
+ * A CHTTPHostLimiter being set, the requests over the limit of their host being kept in the queue as well, the host
+ * being set aside after the limiter consulted once, and being dispatched again on a request done or the time waited
+ * by the limiter passing, no thread blocking on the limit.
+ */
+
+#include "ccurlmultiloop.h"
+#include "chttpclient.h"
+#include "chttpmetrics.h"
+#include "chttphostlimiter.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <future>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+typedef struct ST_httpRequest{
+    std::string strURL;//the full URL, such as "https://host:port/path?query"
+    std::string strMethod = "GET";
+    std::string strBody;
+    std::vector<std::string> vecHeaders;//such as "Content-Type: application/json"
+    long nTimeoutMs = 3000;
+    long nConnectTimeoutMs = 1000;
+}StHTTPRequest;
+
+typedef struct ST_httpResponse{
+    std::string strErrMsg;//empty on success
+    long nStatus = 0;
+    std::string strHeader;
+    std::string strBody;
+    StHTTPTransferStats stStats;//the bytes on the wire and the timings
+}StHTTPResponse;
+
+class CHTTPAsyncEngine
+{
+public:
+    using responseCallback = std::function<void(StHTTPResponse && stResponse)>;
+    using itemCallback = std::function<void(const size_t nIndex, StHTTPResponse && stResponse)>;
+
+    explicit CHTTPAsyncEngine(const size_t nMaxInFlight = 1024, const size_t nMaxPerHost = 64);
+    ~CHTTPAsyncEngine();
+
+    //copy constructor and assignment operator prohibited
+    CHTTPAsyncEngine(const CHTTPAsyncEngine & ) = delete;
+    CHTTPAsyncEngine(const CHTTPAsyncEngine && ) = delete;
+    CHTTPAsyncEngine & operator=(const CHTTPAsyncEngine &) = delete;
+    CHTTPAsyncEngine & operator=(const CHTTPAsyncEngine &&) = delete;
+
+    std::future<StHTTPResponse> submit(StHTTPRequest stRequest);
+    void submit(StHTTPRequest stRequest, responseCallback callback);
+
+    //GET the URLs with at most nParallel of them in flight, over the connections shared by the engine, each response
+    //being delivered to onItem on the loop thread as soon as done, in the order of completing, nIndex being its index in
+    //vecURLs. A URL failed NOT failing the others, the future being ready when all delivered, with the number of the
+    //failed, the transfers failed and the responses of 4xx and 5xx. The timeouts and the headers being of stTemplate
+    std::future<size_t> getMany(std::vector<std::string> vecURLs, itemCallback onItem, const size_t nParallel = 16,
+                                const StHTTPRequest & stTemplate = StHTTPRequest());
+
+    //the caps being applied to the requests started later
+    CHTTPAsyncEngine & setMaxInFlight(const size_t nMaxInFlight);
+    CHTTPAsyncEngine & setMaxPerHost(const size_t nMaxPerHost);
+
+    //HTTP/2 multiplexing the concurrent requests to the same host as streams over at most nMaxHostConns connections,
+    //at most nMaxStreams streams each connection, the requests beyond being queued by libcurl, and the requests waiting
+    //for the connection being set up rather than opening their own. nMaxHostConns capping the HTTP/1.1 hosts as well,
+    //so 0(unlimited) being preferred when the hosts NOT speaking HTTP/2 being mixed in. NOT being called, the version
+    //being the default of libcurl, HTTP/2 over TLS negotiated by ALPN, without capping the connections or waiting
+    CHTTPAsyncEngine & setHTTPVersion(const HTTPVersion enVersion, const size_t nMaxStreams = 100, const size_t nMaxHostConns = 1);
+
+    //each request done being recorded into the histograms of its host, the metrics must outlive the engine, nullptr to disable
+    CHTTPAsyncEngine & setMetrics(CHTTPMetrics * pMetrics);
+
+    //the requests being started within the limits of their hosts, the status and 'Retry-After' of the responses adapting
+    //the limits, the limiter must outlive the engine, nullptr to disable
+    CHTTPAsyncEngine & setLimiter(CHTTPHostLimiter * pLimiter);
+
+    const std::string & getErrMsg() const;
+
+    //"host[:port]" of the URL as written, the key of the per host cap
+    static std::string hostOf(const std::string & strURL);
+
+private:
+    typedef struct ST_transfer{
+        StHTTPRequest stRequest;
+        StHTTPResponse stResponse;
+        std::string strHost;
+        responseCallback callback;
+        CHTTPHostLimiter * pLimiter = nullptr;//the limiter acquired from, being released on finished
+        std::chrono::steady_clock::time_point startedAt;
+        std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> pHeaders{nullptr, &curl_slist_free_all};
+    }StTransfer;
+
+    typedef struct ST_batch{
+        std::vector<std::string> vecURLs;
+        itemCallback onItem;
+        StHTTPRequest stTemplate;
+        std::atomic<size_t> nNext{0};
+        std::atomic<size_t> nDone{0};
+        std::atomic<size_t> nFailed{0};
+        std::promise<size_t> promise;
+    }StBatch;
+
+    //the first window of a batch being launched on the thread of the caller, the others on the loop thread
+    void launchNext(const std::shared_ptr<StBatch> & pBatch);
+    void deliver(const std::shared_ptr<StBatch> & pBatch, const size_t nIndex, StHTTPResponse && stResponse);
+
+    typedef struct ST_hostQueue{
+        std::deque<std::shared_ptr<StTransfer>> deqPending;
+        size_t nInFlight = 0;
+        bool bRunnable = false;//in m_deqRunnable
+        bool bLimited = false;//in m_vecLimited
+    }StHostQueue;
+
+    //all on the loop thread
+    void enqueue(std::shared_ptr<StTransfer> pTransfer);
+    void dispatch();
+    void scheduleDispatch(const long nWaitMs);
+    void markRunnable(const std::string & strHost, StHostQueue & stHost, const size_t nMaxPerHost);
+    void retryLimited();//the hosts held by the limiter being runnable again
+    void eraseIfIdle(std::unordered_map<std::string, StHostQueue>::iterator iter);
+    bool start(std::shared_ptr<StTransfer> & pTransfer);
+    void complete(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StTransfer> & pTransfer);
+    void finish(CURL * pCurl, const CURLcode enCode, std::shared_ptr<StTransfer> & pTransfer);//complete without dispatching
+    CURL * acquireHandle();
+    void releaseHandle(CURL * pCurl);
+
+    static size_t writeCallback(void * contents, size_t size, size_t nmemb, void * pUserData);
+
+private:
+    std::string m_strErrMsg;
+
+    //touched by the loop thread only
+    std::unordered_map<std::string, StHostQueue> m_mpHosts;//the hosts with the requests pending or in flight
+    std::deque<std::string> m_deqRunnable;//the hosts with the requests pending and below the per host cap
+    std::vector<std::string> m_vecLimited;//the hosts with the requests pending held by the limiter
+    size_t m_nInFlight = 0;
+    std::vector<CURL *> m_vecIdleHandles;
+    std::optional<std::chrono::steady_clock::time_point> m_redispatchAt;//dispatching again for the limited hosts
+
+    std::atomic<size_t> m_nMaxInFlight;
+    std::atomic<size_t> m_nMaxPerHost;
+    std::atomic<HTTPVersion> m_enVersion{_EN_HTTP_2_TLS_};//the default of libcurl
+    std::atomic<bool> m_bPipeWait{false};//HTTP/2 being requested by setHTTPVersion
+    std::atomic<CHTTPMetrics *> m_pMetrics{nullptr};
+    std::atomic<CHTTPHostLimiter *> m_pLimiter{nullptr};
+    std::atomic<bool> m_bStopping{false};//the batches NOT submitting any more
+
+    CCurlMultiLoop m_loop;//the last member, the loop thread being started after all the others initialized
+};
+
+#endif // CHTTPASYNCENGINE_H
@@ -0,0 +1,619 @@
+#include "chttpcache.h"
+
+#include "curl/curl.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+namespace {
+    //the layout of the files of the disk tier, followed by the key, the ETag, the Last-Modified, the headers and the body
+    typedef struct ST_diskHeader{
+        char szMagic[8];
+        std::uint32_t nVersion;
+        std::uint32_t nKeySize;
+        std::uint32_t nETagSize;
+        std::uint32_t nLastModifiedSize;
+        std::uint64_t nHeaderSize;
+        std::uint64_t nBodySize;
+        std::int64_t nExpireMs;
+    }StDiskHeader;
+
+    constexpr char g_szMagic[8] = "HTTPCCH";
+    constexpr std::uint32_t g_nVersion = 1;
+    const std::string g_strSuffix = ".cache";
+
+    bool writeAll(const int nFd, const void * pData, size_t nSize)
+    {
+        const char * pBytes = static_cast<const char *>(pData);
+        while(nSize > 0){
+            const ssize_t nWritten = write(nFd, pBytes, nSize);
+            if(nWritten < 0){
+                if(EINTR == errno)
+                    continue;
+                return false;
+            }
+
+            pBytes += nWritten;
+            nSize -= static_cast<size_t>(nWritten);
+        }
+
+        return true;
+    }
+
+    bool readAll(const int nFd, void * pData, size_t nSize)
+    {
+        char * pBytes = static_cast<char *>(pData);
+        while(nSize > 0){
+            const ssize_t nRead = read(nFd, pBytes, nSize);
+            if(nRead < 0 && EINTR == errno)
+                continue;
+            if(nRead <= 0)
+                return false;
+
+            pBytes += nRead;
+            nSize -= static_cast<size_t>(nRead);
+        }
+
+        return true;
+    }
+
+    //FNV-1a, stable across the runs such the files being found again after restarting, unlike std::hash
+    std::uint64_t fnv1a(const std::string & strData)
+    {
+        std::uint64_t nHash = 14695981039346656037ULL;
+        for(const unsigned char ch : strData){
+            nHash ^= ch;
+            nHash *= 1099511628211ULL;
+        }
+        return nHash;
+    }
+
+    std::string trim(const std::string & strValue)
+    {
+        size_t nBegin = 0, nEnd = strValue.size();
+        while(nBegin < nEnd && isspace(static_cast<unsigned char>(strValue[nBegin])))
+            nBegin++;
+        while(nEnd > nBegin && isspace(static_cast<unsigned char>(strValue[nEnd - 1])))
+            nEnd--;
+        return strValue.substr(nBegin, nEnd - nBegin);
+    }
+
+    const std::string * findHeader(const std::unordered_map<std::string, std::string> & mpHeader, const std::string & strName)
+    {
+        auto iter = mpHeader.find(strName);
+        return mpHeader.end() == iter ? nullptr : &iter->second;
+    }
+
+    //the lowercase name of the header line [nBegin, nEnd), empty for the status line and the blank line
+    std::string lineName(const std::string & strHeader, const size_t nBegin, const size_t nEnd)
+    {
+        const size_t nColon = strHeader.find(':', nBegin);
+        if(std::string::npos == nColon || nColon >= nEnd || 0 == strHeader.compare(nBegin, 5, "HTTP/"))
+            return std::string();
+
+        std::string strName = strHeader.substr(nBegin, nColon - nBegin);
+        for(auto & ch : strName)
+            ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+        return strName;
+    }
+
+    //call the handler with the name and the line [nBegin, nEnd) including '\n' for each header line of the raw headers
+    template<class Handler>
+    void forEachLine(const std::string & strHeader, Handler && handler)
+    {
+        size_t nBegin = 0;
+        while(nBegin < strHeader.size()){
+            size_t nEnd = strHeader.find('\n', nBegin);
+            nEnd = std::string::npos == nEnd ? strHeader.size() : nEnd + 1;
+            handler(lineName(strHeader, nBegin, nEnd), nBegin, nEnd);
+            nBegin = nEnd;
+        }
+    }
+
+    //the header fields describing the stored body, NOT being updated by a 304 as RFC 9111 section 3.2
+    bool isBodyHeader(const std::string & strName)
+    {
+        return "content-length" == strName || "content-encoding" == strName || "content-type" == strName
+               || "content-range" == strName || "transfer-encoding" == strName;
+    }
+
+    //the stored headers updated by the ones of the 304, the fields of the 304 replacing the stored ones of the same name
+    std::string mergeHeader(const std::string & strStored, const std::string & strNotModified)
+    {
+        std::vector<std::string> vecNames;
+        std::string strUpdates;
+        forEachLine(strNotModified, [&](const std::string & strName, const size_t nBegin, const size_t nEnd){
+            if(strName.empty() || isBodyHeader(strName))
+                return ;
+            vecNames.emplace_back(strName);
+            strUpdates.append(strNotModified, nBegin, nEnd - nBegin);
+        });
+
+        std::string strMerged;
+        strMerged.reserve(strStored.size() + strUpdates.size());
+        forEachLine(strStored, [&](const std::string & strName, const size_t nBegin, const size_t nEnd){
+            if(strName.empty()){
+                //the status line kept, the blank line ending the headers being appended after the updates
+                if(0 == strStored.compare(nBegin, 5, "HTTP/"))
+                    strMerged.append(strStored, nBegin, nEnd - nBegin);
+                return ;
+            }
+            if(vecNames.end() == std::find(vecNames.begin(), vecNames.end(), strName))
+                strMerged.append(strStored, nBegin, nEnd - nBegin);
+        });
+        strMerged += strUpdates;
+        strMerged += "\r\n";
+
+        return strMerged;
+    }
+
+    //the lowercase names and the trimmed values, the same as CHTTPClient::getRespHeaders
+    std::unordered_map<std::string, std::string> parseHeader(const std::string & strHeader)
+    {
+        std::unordered_map<std::string, std::string> mpHeader;
+        forEachLine(strHeader, [&](const std::string & strName, const size_t nBegin, const size_t nEnd){
+            if(strName.empty())
+                return ;
+
+            const size_t nColon = strHeader.find(':', nBegin);
+            std::string & strValue = mpHeader[strName];
+            if(!strValue.empty())
+                strValue.append(", ");
+            strValue.append(trim(strHeader.substr(nColon + 1, nEnd - nColon - 1)));
+        });
+
+        return mpHeader;
+    }
+}
+
+CHTTPCache::CHTTPCache(const size_t nMaxBytes/*=64MiB*/, const std::string & strDiskDir/*=""*/, const size_t nMaxDiskBytes/*=1GiB*/)
+    : m_nMaxBytes(nMaxBytes), m_strDiskDir(strDiskDir), m_nMaxDiskBytes(nMaxDiskBytes)
+{
+    if(this->m_strDiskDir.empty())
+        return ;
+
+    if('/' != this->m_strDiskDir.back())
+        this->m_strDiskDir.push_back('/');
+
+    if(0 != mkdir(this->m_strDiskDir.c_str(), 0755) && EEXIST != errno){
+        this->m_strErrMsg = std::string("failed to create the cache directory ") + this->m_strDiskDir + std::string(":") + strerror(errno);
+        this->m_strDiskDir.clear();//memory only
+        return ;
+    }
+
+    this->loadDiskIndex();
+}
+
+std::pair<std::shared_ptr<const StHTTPCacheEntry>, bool> CHTTPCache::lookup(const std::string & strKey)
+{
+    const std::int64_t nNow = CHTTPCache::nowMs();
+    std::unique_lock<std::mutex> lock(this->m_mtx);
+
+    auto iter = this->m_mpMemory.find(strKey);
+    if(this->m_mpMemory.end() != iter){
+        this->m_lstMemoryLRU.splice(this->m_lstMemoryLRU.begin(), this->m_lstMemoryLRU, iter->second.iterLRU);
+
+        const bool bFresh = nNow < iter->second.nExpireMs;
+        bFresh ? this->m_stMetrics.nHits++ : this->m_stMetrics.nStale++;
+        return std::make_pair(iter->second.pEntry, bFresh);
+    }
+
+    const std::string && strFile = this->diskFile(strKey);
+    if(this->m_strDiskDir.empty() || this->m_mpDisk.end() == this->m_mpDisk.find(strFile)){
+        this->m_stMetrics.nMisses++;
+        return std::make_pair(nullptr, false);
+    }
+
+    lock.unlock();
+    std::int64_t nExpireMs = 0;
+    auto pEntry = this->readDisk(strKey, nExpireMs);
+    lock.lock();
+
+    //stored by another thread while reading, the newer one being served
+    iter = this->m_mpMemory.find(strKey);
+    if(this->m_mpMemory.end() != iter){
+        pEntry = iter->second.pEntry;
+        nExpireMs = iter->second.nExpireMs;
+        this->m_lstMemoryLRU.splice(this->m_lstMemoryLRU.begin(), this->m_lstMemoryLRU, iter->second.iterLRU);
+    }else if(pEntry){
+        auto iterDisk = this->m_mpDisk.find(strFile);
+        if(this->m_mpDisk.end() != iterDisk)
+            this->m_lstDiskLRU.splice(this->m_lstDiskLRU.begin(), this->m_lstDiskLRU, iterDisk->second.iterLRU);
+
+        this->m_stMetrics.nDiskHits++;
+        this->insertMemory(strKey, pEntry, nExpireMs);
+    }else{
+        //unreadable, or of another key colliding the hash, being dropped
+        this->unindexDisk(strFile);
+        this->m_stMetrics.nMisses++;
+        lock.unlock();
+
+        this->unlinkDisk({strFile});
+        return std::make_pair(nullptr, false);
+    }
+
+    const bool bFresh = nNow < nExpireMs;
+    bFresh ? this->m_stMetrics.nHits++ : this->m_stMetrics.nStale++;
+    return std::make_pair(pEntry, bFresh);
+}
+
+bool CHTTPCache::store(const std::string & strKey, const std::unordered_map<std::string, std::string> & mpHeader, const std::string & strHeader, const std::string & strBody)
+{
+    auto stEntry = std::make_shared<StHTTPCacheEntry>();
+    if(auto pValue = findHeader(mpHeader, "etag"))
+        stEntry->strETag = *pValue;
+    if(auto pValue = findHeader(mpHeader, "last-modified"))
+        stEntry->strLastModified = *pValue;
+
+    //NOT being revalidated without a validator, so useless when expired at once
+    const auto && nLifetime = CHTTPCache::freshLifetime(mpHeader);
+    if(!nLifetime.has_value() || (0 == *nLifetime && stEntry->strETag.empty() && stEntry->strLastModified.empty())){
+        this->remove(strKey);
+        return false;
+    }
+
+    stEntry->strHeader = strHeader;
+    stEntry->strBody = strBody;
+    const std::int64_t nExpireMs = CHTTPCache::nowMs() + *nLifetime;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_stMetrics.nStores++;
+        this->insertMemory(strKey, stEntry, nExpireMs);
+    }
+
+    this->persist(strKey, *stEntry, nExpireMs);
+    return true;
+}
+
+std::shared_ptr<const StHTTPCacheEntry> CHTTPCache::revalidated(const std::string & strKey, const StHTTPCacheEntry & stEntry, const std::string & strHeader)
+{
+    //the stored headers being updated by the 304 as RFC 9111 section 4.3.4, and so the validators and the lifetime
+    auto pEntry = std::make_shared<StHTTPCacheEntry>();
+    pEntry->strHeader = mergeHeader(stEntry.strHeader, strHeader);
+    pEntry->strBody = stEntry.strBody;
+
+    const auto && mpHeader = parseHeader(pEntry->strHeader);
+    if(auto pValue = findHeader(mpHeader, "etag"))
+        pEntry->strETag = *pValue;
+    if(auto pValue = findHeader(mpHeader, "last-modified"))
+        pEntry->strLastModified = *pValue;
+
+    const auto && nLifetime = CHTTPCache::freshLifetime(mpHeader);
+    if(!nLifetime.has_value()){
+        this->remove(strKey);
+        return pEntry;
+    }
+
+    const std::int64_t nExpireMs = CHTTPCache::nowMs() + *nLifetime;
+
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->m_stMetrics.nRevalidated++;
+        this->insertMemory(strKey, pEntry, nExpireMs);
+    }
+
+    //the headers being rewritten, so the file as well, the entries over m_nMaxBytes being served by it only
+    this->persist(strKey, *pEntry, nExpireMs);
+    return pEntry;
+}
+
+void CHTTPCache::remove(const std::string & strKey)
+{
+    const std::string && strFile = this->diskFile(strKey);
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        this->removeMemory(strKey);
+        if(this->m_strDiskDir.empty())
+            return ;
+
+        this->unindexDisk(strFile);
+    }
+
+    this->unlinkDisk({strFile});
+}
+
+void CHTTPCache::clear()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    this->m_mpMemory.clear();
+    this->m_lstMemoryLRU.clear();
+    this->m_stMetrics.nBytes = 0;
+}
+
+StHTTPCacheMetrics CHTTPCache::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StHTTPCacheMetrics stMetrics = this->m_stMetrics;
+    stMetrics.nEntries = this->m_mpMemory.size();
+    return stMetrics;
+}
+
+std::string CHTTPCache::getErrMsg() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    return this->m_strErrMsg;
+}
+
+std::optional<std::int64_t> CHTTPCache::freshLifetime(const std::unordered_map<std::string, std::string> & mpHeader)
+{
+    std::optional<std::int64_t> nMaxAge;
+    if(auto pValue = findHeader(mpHeader, "cache-control")){
+        size_t nBegin = 0;
+        while(nBegin <= pValue->size()){
+            size_t nEnd = pValue->find(',', nBegin);
+            if(std::string::npos == nEnd)
+                nEnd = pValue->size();
+
+            std::string strDirective = trim(pValue->substr(nBegin, nEnd - nBegin));
+            for(auto & ch : strDirective)
+                ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+
+            if("no-store" == strDirective)
+                return std::nullopt;
+            else if("no-cache" == strDirective)
+                nMaxAge = 0;
+            else if(0 == strDirective.compare(0, 8, "max-age=") && !nMaxAge.has_value())
+                nMaxAge = std::max<std::int64_t>(atoll(strDirective.c_str() + 8), 0) * 1000;
+
+            nBegin = nEnd + 1;
+        }
+    }
+
+    //'Expires' being relative to 'Date' of the server, such the clock skew NOT mattering
+    std::int64_t nLifetime = 0;
+    if(nMaxAge.has_value()){
+        nLifetime = *nMaxAge;
+    }else if(auto pValue = findHeader(mpHeader, "expires")){
+        const time_t nExpires = curl_getdate(pValue->c_str(), nullptr);
+        const std::string * pDate = findHeader(mpHeader, "date");
+        const time_t nDate = pDate ? curl_getdate(pDate->c_str(), nullptr) : static_cast<time_t>(CHTTPCache::nowMs() / 1000);
+        if(-1 != nExpires && -1 != nDate)
+            nLifetime = (static_cast<std::int64_t>(nExpires) - static_cast<std::int64_t>(nDate)) * 1000;
+    }
+
+    //the time having been spent in the caches on the way
+    if(auto pValue = findHeader(mpHeader, "age"))
+        nLifetime -= std::max<std::int64_t>(atoll(pValue->c_str()), 0) * 1000;
+
+    return std::max<std::int64_t>(nLifetime, 0);
+}
+
+void CHTTPCache::insertMemory(const std::string & strKey, std::shared_ptr<const StHTTPCacheEntry> pEntry, const std::int64_t nExpireMs)
+{
+    this->removeMemory(strKey);
+
+    const size_t nSize = strKey.size() + pEntry->strHeader.size() + pEntry->strBody.size() + pEntry->strETag.size() + pEntry->strLastModified.size();
+    if(nSize > this->m_nMaxBytes)
+        return ;//being served by the disk tier only
+
+    while(this->m_stMetrics.nBytes + nSize > this->m_nMaxBytes && !this->m_lstMemoryLRU.empty()){
+        this->removeMemory(this->m_lstMemoryLRU.back());
+        this->m_stMetrics.nEvictions++;
+    }
+
+    this->m_lstMemoryLRU.push_front(strKey);
+    StMemEntry & stMem = this->m_mpMemory[strKey];
+    stMem.pEntry = std::move(pEntry);
+    stMem.nExpireMs = nExpireMs;
+    stMem.nSize = nSize;
+    stMem.iterLRU = this->m_lstMemoryLRU.begin();
+    this->m_stMetrics.nBytes += nSize;
+}
+
+void CHTTPCache::removeMemory(const std::string & strKey)
+{
+    auto iter = this->m_mpMemory.find(strKey);
+    if(this->m_mpMemory.end() == iter)
+        return ;
+
+    this->m_stMetrics.nBytes -= iter->second.nSize;
+    this->m_lstMemoryLRU.erase(iter->second.iterLRU);
+    this->m_mpMemory.erase(iter);
+}
+
+//written into the temporary file and renamed, such the readers never seeing a partial file, NOT being synced for a cache,
+//return the size of the file
+std::optional<size_t> CHTTPCache::writeDisk(const std::string & strKey, const StHTTPCacheEntry & stEntry, const std::int64_t nExpireMs, std::string & strErrMsg)
+{
+    StDiskHeader stHeader{};
+    memcpy(stHeader.szMagic, g_szMagic, sizeof(stHeader.szMagic));
+    stHeader.nVersion = g_nVersion;
+    stHeader.nKeySize = static_cast<std::uint32_t>(strKey.size());
+    stHeader.nETagSize = static_cast<std::uint32_t>(stEntry.strETag.size());
+    stHeader.nLastModifiedSize = static_cast<std::uint32_t>(stEntry.strLastModified.size());
+    stHeader.nHeaderSize = stEntry.strHeader.size();
+    stHeader.nBodySize = stEntry.strBody.size();
+    stHeader.nExpireMs = nExpireMs;
+
+    const std::string && strPath = this->m_strDiskDir + this->diskFile(strKey);
+    const std::string && strTempPath = strPath + std::string(".") + std::to_string(++this->m_nTempSeq) + std::string(".tmp");
+    const int nFd = open(strTempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(-1 == nFd){
+        strErrMsg = std::string("failed to create ") + strTempPath + std::string(":") + strerror(errno);
+        return std::nullopt;
+    }
+
+    bool bOK = writeAll(nFd, &stHeader, sizeof(stHeader))
+               && writeAll(nFd, strKey.data(), strKey.size())
+               && writeAll(nFd, stEntry.strETag.data(), stEntry.strETag.size())
+               && writeAll(nFd, stEntry.strLastModified.data(), stEntry.strLastModified.size())
+               && writeAll(nFd, stEntry.strHeader.data(), stEntry.strHeader.size())
+               && writeAll(nFd, stEntry.strBody.data(), stEntry.strBody.size());
+    close(nFd);
+
+    if(bOK && 0 != rename(strTempPath.c_str(), strPath.c_str()))
+        bOK = false;
+
+    if(!bOK){
+        strErrMsg = std::string("failed to write ") + strPath + std::string(":") + strerror(errno);
+        unlink(strTempPath.c_str());
+        return std::nullopt;
+    }
+
+    return sizeof(stHeader) + strKey.size() + stEntry.strETag.size() + stEntry.strLastModified.size() + stEntry.strHeader.size() + stEntry.strBody.size();
+}
+
+//the file written being indexed, replacing the one of the same key, the files over the budget being unindexed and
+//returned, to be unlinked without the lock
+std::vector<std::string> CHTTPCache::indexDisk(const std::string & strFile, const size_t nSize)
+{
+    auto iter = this->m_mpDisk.find(strFile);
+    if(this->m_mpDisk.end() != iter){
+        this->m_stMetrics.nDiskBytes -= iter->second.nSize;
+        this->m_lstDiskLRU.erase(iter->second.iterLRU);
+        this->m_mpDisk.erase(iter);
+    }
+
+    std::vector<std::string> vecEvicted;
+    while(this->m_stMetrics.nDiskBytes + nSize > this->m_nMaxDiskBytes && !this->m_lstDiskLRU.empty()){
+        vecEvicted.emplace_back(this->m_lstDiskLRU.back());
+        this->unindexDisk(vecEvicted.back());
+    }
+
+    this->m_lstDiskLRU.push_front(strFile);
+    this->m_mpDisk[strFile] = StDiskEntry{nSize, this->m_lstDiskLRU.begin()};
+    this->m_stMetrics.nDiskBytes += nSize;
+
+    //the file being kept for a single entry over the budget, being evicted by the next one
+    return vecEvicted;
+}
+
+//nullptr when the file being missing, broken or of another key
+std::shared_ptr<const StHTTPCacheEntry> CHTTPCache::readDisk(const std::string & strKey, std::int64_t & nExpireMs) const
+{
+    const std::string && strPath = this->m_strDiskDir + this->diskFile(strKey);
+    const int nFd = open(strPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if(-1 == nFd)
+        return nullptr;
+
+    struct stat stStat{};
+    StDiskHeader stHeader{};
+    bool bOK = 0 == fstat(nFd, &stStat) && readAll(nFd, &stHeader, sizeof(stHeader))
+               && 0 == memcmp(stHeader.szMagic, g_szMagic, sizeof(g_szMagic)) && g_nVersion == stHeader.nVersion
+               && static_cast<std::uint64_t>(stStat.st_size) == sizeof(stHeader) + stHeader.nKeySize + stHeader.nETagSize
+                                                                + stHeader.nLastModifiedSize + stHeader.nHeaderSize + stHeader.nBodySize;
+
+    //the key being compared, the hash of the file name possibly colliding
+    std::string strFileKey;
+    auto pEntry = std::make_shared<StHTTPCacheEntry>();
+    if(bOK){
+        strFileKey.resize(stHeader.nKeySize);
+        pEntry->strETag.resize(stHeader.nETagSize);
+        pEntry->strLastModified.resize(stHeader.nLastModifiedSize);
+        pEntry->strHeader.resize(stHeader.nHeaderSize);
+        pEntry->strBody.resize(stHeader.nBodySize);
+        bOK = readAll(nFd, strFileKey.data(), strFileKey.size())
+              && readAll(nFd, pEntry->strETag.data(), pEntry->strETag.size())
+              && readAll(nFd, pEntry->strLastModified.data(), pEntry->strLastModified.size())
+              && readAll(nFd, pEntry->strHeader.data(), pEntry->strHeader.size())
+              && readAll(nFd, pEntry->strBody.data(), pEntry->strBody.size());
+    }
+    close(nFd);
+
+    if(!bOK || strFileKey != strKey)
+        return nullptr;
+
+    nExpireMs = stHeader.nExpireMs;
+    return pEntry;
+}
+
+//the expiry in the header being rewritten in place, the file of another key colliding the hash being left
+void CHTTPCache::persist(const std::string & strKey, const StHTTPCacheEntry & stEntry, const std::int64_t nExpireMs)
+{
+    if(this->m_strDiskDir.empty())
+        return ;
+
+    //the file being written without the lock, and indexed after
+    std::string strErrMsg;
+    const auto && nSize = this->writeDisk(strKey, stEntry, nExpireMs, strErrMsg);
+
+    std::vector<std::string> vecEvicted;
+    {
+        std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+        if(!nSize.has_value()){
+            this->m_strErrMsg = strErrMsg;
+            return ;
+        }
+
+        vecEvicted = this->indexDisk(this->diskFile(strKey), *nSize);
+    }
+
+    this->unlinkDisk(vecEvicted);
+}
+
+void CHTTPCache::unlinkDisk(const std::vector<std::string> & vecFiles) const
+{
+    for(const auto & strFile : vecFiles)
+        unlink((this->m_strDiskDir + strFile).c_str());
+}
+
+void CHTTPCache::unindexDisk(const std::string & strFile)
+{
+    auto iter = this->m_mpDisk.find(strFile);
+    if(this->m_mpDisk.end() == iter)
+        return ;
+
+    this->m_stMetrics.nDiskBytes -= iter->second.nSize;
+    this->m_lstDiskLRU.erase(iter->second.iterLRU);
+    this->m_mpDisk.erase(iter);
+}
+
+//the files of the last run being indexed by their modification time, the most recent at the front
+void CHTTPCache::loadDiskIndex()
+{
+    DIR * pDir = opendir(this->m_strDiskDir.c_str());
+    if(nullptr == pDir){
+        this->m_strErrMsg = std::string("failed to open the cache directory ") + this->m_strDiskDir + std::string(":") + strerror(errno);
+        this->m_strDiskDir.clear();
+        return ;
+    }
+
+    std::vector<std::pair<time_t, std::pair<std::string, size_t>>> vecFiles;
+    while(dirent * pItem = readdir(pDir)){
+        const std::string strFile(pItem->d_name);
+        struct stat stStat{};
+        if(0 != stat((this->m_strDiskDir + strFile).c_str(), &stStat) || !S_ISREG(stStat.st_mode))
+            continue;
+
+        if(strFile.size() > g_strSuffix.size() && 0 == strFile.compare(strFile.size() - g_strSuffix.size(), g_strSuffix.size(), g_strSuffix))
+            vecFiles.emplace_back(stStat.st_mtime, std::make_pair(strFile, static_cast<size_t>(stStat.st_size)));
+        else if(strFile.size() > 4 && 0 == strFile.compare(strFile.size() - 4, 4, ".tmp"))
+            unlink((this->m_strDiskDir + strFile).c_str());//left by a crash
+    }
+    closedir(pDir);
+
+    std::sort(vecFiles.begin(), vecFiles.end());
+    for(auto & item : vecFiles){
+        this->m_lstDiskLRU.push_front(item.second.first);
+        this->m_mpDisk[item.second.first] = StDiskEntry{item.second.second, this->m_lstDiskLRU.begin()};
+        this->m_stMetrics.nDiskBytes += item.second.second;
+    }
+
+    while(this->m_stMetrics.nDiskBytes > this->m_nMaxDiskBytes && !this->m_lstDiskLRU.empty()){
+        const std::string strFile = this->m_lstDiskLRU.back();
+        this->unindexDisk(strFile);
+        this->unlinkDisk({strFile});
+    }
+}
+
+std::string CHTTPCache::diskFile(const std::string & strKey) const
+{
+    char szName[32] = {0};
+    snprintf(szName, sizeof(szName), "%016llx", static_cast<unsigned long long>(fnv1a(strKey)));
+    return std::string(szName) + g_strSuffix;
+}
+
+std::int64_t CHTTPCache::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
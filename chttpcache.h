@@ -0,0 +1,132 @@
+#ifndef CHTTPCACHE_H
+#define CHTTPCACHE_H
+
+/*
+ * CHTTPCache keeps the responses of GET in memory, bounded by the bytes and evicted by LRU, with an optional tier
+ * on the disk surviving the restarts, which being bounded and evicted by LRU as well.
+ *
+ * The freshness being decided by 'Cache-Control: max-age', or 'Expires' against 'Date', 'no-cache' making the
+ * response being revalidated each time, 'no-store' making it never being cached. The stale responses being
+ * revalidated by CHTTPClient with 'If-None-Match' or 'If-Modified-Since', and a 304 serving the cached body
+ * without transferring it again. The responses having neither a lifetime nor a validator NOT being cached.
+ *
+ * Thread-safe, such a cache being shared by the clients of all the threads, by CHTTPClient::setCache. The files of
+ * the disk tier being read, written and unlinked without the lock, which guarding the index only, such the lookups
+ * served from the memory NOT waiting for the disk.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+typedef struct ST_httpCacheEntry{
+    std::string strHeader;//the raw headers of the response
+    std::string strBody;
+    std::string strETag;
+    std::string strLastModified;
+}StHTTPCacheEntry;
+
+typedef struct ST_httpCacheMetrics{
+    std::uint64_t nHits = 0;            //fresh, served without a request
+    std::uint64_t nRevalidated = 0;     //stale, served by a 304
+    std::uint64_t nStale = 0;           //stale, being revalidated
+    std::uint64_t nMisses = 0;
+    std::uint64_t nDiskHits = 0;        //loaded from the disk tier, being counted in the above as well
+    std::uint64_t nStores = 0;
+    std::uint64_t nEvictions = 0;
+    size_t nEntries = 0;
+    size_t nBytes = 0;
+    size_t nDiskBytes = 0;
+
+    //the lookups served from the cache, with or without the revalidation
+    double hitRate() const{
+        const std::uint64_t nLookups = this->nHits + this->nStale + this->nMisses;
+        return 0 == nLookups ? 0.0 : static_cast<double>(this->nHits + this->nRevalidated) / static_cast<double>(nLookups);
+    }
+}StHTTPCacheMetrics;
+
+class CHTTPCache
+{
+public:
+    //strDiskDir being empty for the memory only, otherwise being created when NOT existing
+    explicit CHTTPCache(const size_t nMaxBytes = 64 * 1024 * 1024, const std::string & strDiskDir = "", const size_t nMaxDiskBytes = 1024 * 1024 * 1024);
+    ~CHTTPCache() = default;
+
+    //copy constructor and assignment operator prohibited
+    CHTTPCache(const CHTTPCache & ) = delete;
+    CHTTPCache(const CHTTPCache && ) = delete;
+    CHTTPCache & operator=(const CHTTPCache &) = delete;
+    CHTTPCache & operator=(const CHTTPCache &&) = delete;
+
+    //the entry and whether it being fresh, nullptr on miss, the entry being immutable and shared with the cache
+    std::pair<std::shared_ptr<const StHTTPCacheEntry>, bool> lookup(const std::string & strKey);
+
+    //cache the response of 200, the headers being the lowercase names as CHTTPClient::getRespHeaders,
+    //return false when the response NOT being cacheable, the entry of the key being removed then
+    bool store(const std::string & strKey, const std::unordered_map<std::string, std::string> & mpHeader, const std::string & strHeader, const std::string & strBody);
+
+    //the entry being fresh again by the raw headers of the 304, which updating the stored headers, the validators and
+    //the lifetime, return the updated entry to be served
+    std::shared_ptr<const StHTTPCacheEntry> revalidated(const std::string & strKey, const StHTTPCacheEntry & stEntry, const std::string & strHeader);
+
+    void remove(const std::string & strKey);
+    void clear();//the memory only, the disk tier being kept
+
+    StHTTPCacheMetrics getMetrics() const;
+    std::string getErrMsg() const;//a copy, being written by the threads storing
+
+    //the lifetime in milliseconds by the headers, std::nullopt for 'no-store'
+    static std::optional<std::int64_t> freshLifetime(const std::unordered_map<std::string, std::string> & mpHeader);
+
+private:
+    typedef struct ST_memEntry{
+        std::shared_ptr<const StHTTPCacheEntry> pEntry;
+        std::int64_t nExpireMs = 0;//since the epoch
+        size_t nSize = 0;
+        std::list<std::string>::iterator iterLRU;
+    }StMemEntry;
+
+    typedef struct ST_diskEntry{
+        size_t nSize = 0;
+        std::list<std::string>::iterator iterLRU;
+    }StDiskEntry;
+
+    //all with m_mtx held
+    void insertMemory(const std::string & strKey, std::shared_ptr<const StHTTPCacheEntry> pEntry, const std::int64_t nExpireMs);
+    void removeMemory(const std::string & strKey);
+    std::vector<std::string> indexDisk(const std::string & strFile, const size_t nSize);//return the files evicted
+    void unindexDisk(const std::string & strFile);
+    void loadDiskIndex();
+    std::string diskFile(const std::string & strKey) const;
+
+    //the disk I/O, all without m_mtx, such the lookups of the other keys NOT waiting for the disk
+    std::optional<size_t> writeDisk(const std::string & strKey, const StHTTPCacheEntry & stEntry, const std::int64_t nExpireMs, std::string & strErrMsg);
+    std::shared_ptr<const StHTTPCacheEntry> readDisk(const std::string & strKey, std::int64_t & nExpireMs) const;
+    void unlinkDisk(const std::vector<std::string> & vecFiles) const;
+    void persist(const std::string & strKey, const StHTTPCacheEntry & stEntry, const std::int64_t nExpireMs);//written and indexed
+
+    static std::int64_t nowMs();
+
+private:
+    std::string m_strErrMsg;
+    size_t m_nMaxBytes;
+    std::string m_strDiskDir;
+    size_t m_nMaxDiskBytes;
+
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::string, StMemEntry> m_mpMemory;
+    std::list<std::string> m_lstMemoryLRU;//the most recent at the front
+    std::unordered_map<std::string, StDiskEntry> m_mpDisk;//by the file name
+    std::list<std::string> m_lstDiskLRU;
+    StHTTPCacheMetrics m_stMetrics;
+    std::atomic<std::uint64_t> m_nTempSeq{0};//the temporary files of the same key written at once NOT colliding
+};
+
+#endif // CHTTPCACHE_H
@@ -1,8 +1,25 @@
 #include "chttpclient.h"
 
 #include "cresourceinit.h"
+#include "ccurlshare.h"
+#include "cdnscache.h"
+#include "chttpcache.h"
+#include "chttpretrypolicy.h"
+#include "chttpmetrics.h"
+#include "chttphostlimiter.h"
 
-#include <iostream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <cstring>
+#include <cerrno>
+#include <cctype>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <thread>
+
+#include <zlib.h>
 
 enum HTPPCode{
     EN_HTTPS_OK = 0,
@@ -20,13 +37,29 @@ static hash_map<HTPPCode, std::string> g_mpHttpsErrMsg = {
     std::pair<HTPPCode, std::string>{EN_HTTPS_LAST, std::string("Such the enum being meaningless")}
 };
 
+//the state of the streamed gzip, shared by the copies of the reader
+typedef struct ST_gzipState{
+    z_stream stStream{};
+    bool bInit = false;
+    bool bInputEnd = false;
+    bool bDone = false;
+    size_t nDeferred = 0;//CURL_READFUNC_PAUSE or CURL_READFUNC_ABORT of the reader, being returned on the next call
+    std::vector<char> vecInput = std::vector<char>(CURL_MAX_WRITE_SIZE);
+
+    ~ST_gzipState(){
+        if(this->bInit)
+            deflateEnd(&this->stStream);
+    }
+}StGzipState;
+
 
-CHTTPClient::CHTTPClient(const std::string & strIp, const std::uint16_t nPort, const HTTPMode enMode) : m_pCurl(nullptr, &curl_easy_cleanup)
+//the handle being borrowed from the warm pool sharing the DNS cache, the TLS sessions and the connections, and given back on destruction
+CHTTPClient::CHTTPClient(const std::string & strIp, const std::uint16_t nPort, const HTTPMode enMode) : m_pCurl(nullptr, &CCurlShare::release)
 {
     if(!CResourceInit::init())
         this->m_strErrMsg = CResourceInit::getErrMsg();
     else
-        this->m_pCurl.reset(curl_easy_init());
+        this->m_pCurl.reset(CCurlShare::acquire());
 
     this->m_strIp = strIp;
     this->m_nPort = nPort;
@@ -46,57 +79,1073 @@ CHTTPClient & CHTTPClient::setPort(const std::uint16_t nPort)
     return *this;
 }
 
+CHTTPClient & CHTTPClient::setHTTPVersion(const HTTPVersion enVersion)
+{
+    this->m_enVersion = enVersion;
+    return *this;
+}
+
+long CHTTPClient::toCurlVersion(const HTTPVersion enVersion)
+{
+    switch(enVersion){
+    case _EN_HTTP_2_TLS_:
+        return CURL_HTTP_VERSION_2TLS;
+    case _EN_HTTP_2_PRIOR_KNOWLEDGE_:
+        return CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+    default:
+        return CURL_HTTP_VERSION_1_1;
+    }
+}
+
+CHTTPClient::bodySink CHTTPClient::toBuffer(char * pBuffer, const size_t nCapacity, size_t & nWritten)
+{
+    nWritten = 0;
+    return [pBuffer, nCapacity, &nWritten](const char * pData, const size_t nSize){
+        if(nSize > nCapacity - nWritten)
+            return false;
+
+        memcpy(pBuffer + nWritten, pData, nSize);
+        nWritten += nSize;
+        return true;
+    };
+}
+
+CHTTPClient::bodySink CHTTPClient::toFd(const int nFd)
+{
+    return [nFd](const char * pData, const size_t nSize){
+        size_t nDone = 0;
+        while(nDone < nSize){
+            const ssize_t nRet = write(nFd, pData + nDone, nSize - nDone);
+            if(nRet < 0 && EINTR == errno)
+                continue;
+            if(nRet <= 0)
+                return false;
+            nDone += static_cast<size_t>(nRet);
+        }
+        return true;
+    };
+}
+
+CHTTPClient & CHTTPClient::setAcceptEncoding(const std::optional<std::string> & strEncodings)
+{
+    this->m_strAcceptEncoding = strEncodings;
+    return *this;
+}
+
+CHTTPClient & CHTTPClient::setGzipBody(const bool bGzip, const size_t nMinSize/*=1024*/, const int nLevel/*=6*/)
+{
+    this->m_bGzipBody = bGzip;
+    this->m_nGzipMinSize = nMinSize;
+    this->m_nGzipLevel = std::clamp(nLevel, 1, 9);
+    return *this;
+}
+
+CHTTPClient & CHTTPClient::setCache(CHTTPCache * pCache)
+{
+    this->m_pCache = pCache;
+    return *this;
+}
+
+CHTTPClient & CHTTPClient::setRetryPolicy(CHTTPRetryPolicy * pPolicy)
+{
+    this->m_pRetryPolicy = pPolicy;
+    return *this;
+}
+
+CHTTPClient & CHTTPClient::setMetrics(CHTTPMetrics * pMetrics)
+{
+    this->m_pMetrics = pMetrics;
+    return *this;
+}
+
+CHTTPClient & CHTTPClient::setDnsCache(CDnsCache * pDnsCache)
+{
+    this->m_pDnsCache = pDnsCache;
+    return *this;
+}
+
+CHTTPClient & CHTTPClient::setLimiter(CHTTPHostLimiter * pLimiter)
+{
+    this->m_pLimiter = pLimiter;
+    return *this;
+}
+
+std::optional<long> CHTTPClient::getLimitWaitMs() const
+{
+    return this->m_nLimitWaitMs;
+}
+
 std::optional<std::string> CHTTPClient::get(const std::string & strURL)
 {
-    if(strURL.empty()){
+    if(!this->generalSetting(strURL))
+        return std::nullopt;
+
+    if(this->m_pCache)
+        return this->cachedGet(strURL);
+
+    return this->performIdempotent();
+}
+
+std::optional<long> CHTTPClient::get(const std::string & strURL, bodySink sink)
+{
+    if(!sink){
         this->m_strErrMsg = g_mpHttpsErrMsg[EN_HTTPS_INVALID_INPUT_ARGS];
         return std::nullopt;
     }
 
+    if(!this->generalSetting(strURL) || !this->perform(sink))
+        return std::nullopt;
+
+    return this->getRespCode();
+}
+
+std::optional<curl_off_t> CHTTPClient::download(const std::string & strURL, const std::string & strPath, const size_t nRanges/*=4*/, const size_t nMaxRetries/*=3*/)
+{
+    if(strPath.empty() || !this->generalSetting(strURL)){
+        if(strPath.empty())
+            this->m_strErrMsg = g_mpHttpsErrMsg[EN_HTTPS_INVALID_INPUT_ARGS];
+        return std::nullopt;
+    }
+
+    //the ranges being of the bytes as stored, NOT of the encoded representation, and the 3 secs timeout NOT fitting
+    //a large file, the transfer stalling for 10 secs being aborted instead
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_ACCEPT_ENCODING, nullptr);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_TIMEOUT_MS, 0L);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_LOW_SPEED_TIME, 10L);
+
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_NOBODY, 1L);
+    if(!this->perform().has_value())
+        return std::nullopt;
+
+    curl_off_t nLength = -1;
+    curl_easy_getinfo(this->m_pCurl.get(), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &nLength);
+    const std::string && strAcceptRanges = this->getRespHeader("accept-ranges").value_or("");
+    const bool bRanges = 200 == this->m_nRespCode && nLength > 0 && std::string::npos != strAcceptRanges.find("bytes");
+
+    //a range being 1MiB at least, such the small files NOT paying for the connections
+    constexpr curl_off_t nMinRangeSize = 1024 * 1024;
+    const size_t nCount = bRanges ? static_cast<size_t>(std::clamp<curl_off_t>(nLength / nMinRangeSize, 1, static_cast<curl_off_t>(std::max<size_t>(nRanges, 1)))) : 1;
+
+    const int nFd = open(strPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(-1 == nFd){
+        this->m_strErrMsg = std::string("failed to create ") + strPath + std::string(":") + strerror(errno);
+        return std::nullopt;
+    }
+
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_NOBODY, 0L);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPGET, 1L);
+
+    bool bOK = false;
+    if(nCount > 1){
+        //the blocks being allocated at once rather than by the writes scattered, and the disk full being found before downloading
+        const int nRet = posix_fallocate(nFd, 0, static_cast<off_t>(nLength));
+        if(0 != nRet && EOPNOTSUPP != nRet && EINVAL != nRet){
+            this->m_strErrMsg = std::string("failed to preallocate ") + strPath + std::string(":") + strerror(nRet);
+        }else{
+            bOK = (0 == nRet || 0 == ftruncate(nFd, static_cast<off_t>(nLength)))
+                  && this->downloadRanges(nFd, nLength, nCount, nMaxRetries);
+        }
+    }else{
+        this->m_strRespHeader.clear();
+        bodySink sink = CHTTPClient::toFd(nFd);
+        bOK = this->perform(sink);
+        if(bOK && 200 != this->m_nRespCode){
+            this->m_strErrMsg = std::string("such the response code being ") + std::to_string(this->m_nRespCode);
+            bOK = false;
+        }
+    }
+
+    close(nFd);
+    if(!bOK){
+        unlink(strPath.c_str());
+        return std::nullopt;
+    }
+
+    return nCount > 1 ? nLength : this->m_stStats.nDownloadBody;
+}
+
+std::optional<std::string> CHTTPClient::post(const std::string & strURL, const std::string_view strData)
+{
+    std::string strGzipped;
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> pHeaders(nullptr, &curl_slist_free_all);
+    if(!this->generalSetting(strURL) || !this->setBody(strData, strGzipped, pHeaders))
+        return std::nullopt;
+
+    auto && strRet = this->perform();
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, nullptr);//pHeaders being freed
+    return strRet;
+}
+
+std::optional<std::string> CHTTPClient::put(const std::string & strURL, const std::string_view strData)
+{
+    std::string strGzipped;
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> pHeaders(nullptr, &curl_slist_free_all);
+    if(!this->generalSetting(strURL) || !this->setBody(strData, strGzipped, pHeaders))
+        return std::nullopt;
+
+    //same as post but the method, rather than CURLOPT_UPLOAD which copying the body into the upload buffer by the read callback
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_CUSTOMREQUEST, "PUT");
+
+    auto && strRet = this->perform();
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, nullptr);//pHeaders being freed
+    return strRet;
+}
+
+std::optional<std::string> CHTTPClient::post(const std::string & strURL, bodyReader reader, const std::optional<curl_off_t> nContentLength/*=std::nullopt*/)
+{
+    return this->sendStream(strURL, false, reader, nContentLength);
+}
+
+std::optional<std::string> CHTTPClient::put(const std::string & strURL, bodyReader reader, const std::optional<curl_off_t> nContentLength/*=std::nullopt*/)
+{
+    return this->sendStream(strURL, true, reader, nContentLength);
+}
+
+std::optional<std::string> CHTTPClient::head(const std::string & strURL)
+{
+    if(!this->generalSetting(strURL))
+        return std::nullopt;
+
+    //no body being read, neither the write callback being invoked
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_NOBODY, 1L);
+
+    if(!this->performIdempotent().has_value())
+        return std::nullopt;
+
+    return this->m_strRespHeader;
+}
+
+long CHTTPClient::getRespCode() const
+{
+    return this->m_nRespCode;
+}
+
+const std::string & CHTTPClient::getRespHeader() const
+{
+    return this->m_strRespHeader;
+}
+
+const std::unordered_map<std::string, std::string> & CHTTPClient::getRespHeaders()
+{
+    if(this->m_bRespHeaderParsed)
+        return this->m_mpRespHeader;
+
+    this->m_bRespHeaderParsed = true;
+    this->m_mpRespHeader.clear();
+
+    //the status line skipped, "name: value" each line, the values being trimmed
+    const std::string & strHeader = this->m_strRespHeader;
+    size_t nBegin = strHeader.find('\n');
+    while(std::string::npos != nBegin && nBegin < strHeader.size()){
+        nBegin++;
+        size_t nEnd = strHeader.find('\n', nBegin);
+        if(std::string::npos == nEnd)
+            nEnd = strHeader.size();
+
+        const size_t nColon = strHeader.find(':', nBegin);
+        if(std::string::npos != nColon && nColon < nEnd){
+            std::string strName = strHeader.substr(nBegin, nColon - nBegin);
+            for(auto & ch : strName)
+                ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+
+            size_t nValueBegin = nColon + 1;
+            size_t nValueEnd = nEnd;
+            while(nValueBegin < nValueEnd && (' ' == strHeader[nValueBegin] || '\t' == strHeader[nValueBegin]))
+                nValueBegin++;
+            while(nValueEnd > nValueBegin && isspace(static_cast<unsigned char>(strHeader[nValueEnd - 1])))
+                nValueEnd--;
+
+            std::string & strValue = this->m_mpRespHeader[strName];
+            if(!strValue.empty())
+                strValue.append(", ");
+            strValue.append(strHeader, nValueBegin, nValueEnd - nValueBegin);
+        }
+
+        nBegin = nEnd;
+    }
+
+    return this->m_mpRespHeader;
+}
+
+std::optional<std::string> CHTTPClient::getRespHeader(const std::string & strName)
+{
+    std::string strKey = strName;
+    for(auto & ch : strKey)
+        ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+
+    const auto & mpHeader = this->getRespHeaders();
+    auto iter = mpHeader.find(strKey);
+    if(mpHeader.end() == iter)
+        return std::nullopt;
+
+    return iter->second;
+}
+
+const StHTTPTransferStats & CHTTPClient::getStats() const
+{
+    return this->m_stStats;
+}
+
+void CHTTPClient::readTransferInfo(CURL * pCurl, StHTTPTransferStats & stStats)
+{
+    curl_easy_getinfo(pCurl, CURLINFO_SIZE_DOWNLOAD_T, &stStats.nDownloadWire);
+    curl_easy_getinfo(pCurl, CURLINFO_SIZE_UPLOAD_T, &stStats.nUploadWire);
+    curl_easy_getinfo(pCurl, CURLINFO_NAMELOOKUP_TIME_T, &stStats.nNameLookupUs);
+    curl_easy_getinfo(pCurl, CURLINFO_CONNECT_TIME_T, &stStats.nConnectUs);
+    curl_easy_getinfo(pCurl, CURLINFO_APPCONNECT_TIME_T, &stStats.nAppConnectUs);
+    curl_easy_getinfo(pCurl, CURLINFO_STARTTRANSFER_TIME_T, &stStats.nStartTransferUs);
+    curl_easy_getinfo(pCurl, CURLINFO_TOTAL_TIME_T, &stStats.nTotalTimeUs);
+    curl_easy_getinfo(pCurl, CURLINFO_NUM_CONNECTS, &stStats.nNewConnects);
+}
+
+std::optional<std::string> CHTTPClient::gzip(const std::string_view strData, const int nLevel/*=6*/)
+{
+    //windowBits 15 + 16 for the gzip wrapper rather than the zlib one
+    z_stream stStream{};
+    if(Z_OK != deflateInit2(&stStream, nLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY))
+        return std::nullopt;
+
+    std::string strOut(deflateBound(&stStream, static_cast<uLong>(strData.size())), '\0');
+    stStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(strData.data()));
+    stStream.avail_in = static_cast<uInt>(strData.size());
+    stStream.next_out = reinterpret_cast<Bytef *>(strOut.data());
+    stStream.avail_out = static_cast<uInt>(strOut.size());
+
+    const int nRet = deflate(&stStream, Z_FINISH);
+    strOut.resize(stStream.total_out);
+    deflateEnd(&stStream);
+
+    if(Z_STREAM_END != nRet)
+        return std::nullopt;
+
+    return strOut;
+}
+
+const std::string & CHTTPClient::getErrMsg() const
+{
+    return this->m_strErrMsg;
+}
+
+
+std::string CHTTPClient::getIp_Port()
+{
+    const std::string && strProtocol = (this->m_enMode == _EN_HTTPS_) ? std::string("https://") : std::string("http://");
+    return strProtocol + this->m_strIp + std::string(":") + std::to_string(this->m_nPort);
+}
+
+bool CHTTPClient::generalSetting(const std::string & strURL)
+{
+    if(strURL.empty()){
+        this->m_strErrMsg = g_mpHttpsErrMsg[EN_HTTPS_INVALID_INPUT_ARGS];
+        return false;
+    }
+
     if(!this->m_pCurl){
         this->m_strErrMsg = g_mpHttpsErrMsg[EN_FTTPS_RESOURCE_INIT_ERROR];
-        return std::nullopt;
+        return false;
     }
 
-    const std::string && strDestURL = this->getIp_Port() + std::string("/") + strURL;
-    std::string strResponse;
-    std::string strHeader;
+    //the options of the last request, such as CURLOPT_NOBODY and CURLOPT_UPLOAD, being cleared
+    curl_easy_reset(this->m_pCurl.get());
+
+    this->m_strRespHeader.clear();
+    this->m_mpRespHeader.clear();
+    this->m_bRespHeaderParsed = false;
+    this->m_stStats = StHTTPTransferStats();
+    this->m_nRespCode = 0;
+    this->m_nLimitWaitMs.reset();
 
+    const std::string && strDestURL = this->getIp_Port() + std::string("/") + strURL;
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_URL, strDestURL.c_str());
-    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_WRITEFUNCTION, CHTTPClient::readRespCallback);
-    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_WRITEDATA, &strResponse);
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_TIMEOUT_MS, 3000);//timeout for 3 secs in all
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_CONNECTTIMEOUT_MS, 1000);//connection timeout for 1 sec
-    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HEADERFUNCTION, CHTTPClient::readRespCallback);
-    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HEADERDATA, &strHeader);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HEADERFUNCTION, CHTTPClient::readHeaderCallback);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HEADERDATA, &this->m_strRespHeader);
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(this->m_pCurl.get(), CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTP_VERSION, CHTTPClient::toCurlVersion(this->m_enVersion));
+    if(this->m_pDnsCache)
+        this->m_pDnsCache->apply(this->m_pCurl.get(), this->m_strIp, this->m_nPort, this->m_pResolve);
+
+    //the responses being decoded by libcurl before the write callbacks
+    if(this->m_strAcceptEncoding.has_value())
+        curl_easy_setopt(this->m_pCurl.get(), CURLOPT_ACCEPT_ENCODING, this->m_strAcceptEncoding->c_str());
+
+    return true;
+}
+
+std::optional<std::string> CHTTPClient::sendStream(const std::string & strURL, const bool bPut, bodyReader & reader, const std::optional<curl_off_t> & nContentLength)
+{
+    if(!reader){
+        this->m_strErrMsg = g_mpHttpsErrMsg[EN_HTTPS_INVALID_INPUT_ARGS];
+        return std::nullopt;
+    }
+
+    if(!this->generalSetting(strURL))
+        return std::nullopt;
+
+    //the bytes pulled from the reader being counted before gzipped
+    bodyReader counter = [this, &reader](char * pBuffer, const size_t nSize){
+        const size_t nRead = reader(pBuffer, nSize);
+        if(nRead <= nSize)
+            this->m_stStats.nUploadBody += static_cast<curl_off_t>(nRead);
+        return nRead;
+    };
+
+    //the length of the gzipped body being unknown until the end
+    std::optional<curl_off_t> nLength = nContentLength;
+    const bool bGzip = this->m_bGzipBody && (!nLength.has_value() || *nLength >= static_cast<curl_off_t>(this->m_nGzipMinSize));
+    bodyReader source = bGzip ? this->gzipReader(counter) : counter;
+    if(bGzip)
+        nLength.reset();
+
+    //no 'Expect: 100-continue', saving a round trip before sending the body
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> pHeaders(curl_slist_append(nullptr, "Expect:"), &curl_slist_free_all);
+    if(!nLength.has_value())
+        pHeaders.reset(curl_slist_append(pHeaders.release(), "Transfer-Encoding: chunked"));
+    if(bGzip)
+        pHeaders.reset(curl_slist_append(pHeaders.release(), "Content-Encoding: gzip"));
+
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, pHeaders.get());
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_READFUNCTION, CHTTPClient::readBodyCallback);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_READDATA, &source);
+    if(bPut){
+        curl_easy_setopt(this->m_pCurl.get(), CURLOPT_UPLOAD, 1L);
+        if(nLength.has_value())
+            curl_easy_setopt(this->m_pCurl.get(), CURLOPT_INFILESIZE_LARGE, *nLength);
+    }else{
+        curl_easy_setopt(this->m_pCurl.get(), CURLOPT_POST, 1L);
+        if(nLength.has_value())
+            curl_easy_setopt(this->m_pCurl.get(), CURLOPT_POSTFIELDSIZE_LARGE, *nLength);
+    }
+
+    auto && strRet = this->perform();
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, nullptr);//pHeaders being freed
+    return strRet;
+}
+
+bool CHTTPClient::setBody(const std::string_view strData, std::string & strGzipped, std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> & pHeaders)
+{
+    this->m_stStats.nUploadBody = static_cast<curl_off_t>(strData.size());
+
+    //no 'Expect: 100-continue' for the bodies over 1MiB, as sendStream
+    pHeaders.reset(curl_slist_append(pHeaders.release(), "Expect:"));
+
+    std::string_view strBody = strData;
+    if(this->m_bGzipBody && strData.size() >= this->m_nGzipMinSize){
+        auto && strRet = CHTTPClient::gzip(strData, this->m_nGzipLevel);
+        if(!strRet.has_value()){
+            this->m_strErrMsg = std::string("failed to gzip the request body");
+            return false;
+        }
+
+        strGzipped = std::move(*strRet);
+        strBody = strGzipped;
+        pHeaders.reset(curl_slist_append(pHeaders.release(), "Content-Encoding: gzip"));
+    }
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, pHeaders.get());
+
+    //libcurl sending from the pointer directly, neither CURLOPT_COPYPOSTFIELDS nor the read callback copying the body,
+    //a null pointer making libcurl read the body from the read callback, so "" being used for the empty body
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(strBody.size()));
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_POSTFIELDS, strBody.empty() ? "" : strBody.data());
+
+    return true;
+}
+
+//deflate the body pulled from the reader into the buffer of libcurl, 0 being returned only when the gzip stream finished
+CHTTPClient::bodyReader CHTTPClient::gzipReader(bodyReader & reader)
+{
+    auto pState = std::make_shared<StGzipState>();
+    pState->bInit = (Z_OK == deflateInit2(&pState->stStream, this->m_nGzipLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY));
+
+    return [pState, &reader](char * pBuffer, const size_t nSize) -> size_t {
+        if(!pState->bInit)
+            return CURL_READFUNC_ABORT;
+
+        //the pause being returned once, the reader being called again after libcurl resumed, the abort staying
+        if(0 != pState->nDeferred){
+            const size_t nDeferred = pState->nDeferred;
+            if(CURL_READFUNC_PAUSE == nDeferred)
+                pState->nDeferred = 0;
+            return nDeferred;
+        }
+
+        z_stream & stStream = pState->stStream;
+        stStream.next_out = reinterpret_cast<Bytef *>(pBuffer);
+        stStream.avail_out = static_cast<uInt>(nSize);
+
+        while(stStream.avail_out > 0 && !pState->bDone){
+            if(0 == stStream.avail_in && !pState->bInputEnd){
+                const size_t nRead = reader(pState->vecInput.data(), pState->vecInput.size());
+                if(nRead > pState->vecInput.size()){
+                    //CURL_READFUNC_ABORT or CURL_READFUNC_PAUSE, nothing being consumed, the bytes deflated into the
+                    //buffer in this call being returned first, NOT being dropped by the pause
+                    const size_t nProduced = nSize - stStream.avail_out;
+                    if(0 == nProduced)
+                        return nRead;
+
+                    pState->nDeferred = nRead;
+                    return nProduced;
+                }
+
+                pState->bInputEnd = (0 == nRead);
+                stStream.next_in = reinterpret_cast<Bytef *>(pState->vecInput.data());
+                stStream.avail_in = static_cast<uInt>(nRead);
+            }
+
+            const int nRet = deflate(&stStream, pState->bInputEnd ? Z_FINISH : Z_NO_FLUSH);
+            if(Z_STREAM_END == nRet)
+                pState->bDone = true;
+            else if(Z_OK != nRet && Z_BUF_ERROR != nRet)
+                return CURL_READFUNC_ABORT;
+        }
+
+        return nSize - stStream.avail_out;
+    };
+}
+
+std::optional<std::string> CHTTPClient::cachedGet(const std::string & strURL)
+{
+    const std::string && strKey = this->getIp_Port() + std::string("/") + strURL;
+    auto && pairEntry = this->m_pCache->lookup(strKey);
+    const auto & pEntry = pairEntry.first;
+    if(pEntry && pairEntry.second){
+        this->m_strRespHeader = pEntry->strHeader;
+        this->m_nRespCode = 200;
+        this->m_stStats.nDownloadBody = static_cast<curl_off_t>(pEntry->strBody.size());
+        return pEntry->strBody;
+    }
+
+    std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> pHeaders(nullptr, &curl_slist_free_all);
+    if(pEntry){
+        if(!pEntry->strETag.empty())
+            pHeaders.reset(curl_slist_append(pHeaders.release(), (std::string("If-None-Match: ") + pEntry->strETag).c_str()));
+        if(!pEntry->strLastModified.empty())
+            pHeaders.reset(curl_slist_append(pHeaders.release(), (std::string("If-Modified-Since: ") + pEntry->strLastModified).c_str()));
+        curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, pHeaders.get());
+    }
+
+    auto && strRet = this->performIdempotent();
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_HTTPHEADER, nullptr);//pHeaders being freed
+    if(!strRet.has_value())
+        return std::nullopt;
+
+    //NOT modified, the cached body being served as a 200 with the stored headers updated by the 304
+    if(304 == this->m_nRespCode && pEntry){
+        auto && pUpdated = this->m_pCache->revalidated(strKey, *pEntry, this->m_strRespHeader);
+        this->m_strRespHeader = pUpdated->strHeader;
+        this->m_bRespHeaderParsed = false;
+        this->m_nRespCode = 200;
+        this->m_stStats.nDownloadBody = static_cast<curl_off_t>(pUpdated->strBody.size());
+        return pUpdated->strBody;
+    }
+
+    if(200 == this->m_nRespCode)
+        this->m_pCache->store(strKey, this->getRespHeaders(), this->m_strRespHeader, *strRet);
+
+    return strRet;
+}
+
+std::optional<std::string> CHTTPClient::perform()
+{
+    StRespBuffer stBuffer;
+    stBuffer.pCurl = this->m_pCurl.get();
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_WRITEFUNCTION, CHTTPClient::readRespCallback);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_WRITEDATA, &stBuffer);
+
+    std::chrono::steady_clock::time_point startedAt;
+    if(!this->acquireLimit(startedAt))
+        return std::nullopt;
 
     CURLcode enRet = curl_easy_perform(this->m_pCurl.get());
+    this->m_enCode = enRet;
+    this->collectStats(this->m_pCurl.get(), static_cast<curl_off_t>(stBuffer.strBody.size()));
+    this->releaseLimit(startedAt, CURLE_OK == enRet ? this->m_nRespCode : 0);
     if(CURLE_OK == enRet){
-        std::cout << strHeader << std::endl;
-        return strResponse;
+        return std::move(stBuffer.strBody);
     }else{
         this->m_strErrMsg =std::string(curl_easy_strerror(enRet));
         return std::nullopt;
     }
 }
 
-const std::string & CHTTPClient::getErrMsg() const
+bool CHTTPClient::perform(bodySink & sink)
 {
-    return this->m_strErrMsg;
+    //the decoded bytes being counted on the way to the sink
+    curl_off_t nDownloadBody = 0;
+    bodySink counter = [&sink, &nDownloadBody](const char * pData, const size_t nSize){
+        nDownloadBody += static_cast<curl_off_t>(nSize);
+        return sink(pData, nSize);
+    };
+
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_WRITEFUNCTION, CHTTPClient::writeSinkCallback);
+    curl_easy_setopt(this->m_pCurl.get(), CURLOPT_WRITEDATA, &counter);
+
+    std::chrono::steady_clock::time_point startedAt;
+    if(!this->acquireLimit(startedAt))
+        return false;
+
+    CURLcode enRet = curl_easy_perform(this->m_pCurl.get());
+    this->m_enCode = enRet;
+    this->collectStats(this->m_pCurl.get(), nDownloadBody);
+    this->releaseLimit(startedAt, CURLE_OK == enRet ? this->m_nRespCode : 0);
+    if(CURLE_OK == enRet)
+        return true;
+
+    this->m_strErrMsg = (CURLE_WRITE_ERROR == enRet) ? std::string("such the response body being refused by the sink") : std::string(curl_easy_strerror(enRet));
+    return false;
 }
 
+std::optional<std::string> CHTTPClient::performIdempotent()
+{
+    if(nullptr == this->m_pRetryPolicy)
+        return this->perform();
 
-std::string CHTTPClient::getIp_Port()
+    CHTTPRetryPolicy & policy = *this->m_pRetryPolicy;
+    policy.recordRequest();
+
+    std::optional<std::string> strRet;
+    for(size_t nAttempt = 0; ; nAttempt++){
+        this->m_strRespHeader.clear();
+        this->m_bRespHeaderParsed = false;
+        strRet = policy.getParams().bHedge ? this->performHedged() : this->perform();
+
+        if(strRet.has_value() && 200 <= this->m_nRespCode && this->m_nRespCode < 300)
+            policy.recordLatency(static_cast<std::int64_t>(this->m_stStats.nTotalTimeUs));
+
+        //the last result being returned when NOT retrying, the body of 503 included, and the request refused by the
+        //limiter being returned at once rather than sleeping in the thread
+        if(this->m_nLimitWaitMs.has_value() || !CHTTPClient::isRetryable(this->m_enCode, this->m_nRespCode) || nAttempt + 1 >= policy.getParams().nMaxAttempts || !policy.acquireRetry())
+            break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(policy.backoffMs(nAttempt + 1)));
+    }
+
+    return strRet;
+}
+
+std::optional<std::string> CHTTPClient::performHedged()
 {
-    const std::string && strProtocol = (this->m_enMode == _EN_HTTPS_) ? std::string("https://") : std::string("http://");
-    return strProtocol + this->m_strIp + std::string(":") + std::to_string(this->m_nPort);
+    if(!this->m_pMulti)
+        this->m_pMulti.reset(curl_multi_init());
+    if(!this->m_pMulti){
+        this->m_enCode = CURLE_FAILED_INIT;
+        this->m_strErrMsg = g_mpHttpsErrMsg[EN_FTTPS_RESOURCE_INIT_ERROR];
+        return std::nullopt;
+    }
+
+    //the first one being the handle of the client, the second one being its duplicate sharing the connections
+    typedef struct ST_hedgeTransfer{
+        CURL * pCurl = nullptr;
+        StRespBuffer stBuffer;
+        std::string strHeader;
+        bool bRunning = false;
+        CURLcode enCode = CURLE_OK;
+    }StHedgeTransfer;
+
+    StHedgeTransfer arrTransfers[2];
+    CURLM * pMulti = this->m_pMulti.get();
+    auto start = [pMulti](StHedgeTransfer & stTransfer){
+        stTransfer.stBuffer.pCurl = stTransfer.pCurl;
+        curl_easy_setopt(stTransfer.pCurl, CURLOPT_WRITEFUNCTION, CHTTPClient::readRespCallback);
+        curl_easy_setopt(stTransfer.pCurl, CURLOPT_WRITEDATA, &stTransfer.stBuffer);
+        curl_easy_setopt(stTransfer.pCurl, CURLOPT_HEADERDATA, &stTransfer.strHeader);
+        stTransfer.bRunning = (CURLM_OK == curl_multi_add_handle(pMulti, stTransfer.pCurl));
+        if(!stTransfer.bRunning)
+            stTransfer.enCode = CURLE_FAILED_INIT;
+        return stTransfer.bRunning;
+    };
+
+    //the hedge taking no slot of the limiter, such the two racing for one request
+    std::chrono::steady_clock::time_point startedAt;
+    if(!this->acquireLimit(startedAt))
+        return std::nullopt;
+
+    arrTransfers[0].pCurl = this->m_pCurl.get();
+    start(arrTransfers[0]);
+
+    const auto startTime = std::chrono::steady_clock::now();
+    std::optional<long> nHedgeDelayMs = this->m_pRetryPolicy->hedgeDelayMs();
+    StHedgeTransfer * pWinner = nullptr;
+    StHedgeTransfer * pLast = &arrTransfers[0];
+
+    while(nullptr == pWinner && (arrTransfers[0].bRunning || arrTransfers[1].bRunning)){
+        int nRunning = 0;
+        curl_multi_perform(pMulti, &nRunning);
+
+        int nMsgLeft = 0;
+        CURLMsg * pMsg = nullptr;
+        while((pMsg = curl_multi_info_read(pMulti, &nMsgLeft))){
+            if(CURLMSG_DONE != pMsg->msg)
+                continue;
+
+            StHedgeTransfer & stDone = (pMsg->easy_handle == arrTransfers[0].pCurl) ? arrTransfers[0] : arrTransfers[1];
+            stDone.enCode = pMsg->data.result;
+            stDone.bRunning = false;
+            curl_multi_remove_handle(pMulti, stDone.pCurl);
+            pLast = &stDone;
+
+            //the one failed or answered by 502, 503 or 504 waiting for the other still running, and being returned only
+            //when the other NOT winning either, such a retry being decided by performIdempotent
+            if(nullptr == pWinner){
+                long nRespCode = 0;
+                curl_easy_getinfo(stDone.pCurl, CURLINFO_RESPONSE_CODE, &nRespCode);
+                if(!CHTTPClient::isRetryable(stDone.enCode, nRespCode))
+                    pWinner = &stDone;
+            }
+        }
+
+        if(pWinner || !(arrTransfers[0].bRunning || arrTransfers[1].bRunning))
+            break;
+
+        const long nElapsedMs = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+        if(nHedgeDelayMs.has_value() && nElapsedMs >= *nHedgeDelayMs){
+            nHedgeDelayMs.reset();//at most one hedge
+            if(arrTransfers[0].bRunning && this->m_pRetryPolicy->acquireHedge()){
+                arrTransfers[1].pCurl = curl_easy_duphandle(this->m_pCurl.get());
+                if(arrTransfers[1].pCurl)
+                    start(arrTransfers[1]);
+            }
+        }
+
+        const int nWaitMs = nHedgeDelayMs.has_value() ? static_cast<int>(std::max<long>(*nHedgeDelayMs - nElapsedMs, 0)) : 1000;
+        curl_multi_poll(pMulti, nullptr, 0, nWaitMs, nullptr);
+    }
+
+    //the loser being cancelled, its connection being closed rather than reused for the response left
+    for(auto & stTransfer : arrTransfers){
+        if(stTransfer.bRunning)
+            curl_multi_remove_handle(pMulti, stTransfer.pCurl);
+    }
+
+    StHedgeTransfer & stResult = pWinner ? *pWinner : *pLast;
+    if(pWinner == &arrTransfers[1])
+        this->m_pRetryPolicy->recordHedgeWin();
+
+    this->m_enCode = stResult.enCode;
+    this->m_strRespHeader = std::move(stResult.strHeader);
+    this->m_bRespHeaderParsed = false;
+    this->collectStats(stResult.pCurl, static_cast<curl_off_t>(stResult.stBuffer.strBody.size()));
+    this->releaseLimit(startedAt, CURLE_OK == stResult.enCode ? this->m_nRespCode : 0);
+
+    std::optional<std::string> strRet;
+    if(CURLE_OK == stResult.enCode)
+        strRet = std::move(stResult.stBuffer.strBody);
+    else
+        this->m_strErrMsg = std::string(curl_easy_strerror(stResult.enCode));
+
+    if(arrTransfers[1].pCurl)
+        curl_easy_cleanup(arrTransfers[1].pCurl);
+
+    return strRet;
+}
+
+bool CHTTPClient::downloadRanges(const int nFd, const curl_off_t nLength, const size_t nRanges, const size_t nMaxRetries)
+{
+    if(!this->m_pMulti)
+        this->m_pMulti.reset(curl_multi_init());
+    if(!this->m_pMulti){
+        this->m_strErrMsg = g_mpHttpsErrMsg[EN_FTTPS_RESOURCE_INIT_ERROR];
+        return false;
+    }
+
+    //the ranges of a file taking one slot of the limiter, as a single download
+    std::chrono::steady_clock::time_point startedAt;
+    if(!this->acquireLimit(startedAt))
+        return false;
+
+    CURLM * pMulti = this->m_pMulti.get();
+    auto start = [pMulti](StRangeTransfer & stRange){
+        const std::string && strRange = std::to_string(stRange.nOffset) + std::string("-") + std::to_string(stRange.nEnd);
+        curl_easy_setopt(stRange.pCurl, CURLOPT_RANGE, strRange.c_str());//being copied by libcurl
+        stRange.bVerified = false;
+        stRange.bMismatched = false;
+        stRange.strHeader.clear();
+        stRange.bRunning = (CURLM_OK == curl_multi_add_handle(pMulti, stRange.pCurl));
+        return stRange.bRunning;
+    };
+
+    //the duplicates sharing the connections, the DNS cache and the TLS sessions of the handle
+    bool bOK = true;
+    std::vector<StRangeTransfer> vecRanges(nRanges);
+    const curl_off_t nRangeSize = (nLength + static_cast<curl_off_t>(nRanges) - 1) / static_cast<curl_off_t>(nRanges);
+    for(size_t ii = 0; bOK && ii < nRanges; ii++){
+        StRangeTransfer & stRange = vecRanges[ii];
+        stRange.nFd = nFd;
+        stRange.nBegin = static_cast<curl_off_t>(ii) * nRangeSize;
+        stRange.nEnd = std::min(nLength, stRange.nBegin + nRangeSize) - 1;
+        stRange.nOffset = stRange.nBegin;
+        stRange.pCurl = curl_easy_duphandle(this->m_pCurl.get());
+        if(nullptr == stRange.pCurl){
+            this->m_strErrMsg = g_mpHttpsErrMsg[EN_FTTPS_RESOURCE_INIT_ERROR];
+            bOK = false;
+            break;
+        }
+
+        curl_easy_setopt(stRange.pCurl, CURLOPT_WRITEFUNCTION, CHTTPClient::writeRangeCallback);
+        curl_easy_setopt(stRange.pCurl, CURLOPT_WRITEDATA, &stRange);
+        curl_easy_setopt(stRange.pCurl, CURLOPT_HEADERFUNCTION, CHTTPClient::readHeaderCallback);
+        curl_easy_setopt(stRange.pCurl, CURLOPT_HEADERDATA, &stRange.strHeader);
+        bOK = start(stRange);
+    }
+
+    auto isRunning = [&vecRanges](){
+        return std::any_of(vecRanges.begin(), vecRanges.end(), [](const StRangeTransfer & stRange){ return stRange.bRunning; });
+    };
+
+    while(bOK && isRunning()){
+        int nRunning = 0;
+        curl_multi_perform(pMulti, &nRunning);
+
+        int nMsgLeft = 0;
+        CURLMsg * pMsg = nullptr;
+        while(bOK && (pMsg = curl_multi_info_read(pMulti, &nMsgLeft))){
+            if(CURLMSG_DONE != pMsg->msg)
+                continue;
+
+            CURL * pCurl = pMsg->easy_handle;
+            const CURLcode enCode = pMsg->data.result;
+            auto iter = std::find_if(vecRanges.begin(), vecRanges.end(), [pCurl](const StRangeTransfer & stRange){ return stRange.pCurl == pCurl; });
+            if(vecRanges.end() == iter)
+                continue;
+
+            StRangeTransfer & stRange = *iter;
+            stRange.bRunning = false;
+            curl_multi_remove_handle(pMulti, pCurl);
+            if(stRange.nOffset == stRange.nEnd + 1)
+                continue;//all the bytes written
+
+            //resumed from the byte NOT written yet, the other ranges NOT being touched, NOT for the client errors
+            long nRespCode = 0;
+            curl_easy_getinfo(pCurl, CURLINFO_RESPONSE_CODE, &nRespCode);
+            if(!stRange.bMismatched && stRange.nRetries < nMaxRetries && !(400 <= nRespCode && nRespCode < 500)){
+                stRange.nRetries++;
+                bOK = start(stRange);
+            }else{
+                bOK = false;
+            }
+
+            if(!bOK && stRange.bMismatched){
+                this->m_strErrMsg = std::string("the range ") + std::to_string(stRange.nOffset) + std::string("-") + std::to_string(stRange.nEnd)
+                                    + std::string(" NOT matching the response, Content-Range:") + CHTTPClient::findHeader(stRange.strHeader, "content-range").value_or("");
+            }else if(!bOK){
+                this->m_strErrMsg = std::string("failed to download the range ") + std::to_string(stRange.nBegin) + std::string("-")
+                                    + std::to_string(stRange.nEnd) + std::string(":") + std::string(curl_easy_strerror(enCode))
+                                    + std::string(", response code ") + std::to_string(nRespCode);
+            }
+        }
+
+        if(bOK && isRunning())
+            curl_multi_poll(pMulti, nullptr, 0, 1000, nullptr);
+    }
+
+    for(auto & stRange : vecRanges){
+        if(stRange.bRunning)
+            curl_multi_remove_handle(pMulti, stRange.pCurl);
+        if(stRange.pCurl)
+            curl_easy_cleanup(stRange.pCurl);
+    }
+
+    if(bOK){
+        this->m_nRespCode = 206;
+        this->m_stStats.nDownloadWire = nLength;
+        this->m_stStats.nDownloadBody = nLength;
+    }
+
+    this->releaseLimit(startedAt, bOK ? 206 : 0);
+    return bOK;
+}
+
+bool CHTTPClient::isRetryable(const CURLcode enCode, const long nRespCode)
+{
+    switch(enCode){
+    case CURLE_OK:
+        return 502 == nRespCode || 503 == nRespCode || 504 == nRespCode;
+    case CURLE_COULDNT_RESOLVE_HOST:
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_OPERATION_TIMEDOUT:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+    case CURLE_PARTIAL_FILE:
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::optional<std::string> CHTTPClient::findHeader(const std::string & strHeader, const std::string & strName)
+{
+    //the status line skipped, the name being case-insensitive, the value being trimmed
+    size_t nBegin = strHeader.find('\n');
+    while(std::string::npos != nBegin && nBegin + 1 < strHeader.size()){
+        nBegin++;
+        size_t nEnd = strHeader.find('\n', nBegin);
+        if(std::string::npos == nEnd)
+            nEnd = strHeader.size();
+
+        if(nEnd - nBegin > strName.size() && ':' == strHeader[nBegin + strName.size()]
+           && 0 == strncasecmp(strHeader.data() + nBegin, strName.data(), strName.size())){
+            size_t nValueBegin = nBegin + strName.size() + 1;
+            size_t nValueEnd = nEnd;
+            while(nValueBegin < nValueEnd && (' ' == strHeader[nValueBegin] || '\t' == strHeader[nValueBegin]))
+                nValueBegin++;
+            while(nValueEnd > nValueBegin && isspace(static_cast<unsigned char>(strHeader[nValueEnd - 1])))
+                nValueEnd--;
+
+            return strHeader.substr(nValueBegin, nValueEnd - nValueBegin);
+        }
+
+        nBegin = nEnd;
+    }
+
+    return std::nullopt;
+}
+
+bool CHTTPClient::isRangeMatched(const std::string & strHeader, const curl_off_t nBegin, const curl_off_t nEnd)
+{
+    const std::optional<std::string> && strRange = CHTTPClient::findHeader(strHeader, "content-range");
+    if(!strRange.has_value() || 0 != strncasecmp(strRange->c_str(), "bytes ", 6))
+        return false;
+
+    //"bytes first-last/complete", the complete length being "*" when unknown
+    const char * pBegin = strRange->c_str() + 6;
+    char * pEnd = nullptr;
+    errno = 0;
+    const long long nFirst = strtoll(pBegin, &pEnd, 10);
+    if(0 != errno || pEnd == pBegin || '-' != *pEnd)
+        return false;
+
+    pBegin = pEnd + 1;
+    const long long nLast = strtoll(pBegin, &pEnd, 10);
+    if(0 != errno || pEnd == pBegin || '/' != *pEnd)
+        return false;
+
+    return nFirst == nBegin && nLast == nEnd;
+}
+
+//the status code, the bytes and the timings, CURLINFO_SIZE_DOWNLOAD_T counting the body before being decoded,
+//CURLINFO_SIZE_UPLOAD_T after being gzipped
+void CHTTPClient::collectStats(CURL * pCurl, const curl_off_t nDownloadBody)
+{
+    curl_easy_getinfo(pCurl, CURLINFO_RESPONSE_CODE, &this->m_nRespCode);
+    CHTTPClient::readTransferInfo(pCurl, this->m_stStats);
+    this->m_stStats.nDownloadBody = nDownloadBody;
+    this->m_stStats.strContentEncoding = this->getRespHeader("content-encoding").value_or("");
+
+    if(this->m_pMetrics)
+        this->m_pMetrics->record(this->m_strIp + std::string(":") + std::to_string(this->m_nPort), this->m_stStats, CURLE_OK == this->m_enCode);
 }
 
-//write data callback
+bool CHTTPClient::acquireLimit(std::chrono::steady_clock::time_point & startedAt)
+{
+    startedAt = std::chrono::steady_clock::now();
+    if(nullptr == this->m_pLimiter)
+        return true;
+
+    long nWaitMs = 0;
+    if(this->m_pLimiter->tryAcquire(this->m_strIp + std::string(":") + std::to_string(this->m_nPort), nWaitMs))
+        return true;
+
+    //NOT being sent, such NOT being retried by the policy either
+    this->m_nLimitWaitMs = nWaitMs;
+    this->m_enCode = CURLE_ABORTED_BY_CALLBACK;
+    this->m_nRespCode = 0;
+    this->m_strErrMsg = std::string("such the host being over the limit, retry after ") + std::to_string(nWaitMs) + std::string(" ms");
+    return false;
+}
+
+//nStatus being 0 on the transfer failed, neither growing nor shrinking the limit
+void CHTTPClient::releaseLimit(const std::chrono::steady_clock::time_point & startedAt, const long nStatus)
+{
+    if(nullptr == this->m_pLimiter)
+        return;
+
+    const std::optional<long> nRetryAfterMs = (429 == nStatus || 503 == nStatus) ? CHTTPHostLimiter::retryAfterMs(this->m_strRespHeader) : std::nullopt;
+    this->m_pLimiter->release(this->m_strIp + std::string(":") + std::to_string(this->m_nPort), startedAt, nStatus, nRetryAfterMs);
+}
+
+//write data callback, the body being reserved once by the Content-Length, which being known after the headers received,
+//capped such a bogus length NOT allocating too much, and being the encoded length for the compressed responses, so a hint only
 size_t CHTTPClient::readRespCallback(void * contents, size_t size, size_t nmemb, void * pUserData){
-    std::string * pUserInData = static_cast<std::string*>(pUserData);
-    pUserInData->append(static_cast<char*>(contents), size * nmemb);
+    StRespBuffer * pBuffer = static_cast<StRespBuffer *>(pUserData);
+    if(!pBuffer->bReserved){
+        pBuffer->bReserved = true;
+
+        curl_off_t nLength = -1;
+        if(CURLE_OK == curl_easy_getinfo(pBuffer->pCurl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &nLength) && nLength > 0)
+            pBuffer->strBody.reserve(static_cast<size_t>(std::min<curl_off_t>(nLength, 256 * 1024 * 1024)));
+    }
+
+    pBuffer->strBody.append(static_cast<char*>(contents), size * nmemb);
     return size * nmemb;
 }
+
+//the bytes being written at their offsets in the file, the response NOT being 206, NOT matching the range requested or
+//beyond the range being refused, such the server ignoring the range NOT writing the whole body into the range
+size_t CHTTPClient::writeRangeCallback(void * contents, size_t size, size_t nmemb, void * pUserData)
+{
+    StRangeTransfer * pRange = static_cast<StRangeTransfer *>(pUserData);
+    const size_t nSize = size * nmemb;
+    if(!pRange->bVerified){
+        long nRespCode = 0;
+        curl_easy_getinfo(pRange->pCurl, CURLINFO_RESPONSE_CODE, &nRespCode);
+        if(206 != nRespCode)
+            return 0;
+
+        //the server or a proxy returning another range, or a multipart/byteranges body, NOT being written at the offsets
+        if(!CHTTPClient::isRangeMatched(pRange->strHeader, pRange->nOffset, pRange->nEnd)){
+            pRange->bMismatched = true;
+            return 0;
+        }
+        pRange->bVerified = true;
+    }
+
+    if(pRange->nOffset + static_cast<curl_off_t>(nSize) > pRange->nEnd + 1)
+        return 0;
+
+    const char * pData = static_cast<const char *>(contents);
+    size_t nDone = 0;
+    while(nDone < nSize){
+        const ssize_t nRet = pwrite(pRange->nFd, pData + nDone, nSize - nDone, static_cast<off_t>(pRange->nOffset));
+        if(nRet < 0 && EINTR == errno)
+            continue;
+        if(nRet <= 0)
+            return 0;
+
+        nDone += static_cast<size_t>(nRet);
+        pRange->nOffset += nRet;
+    }
+
+    return nSize;
+}
+
+//a value other than size * nmemb making libcurl abort the transfer with CURLE_WRITE_ERROR
+size_t CHTTPClient::writeSinkCallback(void * contents, size_t size, size_t nmemb, void * pUserData)
+{
+    bodySink * pSink = static_cast<bodySink *>(pUserData);
+    return (*pSink)(static_cast<const char *>(contents), size * nmemb) ? size * nmemb : 0;
+}
+
+//the headers of the interim responses, such as "100 Continue" and the redirections, being dropped on a new status line
+size_t CHTTPClient::readHeaderCallback(char * pBuffer, size_t size, size_t nitems, void * pUserData)
+{
+    std::string * pHeader = static_cast<std::string *>(pUserData);
+    const size_t nSize = size * nitems;
+    if(nSize >= 5 && 0 == strncmp(pBuffer, "HTTP/", 5))
+        pHeader->clear();
+
+    pHeader->append(pBuffer, nSize);
+    return nSize;
+}
+
+//read the request body from the bodyReader
+size_t CHTTPClient::readBodyCallback(char * pBuffer, size_t size, size_t nitems, void * pUserData)
+{
+    bodyReader * pReader = static_cast<bodyReader *>(pUserData);
+    return (*pReader)(pBuffer, size * nitems);
+}
@@ -4,8 +4,18 @@
 #include "curl/curl.h"
 
 #include <string>
+#include <string_view>
 #include <optional>
 #include <memory>
+#include <functional>
+#include <unordered_map>
+#include <chrono>
+
+class CHTTPCache;
+class CHTTPRetryPolicy;
+class CHTTPMetrics;
+class CDnsCache;
+class CHTTPHostLimiter;
 
 enum HTTPMode{
     _EN_HTTP_ = 0,
@@ -15,17 +25,73 @@ enum HTTPMode{
     _EN_INVALID_HTTP_MODE_LAST_,
 };
 
+//HTTP version to request
+enum HTTPVersion{
+    _EN_HTTP_1_1_ = 0,
+    _EN_HTTP_2_TLS_,                //HTTP/2 over TLS negotiated by ALPN, HTTP/1.1 for the plain text
+    _EN_HTTP_2_PRIOR_KNOWLEDGE_,    //HTTP/2 without upgrade, for the plain text servers speaking HTTP/2 only(h2c)
+
+    //Do NOT Use the below
+    _EN_INVALID_HTTP_VERSION_LAST_,
+};
+
+//the bytes of the last request, the wire bytes being the bodies as transferred, compressed when being encoded,
+//the body bytes being the bodies as the caller seeing, such the ratio of them being the saving of the compression
+typedef struct ST_httpTransferStats{
+    curl_off_t nDownloadWire = 0;
+    curl_off_t nDownloadBody = 0;
+    curl_off_t nUploadWire = 0;
+    curl_off_t nUploadBody = 0;
+    std::string strContentEncoding;//of the response, empty when NOT being encoded
+
+    //the timings of the transfer responding, the winner when being hedged, in microseconds from the start
+    curl_off_t nNameLookupUs = 0;
+    curl_off_t nConnectUs = 0;
+    curl_off_t nAppConnectUs = 0;//the TLS handshake done, 0 for the plain text
+    curl_off_t nStartTransferUs = 0;//the first byte received
+    curl_off_t nTotalTimeUs = 0;
+    long nNewConnects = 0;//0 when the connection being reused
+}StHTTPTransferStats;
+
 class CHTTPClient
 {
 private:
     std::string m_strErrMsg = "";//error message of the last operation
     std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> m_pCurl;
     HTTPMode m_enMode = HTTPMode::_EN_HTTP_;
+    HTTPVersion m_enVersion = HTTPVersion::_EN_HTTP_2_TLS_;//the default of libcurl
+
+    //"" advertising all the encodings built in libcurl, std::nullopt advertising none
+    std::optional<std::string> m_strAcceptEncoding = std::string("");
+    //the request bodies NOT smaller than m_nGzipMinSize being gzipped
+    bool m_bGzipBody = false;
+    size_t m_nGzipMinSize = 1024;
+    int m_nGzipLevel = 6;
+
+    StHTTPTransferStats m_stStats;
+    long m_nRespCode = 0;
+
+    CHTTPCache * m_pCache = nullptr;//NOT being owned
+    CHTTPRetryPolicy * m_pRetryPolicy = nullptr;//NOT being owned
+    CHTTPMetrics * m_pMetrics = nullptr;//NOT being owned
+    CDnsCache * m_pDnsCache = nullptr;//NOT being owned
+    CHTTPHostLimiter * m_pLimiter = nullptr;//NOT being owned
+    std::optional<long> m_nLimitWaitMs;//of the last request refused by the limiter
+    std::shared_ptr<curl_slist> m_pResolve;//the list of CURLOPT_RESOLVE of the handle, shared by the handles duplicated
+    CURLcode m_enCode = CURLE_OK;//of the last transfer
+
+    //racing the hedged transfers, being created on the first hedged request
+    std::unique_ptr<CURLM, decltype(&curl_multi_cleanup)> m_pMulti{nullptr, &curl_multi_cleanup};
 
     //the remote host information
     std::string m_strIp = "";
     std::uint16_t m_nPort = 80;
 
+    //the headers of the last response, being parsed on the first lookup only
+    std::string m_strRespHeader = "";
+    std::unordered_map<std::string, std::string> m_mpRespHeader;
+    bool m_bRespHeaderParsed = false;
+
 public:
     CHTTPClient(const std::string & strIp, const std::uint16_t nPort = 80, const HTTPMode enMode = _EN_HTTP_);
     ~CHTTPClient() = default;
@@ -39,20 +105,169 @@ public:
     CHTTPClient & setIp(const std::string & strIp);
     CHTTPClient & setPort(const std::uint16_t nPort);
 
+    //the version being negotiated only, the requests of a blocking client being sent one by one and NOT being
+    //multiplexed, for multiplexing the concurrent requests over a single connection, using CHTTPAsyncEngine::setHTTPVersion
+    CHTTPClient & setHTTPVersion(const HTTPVersion enVersion);
+
+    //the value of CURLOPT_HTTP_VERSION
+    static long toCurlVersion(const HTTPVersion enVersion);
+
+    //the encodings advertised by Accept-Encoding and decoded transparently, such as "gzip, deflate, zstd, br",
+    //"" for all the encodings libcurl being built with(the default), std::nullopt for none
+    CHTTPClient & setAcceptEncoding(const std::optional<std::string> & strEncodings);
+
+    //gzip the bodies of POST and PUT with 'Content-Encoding: gzip', for the servers accepting it only, the bodies
+    //smaller than nMinSize being sent as they are, the streamed bodies of unknown length being always gzipped
+    CHTTPClient & setGzipBody(const bool bGzip, const size_t nMinSize = 1024, const int nLevel = 6);
+
+    //the responses of get(strURL) being cached and revalidated by the cache, which must outlive the client,
+    //nullptr to disable, get(strURL, sink) NOT being cached
+    CHTTPClient & setCache(CHTTPCache * pCache);
+
+    //get(strURL) and head being retried on the connection errors, the timeouts and 502, 503, 504, and being hedged when
+    //enabled by the policy, which must outlive the client and being shared by the clients calling the same backends,
+    //nullptr to disable, the methods NOT being idempotent or streaming NOT being retried
+    CHTTPClient & setRetryPolicy(CHTTPRetryPolicy * pPolicy);
+
+    //each request being recorded into the histograms of the host, the metrics must outlive the client, nullptr to disable
+    CHTTPClient & setMetrics(CHTTPMetrics * pMetrics);
+
+    //the host being resolved through the cache rather than by libcurl each connection, the cache must outlive the client,
+    //nullptr to disable
+    CHTTPClient & setDnsCache(CDnsCache * pDnsCache);
+
+    //the requests to "ip:port" being limited by the limiter, the request over the limit being refused at once without
+    //being sent rather than blocking the thread, such a task of a pool being able to submit it again after getLimitWaitMs,
+    //the limiter must outlive the client and being shared by the clients calling the same hosts, nullptr to disable
+    CHTTPClient & setLimiter(CHTTPHostLimiter * pLimiter);
+
+    //the time to wait before sending again when the last request being refused by the limiter, 0 when limited by the
+    //concurrency, std::nullopt when NOT being refused
+    std::optional<long> getLimitWaitMs() const;
+
+
+    //the request body being pulled by the callback, return the count of bytes written into pBuffer, at most nSize,
+    //0 on the end of the body, or CURL_READFUNC_ABORT to abort the request
+    using bodyReader = std::function<size_t(char * pBuffer, const size_t nSize)>;
 
-    //general HTTP request methods
+    //the response body being pushed into the sink chunk by chunk rather than being collected into a string,
+    //return false to abort the transfer
+    using bodySink = std::function<bool(const char * pData, const size_t nSize)>;
+
+    //the sink writing into the fixed buffer of the caller, nWritten being the bytes written, the transfer being
+    //aborted when the body NOT fitting in the buffer
+    static bodySink toBuffer(char * pBuffer, const size_t nCapacity, size_t & nWritten);
+    //the sink writing into the file descriptor, such as a file, a pipe or a socket, which NOT being closed
+    static bodySink toFd(const int nFd);
+
+    //general HTTP request methods, the bodies being sent from the memory of the caller without copying,
+    //which must stay valid until the method returned
     std::optional<std::string> get(const std::string & strURL);
-    std::optional<std::string> post(const std::string & strURL, const std::string & strData);
-    std::optional<std::string> put(const std::string & strURL, const std::string & strData);
+    std::optional<std::string> post(const std::string & strURL, const std::string_view strData);
+    std::optional<std::string> put(const std::string & strURL, const std::string_view strData);
+
+    //the body being streamed by the reader, with 'Transfer-Encoding: chunked' when its length being unknown
+    std::optional<std::string> post(const std::string & strURL, bodyReader reader, const std::optional<curl_off_t> nContentLength = std::nullopt);
+    std::optional<std::string> put(const std::string & strURL, bodyReader reader, const std::optional<curl_off_t> nContentLength = std::nullopt);
+
+    //the body being streamed into the sink without being buffered, return the HTTP status code
+    std::optional<long> get(const std::string & strURL, bodySink sink);
+
+    //download into the file, probed by HEAD first, the nRanges byte ranges being fetched concurrently into the file
+    //preallocated when the server accepting the ranges, each range being retried on its own from where it failed, otherwise
+    //being streamed on a single connection, return the bytes written, the file being removed on failure
+    std::optional<curl_off_t> download(const std::string & strURL, const std::string & strPath, const size_t nRanges = 4, const size_t nMaxRetries = 3);
+
+    //return the response headers, no body being transferred
     std::optional<std::string> head(const std::string & strURL);
 
+    //the status code and the headers of the last response, being the cached ones when served by the cache, the names of the headers being lowercase,
+    //the values of the repeated headers being joined by ", "
+    long getRespCode() const;
+    const std::string & getRespHeader() const;
+    const std::unordered_map<std::string, std::string> & getRespHeaders();
+    std::optional<std::string> getRespHeader(const std::string & strName);
+
+    //the bytes and the timings of the last request, the bytes being on the wire and decoded
+    const StHTTPTransferStats & getStats() const;
+
+    //the timings, the count of the new connections and the bytes on the wire of the transfer done
+    static void readTransferInfo(CURL * pCurl, StHTTPTransferStats & stStats);
+
+    //gzip the data in one shot, std::nullopt on failure of zlib
+    static std::optional<std::string> gzip(const std::string_view strData, const int nLevel = 6);
+
     const std::string & getErrMsg() const;
 
 private:
     std::string getIp_Port();
 
+    //reset the handle and apply the settings shared by all the methods, the live connections and caches being kept by the reset
+    bool generalSetting(const std::string & strURL);
+
+    //send the body pulled by the reader with the given method
+    std::optional<std::string> sendStream(const std::string & strURL, const bool bPut, bodyReader & reader, const std::optional<curl_off_t> & nContentLength);
+
+    //send the data as the body, gzipped when being enabled, strGzipped holding the gzipped body until performed
+    bool setBody(const std::string_view strData, std::string & strGzipped, std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)> & pHeaders);
+
+    //the reader of the gzipped body of the reader, being streamed without knowing the length
+    bodyReader gzipReader(bodyReader & reader);
+
+    //get through the cache, fresh entries being served without a request, stale ones being revalidated
+    std::optional<std::string> cachedGet(const std::string & strURL);
+
+    //collect the body into a string, or stream it into the sink
+    std::optional<std::string> perform();
+    bool perform(bodySink & sink);
+    void collectStats(CURL * pCurl, const curl_off_t nDownloadBody);
+
+    //a request being started and done in the limiter, always true without the limiter
+    bool acquireLimit(std::chrono::steady_clock::time_point & startedAt);
+    void releaseLimit(const std::chrono::steady_clock::time_point & startedAt, const long nStatus);
+
+    //perform by the retry policy, the options of the request being kept between the attempts
+    std::optional<std::string> performIdempotent();
+    //a duplicate being raced with the handle after the hedge delay, the loser being cancelled
+    std::optional<std::string> performHedged();
+
+    static bool isRetryable(const CURLcode enCode, const long nRespCode);
+
+    //fetch the ranges of the file concurrently by the duplicates of the handle being set for the GET
+    bool downloadRanges(const int nFd, const curl_off_t nLength, const size_t nRanges, const size_t nMaxRetries);
+
 private:
+    //the string of the body being reserved by the Content-Length on the first chunk
+    typedef struct ST_respBuffer{
+        std::string strBody;
+        CURL * pCurl = nullptr;
+        bool bReserved = false;
+    }StRespBuffer;
+
+    //the bytes [nBegin, nEnd] of the file, nOffset being the next byte to write, from which being resumed on retry
+    typedef struct ST_rangeTransfer{
+        CURL * pCurl = nullptr;
+        int nFd = -1;
+        curl_off_t nBegin = 0;
+        curl_off_t nEnd = 0;
+        curl_off_t nOffset = 0;
+        size_t nRetries = 0;
+        bool bRunning = false;
+        bool bVerified = false;//206 and Content-Range being checked on the first chunk of each attempt
+        bool bMismatched = false;//the range returned NOT being the one requested, NOT being retried
+        std::string strHeader;//the headers of the response of the attempt
+    }StRangeTransfer;
+
+    //the value of the header named in the raw headers of a response, std::nullopt if NOT found
+    static std::optional<std::string> findHeader(const std::string & strHeader, const std::string & strName);
+    //whether Content-Range of the headers being "bytes nBegin-nEnd/...", a multipart/byteranges response NOT having it
+    static bool isRangeMatched(const std::string & strHeader, const curl_off_t nBegin, const curl_off_t nEnd);
+
     static size_t readRespCallback(void * contents, size_t size, size_t nmemb, void * pUserData);
+    static size_t writeRangeCallback(void * contents, size_t size, size_t nmemb, void * pUserData);
+    static size_t writeSinkCallback(void * contents, size_t size, size_t nmemb, void * pUserData);
+    static size_t readHeaderCallback(char * pBuffer, size_t size, size_t nitems, void * pUserData);
+    static size_t readBodyCallback(char * pBuffer, size_t size, size_t nitems, void * pUserData);
 };
 
 #endif // CHTTPCLIENT_H
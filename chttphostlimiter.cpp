@@ -0,0 +1,153 @@
+#include "chttphostlimiter.h"
+
+#include "curl/curl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+
+CHTTPHostLimiter::CHTTPHostLimiter(const StHostLimitParams & stParams/*=StHostLimitParams()*/) : m_stDefault(stParams)
+{
+
+}
+
+void CHTTPHostLimiter::setHostParams(const std::string & strHost, const StHostLimitParams & stParams)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StHostEntry & stEntry = this->m_mpHosts[strHost];
+    const size_t nInFlight = stEntry.stState.nInFlight;//the requests in flight being released later
+    CHTTPHostLimiter::reset(stEntry, stParams);
+    stEntry.stState.nInFlight = nInFlight;
+}
+
+bool CHTTPHostLimiter::tryAcquire(const std::string & strHost, long & nWaitMs)
+{
+    const auto now = std::chrono::steady_clock::now();
+    nWaitMs = 0;
+
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StHostEntry & stEntry = this->entryOf(strHost);
+    StHostLimitState & stState = stEntry.stState;
+
+    if(now < stEntry.pausedUntil){
+        nWaitMs = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(stEntry.pausedUntil - now).count()) + 1;
+        return false;
+    }
+
+    if(static_cast<double>(stState.nInFlight) + 1 > std::floor(stState.fLimit))
+        return false;
+
+    if(stState.fRatePerSec > 0){
+        const double fElapsed = std::chrono::duration<double>(now - stEntry.lastRefill).count();
+        stState.fTokens = std::min(stState.fTokens + fElapsed * stState.fRatePerSec, std::max(stEntry.stParams.fBurst, 1.0));
+        stEntry.lastRefill = now;
+
+        if(stState.fTokens < 1.0){
+            nWaitMs = static_cast<long>(std::ceil((1.0 - stState.fTokens) / stState.fRatePerSec * 1000));
+            return false;
+        }
+        stState.fTokens -= 1.0;
+    }
+
+    stState.nInFlight++;
+    stState.nStarted++;
+    return true;
+}
+
+void CHTTPHostLimiter::release(const std::string & strHost, const std::chrono::steady_clock::time_point & startedAt, const long nStatus,
+                               const std::optional<long> & nRetryAfterMs/*=std::nullopt*/)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    StHostEntry & stEntry = this->entryOf(strHost);
+    StHostLimitState & stState = stEntry.stState;
+    const StHostLimitParams & stParams = stEntry.stParams;
+    if(stState.nInFlight > 0)
+        stState.nInFlight--;
+
+    const double fMax = static_cast<double>(std::max<size_t>(stParams.nMaxConcurrency, 1));
+    const double fMin = std::min(static_cast<double>(std::max<size_t>(stParams.nMinConcurrency, 1)), fMax);
+    if(429 == nStatus || 503 == nStatus){
+        stState.nThrottled++;
+        if(startedAt >= stEntry.lastDecrease){
+            stState.fLimit = std::max(stState.fLimit * stParams.fDecrease, fMin);
+            stEntry.lastDecrease = now;
+            stState.nDecreases++;
+        }
+
+        if(nRetryAfterMs.has_value() && *nRetryAfterMs > 0)
+            stEntry.pausedUntil = std::max(stEntry.pausedUntil, now + std::chrono::milliseconds(std::min(*nRetryAfterMs, stParams.nMaxRetryAfterMs)));
+    }else if(nStatus > 0){
+        //a round of the limit requests growing it by fIncrease
+        stState.fLimit = std::min(stState.fLimit + stParams.fIncrease / std::max(stState.fLimit, 1.0), fMax);
+    }
+
+    stState.fRatePerSec = stParams.fRatePerSec * stState.fLimit / fMax;
+}
+
+std::optional<StHostLimitState> CHTTPHostLimiter::getState(const std::string & strHost) const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    auto iter = this->m_mpHosts.find(strHost);
+    if(this->m_mpHosts.end() == iter)
+        return std::nullopt;
+
+    return iter->second.stState;
+}
+
+CHTTPHostLimiter::StHostEntry & CHTTPHostLimiter::entryOf(const std::string & strHost)
+{
+    auto iter = this->m_mpHosts.find(strHost);
+    if(this->m_mpHosts.end() != iter)
+        return iter->second;
+
+    StHostEntry & stEntry = this->m_mpHosts[strHost];
+    CHTTPHostLimiter::reset(stEntry, this->m_stDefault);
+    return stEntry;
+}
+
+//starting at the full limit with the bucket full, backing off on the first rejection
+void CHTTPHostLimiter::reset(StHostEntry & stEntry, const StHostLimitParams & stParams)
+{
+    stEntry.stParams = stParams;
+    stEntry.stState = StHostLimitState();
+    stEntry.stState.fLimit = static_cast<double>(std::max<size_t>(stParams.nMaxConcurrency, 1));
+    stEntry.stState.fRatePerSec = stParams.fRatePerSec;
+    stEntry.stState.fTokens = stParams.fBurst;
+    stEntry.lastRefill = std::chrono::steady_clock::now();
+    stEntry.lastDecrease = std::chrono::steady_clock::time_point();
+    stEntry.pausedUntil = std::chrono::steady_clock::time_point();
+}
+
+std::optional<long> CHTTPHostLimiter::retryAfterMs(const std::string & strHeader)
+{
+    //the headers of the responses of the redirections and '100 Continue' being before the last
+    const size_t nStatusLine = strHeader.rfind("HTTP/");
+    std::string strLast = strHeader.substr(std::string::npos == nStatusLine ? 0 : nStatusLine);
+    std::transform(strLast.begin(), strLast.end(), strLast.begin(), [](unsigned char ch){ return std::tolower(ch); });
+
+    const size_t nFound = strLast.find("\nretry-after:");
+    if(std::string::npos == nFound)
+        return std::nullopt;
+
+    const size_t nBegin = strLast.find_first_not_of(" \t", nFound + 13);
+    const size_t nEnd = strLast.find_first_of("\r\n", nBegin);
+    if(std::string::npos == nBegin || nBegin == nEnd)
+        return std::nullopt;
+
+    //delta-seconds, or an HTTP date, the names of the months and the days being case-insensitive for curl_getdate
+    const std::string strValue = strLast.substr(nBegin, std::string::npos == nEnd ? std::string::npos : nEnd - nBegin);
+    if(std::isdigit(static_cast<unsigned char>(strValue[0])) && std::string::npos == strValue.find_first_not_of("0123456789")){
+        const long nSeconds = std::strtol(strValue.c_str(), nullptr, 10);
+        return nSeconds >= 0 && nSeconds < 86400 * 365 ? std::optional<long>(nSeconds * 1000) : std::nullopt;
+    }
+
+    const time_t nDate = curl_getdate(strValue.c_str(), nullptr);
+    if(nDate < 0)
+        return std::nullopt;
+
+    return static_cast<long>(std::max<time_t>(nDate - std::time(nullptr), 0) * 1000);
+}
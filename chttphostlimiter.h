@@ -0,0 +1,93 @@
+#ifndef CHTTPHOSTLIMITER_H
+#define CHTTPHOSTLIMITER_H
+
+/*
+ * CHTTPHostLimiter limits the requests to each host by a concurrency cap and a token bucket, being consulted by
+ * CHTTPAsyncEngine before starting a request, the requests over the limit being kept in the queue of the engine,
+ * so neither the caller nor any pool thread being blocked. CHTTPClient consulting it as well, the request over the
+ * limit being refused at once rather than waiting, the caller such as a task of a pool submitting it again later.
+ *
+ * The limit adapting by AIMD as TCP: growing by fIncrease each round of the limit requests succeeded, and being
+ * multiplied by fDecrease on 429 or 503, the rejections of the requests started before the last decrease being
+ * ignored, such a burst of the rejections of the same overload NOT collapsing it. The rate of the bucket being
+ * scaled with the limit, and 'Retry-After' pausing the host.
+ *
+ * Thread-safe, such a limiter being shared by the engines calling the same hosts.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+typedef struct ST_hostLimitParams{
+    size_t nMaxConcurrency = 64;
+    size_t nMinConcurrency = 1;
+    double fRatePerSec = 0;         //the requests started per second at the full limit, 0 for unlimited
+    double fBurst = 10;             //the tokens at most
+    double fIncrease = 1;
+    double fDecrease = 0.5;
+    long nMaxRetryAfterMs = 60000;  //the 'Retry-After' longer being capped
+}StHostLimitParams;
+
+typedef struct ST_hostLimitState{
+    double fLimit = 0;              //the concurrency limit by AIMD
+    double fRatePerSec = 0;         //scaled with the limit
+    double fTokens = 0;
+    size_t nInFlight = 0;
+    std::uint64_t nStarted = 0;
+    std::uint64_t nThrottled = 0;   //429 and 503 received
+    std::uint64_t nDecreases = 0;
+}StHostLimitState;
+
+class CHTTPHostLimiter
+{
+public:
+    explicit CHTTPHostLimiter(const StHostLimitParams & stParams = StHostLimitParams());
+    ~CHTTPHostLimiter() = default;
+
+    //copy constructor and assignment operator prohibited
+    CHTTPHostLimiter(const CHTTPHostLimiter & ) = delete;
+    CHTTPHostLimiter(const CHTTPHostLimiter && ) = delete;
+    CHTTPHostLimiter & operator=(const CHTTPHostLimiter &) = delete;
+    CHTTPHostLimiter & operator=(const CHTTPHostLimiter &&) = delete;
+
+    //the parameters of the host rather than the default, the state of the host being reset
+    void setHostParams(const std::string & strHost, const StHostLimitParams & stParams);
+
+    //start a request to the host, false when over the limit, nWaitMs being the time until a token or the pause
+    //over, 0 when limited by the concurrency, a request done making room then
+    bool tryAcquire(const std::string & strHost, long & nWaitMs);
+
+    //the request started by tryAcquire at startedAt done, nStatus being 0 on the transfer failed
+    void release(const std::string & strHost, const std::chrono::steady_clock::time_point & startedAt, const long nStatus,
+                 const std::optional<long> & nRetryAfterMs = std::nullopt);
+
+    std::optional<StHostLimitState> getState(const std::string & strHost) const;
+
+    //'Retry-After' of the last response in the raw headers, in seconds or an HTTP date
+    static std::optional<long> retryAfterMs(const std::string & strHeader);
+
+private:
+    typedef struct ST_hostEntry{
+        StHostLimitParams stParams;
+        StHostLimitState stState;
+        std::chrono::steady_clock::time_point lastRefill;
+        std::chrono::steady_clock::time_point lastDecrease;
+        std::chrono::steady_clock::time_point pausedUntil;
+    }StHostEntry;
+
+    StHostEntry & entryOf(const std::string & strHost);//with m_mtx held
+    static void reset(StHostEntry & stEntry, const StHostLimitParams & stParams);
+
+private:
+    const StHostLimitParams m_stDefault;
+
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::string, StHostEntry> m_mpHosts;
+};
+
+#endif // CHTTPHOSTLIMITER_H
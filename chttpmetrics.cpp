@@ -0,0 +1,140 @@
+#include "chttpmetrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+void CHTTPMetrics::record(const std::string & strHost, const StHTTPTransferStats & stStats, const bool bSuccess)
+{
+    //the timings of libcurl being cumulative, appconnect being 0 for the plain text
+    const std::int64_t nConnectReady = std::max(stStats.nConnectUs, stStats.nAppConnectUs);
+    const bool bNewConnection = stStats.nNewConnects > 0;
+
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    auto & pHost = this->m_mpHosts[strHost];
+    if(!pHost)
+        pHost = std::make_unique<StHostMetrics>();
+
+    StHostMetrics & stHost = *pHost;
+    stHost.nRequests++;
+    stHost.nNewConnections += static_cast<std::uint64_t>(std::max<long>(stStats.nNewConnects, 0));
+    stHost.nDownloadBytes += static_cast<std::uint64_t>(std::max<curl_off_t>(stStats.nDownloadWire, 0));
+    stHost.nUploadBytes += static_cast<std::uint64_t>(std::max<curl_off_t>(stStats.nUploadWire, 0));
+    if(!bSuccess){
+        stHost.nErrors++;
+        return ;//the timings of the phases NOT reached being 0
+    }
+
+    if(bNewConnection){
+        stHost.arrPhases[_EN_PHASE_DNS_].record(stStats.nNameLookupUs);
+        stHost.arrPhases[_EN_PHASE_CONNECT_].record(stStats.nConnectUs - stStats.nNameLookupUs);
+        if(stStats.nAppConnectUs > 0)
+            stHost.arrPhases[_EN_PHASE_TLS_].record(stStats.nAppConnectUs - stStats.nConnectUs);
+    }else{
+        stHost.nReused++;
+    }
+
+    stHost.arrPhases[_EN_PHASE_TTFB_].record(stStats.nStartTransferUs - (bNewConnection ? nConnectReady : 0));
+    stHost.arrPhases[_EN_PHASE_TRANSFER_].record(stStats.nTotalTimeUs - stStats.nStartTransferUs);
+    stHost.arrPhases[_EN_PHASE_TOTAL_].record(stStats.nTotalTimeUs);
+}
+
+std::vector<std::string> CHTTPMetrics::hosts() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    std::vector<std::string> vecHosts;
+    vecHosts.reserve(this->m_mpHosts.size());
+    for(const auto & item : this->m_mpHosts)
+        vecHosts.emplace_back(item.first);
+
+    std::sort(vecHosts.begin(), vecHosts.end());
+    return vecHosts;
+}
+
+std::optional<StHostMetrics> CHTTPMetrics::getHost(const std::string & strHost) const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    auto iter = this->m_mpHosts.find(strHost);
+    if(this->m_mpHosts.end() == iter)
+        return std::nullopt;
+
+    return *iter->second;
+}
+
+StHostMetrics CHTTPMetrics::getTotal() const
+{
+    StHostMetrics stTotal;
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    for(const auto & item : this->m_mpHosts)
+        CHTTPMetrics::merge(stTotal, *item.second);
+
+    return stTotal;
+}
+
+std::string CHTTPMetrics::dump() const
+{
+    std::string strDump;
+    char szLine[256] = {0};
+    for(const auto & strHost : this->hosts()){
+        auto && stHost = this->getHost(strHost);
+        if(!stHost.has_value())
+            continue;
+
+        snprintf(szLine, sizeof(szLine), "%s requests:%llu errors:%llu new connections:%llu reuse:%.1f%% down:%llu up:%llu\n",
+                 strHost.c_str(), static_cast<unsigned long long>(stHost->nRequests), static_cast<unsigned long long>(stHost->nErrors),
+                 static_cast<unsigned long long>(stHost->nNewConnections), stHost->reuseRate() * 100,
+                 static_cast<unsigned long long>(stHost->nDownloadBytes), static_cast<unsigned long long>(stHost->nUploadBytes));
+        strDump.append(szLine);
+
+        for(int ii = 0; ii < _EN_INVALID_PHASE_LAST_; ii++){
+            const CLatencyHistogram & hist = stHost->arrPhases[ii];
+            if(0 == hist.count())
+                continue;
+
+            snprintf(szLine, sizeof(szLine), "  %-9s count:%-8llu p50:%.3f p90:%.3f p99:%.3f p99.9:%.3f max:%.3f ms\n",
+                     CHTTPMetrics::phaseName(static_cast<HTTPPhase>(ii)), static_cast<unsigned long long>(hist.count()),
+                     hist.percentile(50) / 1000.0, hist.percentile(90) / 1000.0, hist.percentile(99) / 1000.0,
+                     hist.percentile(99.9) / 1000.0, hist.max() / 1000.0);
+            strDump.append(szLine);
+        }
+    }
+
+    return strDump;
+}
+
+void CHTTPMetrics::reset()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    this->m_mpHosts.clear();
+}
+
+const char * CHTTPMetrics::phaseName(const HTTPPhase enPhase)
+{
+    switch(enPhase){
+    case _EN_PHASE_DNS_:
+        return "dns";
+    case _EN_PHASE_CONNECT_:
+        return "connect";
+    case _EN_PHASE_TLS_:
+        return "tls";
+    case _EN_PHASE_TTFB_:
+        return "ttfb";
+    case _EN_PHASE_TRANSFER_:
+        return "transfer";
+    case _EN_PHASE_TOTAL_:
+        return "total";
+    default:
+        return "invalid";
+    }
+}
+
+void CHTTPMetrics::merge(StHostMetrics & stTo, const StHostMetrics & stFrom)
+{
+    stTo.nRequests += stFrom.nRequests;
+    stTo.nErrors += stFrom.nErrors;
+    stTo.nNewConnections += stFrom.nNewConnections;
+    stTo.nReused += stFrom.nReused;
+    stTo.nDownloadBytes += stFrom.nDownloadBytes;
+    stTo.nUploadBytes += stFrom.nUploadBytes;
+    for(int ii = 0; ii < _EN_INVALID_PHASE_LAST_; ii++)
+        stTo.arrPhases[ii].merge(stFrom.arrPhases[ii]);
+}
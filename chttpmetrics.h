@@ -0,0 +1,91 @@
+#ifndef CHTTPMETRICS_H
+#define CHTTPMETRICS_H
+
+/*
+ * CHTTPMetrics collects the timings of the HTTP requests into the latency histograms per host, by the phases derived
+ * from the timings of libcurl being measured from the start of the request:
+ *
+ *  DNS         namelookup
+ *  connect     connect - namelookup
+ *  TLS         appconnect - connect, the plain text connections NOT being counted
+ *  TTFB        starttransfer - the connection being ready, the request sent and the server working
+ *  transfer    total - starttransfer
+ *  total
+ *
+ * The phases of setting up the connection being recorded only for the new connections, such the reused ones NOT
+ * diluting them with zeros, the rate of the reuse being reported instead.
+ *
+ * Thread-safe, being shared by the clients and the engines by their setMetrics.
+ */
+
+#include "chttpclient.h"
+#include "clatencyhistogram.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+enum HTTPPhase{
+    _EN_PHASE_DNS_ = 0,
+    _EN_PHASE_CONNECT_,
+    _EN_PHASE_TLS_,
+    _EN_PHASE_TTFB_,
+    _EN_PHASE_TRANSFER_,
+    _EN_PHASE_TOTAL_,
+
+    //Do NOT Use the below
+    _EN_INVALID_PHASE_LAST_,
+};
+
+typedef struct ST_hostMetrics{
+    std::uint64_t nRequests = 0;
+    std::uint64_t nErrors = 0;          //the transfers failed, the responses of 4xx and 5xx NOT included
+    std::uint64_t nNewConnections = 0;
+    std::uint64_t nReused = 0;          //the requests succeeded on a connection reused
+    std::uint64_t nDownloadBytes = 0;   //on the wire
+    std::uint64_t nUploadBytes = 0;
+    CLatencyHistogram arrPhases[_EN_INVALID_PHASE_LAST_];//in microseconds
+
+    double reuseRate() const{
+        const std::uint64_t nSucceeded = this->nRequests - this->nErrors;
+        return 0 == nSucceeded ? 0.0 : static_cast<double>(this->nReused) / static_cast<double>(nSucceeded);
+    }
+}StHostMetrics;
+
+class CHTTPMetrics
+{
+public:
+    CHTTPMetrics() = default;
+    ~CHTTPMetrics() = default;
+
+    //copy constructor and assignment operator prohibited
+    CHTTPMetrics(const CHTTPMetrics & ) = delete;
+    CHTTPMetrics(const CHTTPMetrics && ) = delete;
+    CHTTPMetrics & operator=(const CHTTPMetrics &) = delete;
+    CHTTPMetrics & operator=(const CHTTPMetrics &&) = delete;
+
+    void record(const std::string & strHost, const StHTTPTransferStats & stStats, const bool bSuccess);
+
+    std::vector<std::string> hosts() const;
+    std::optional<StHostMetrics> getHost(const std::string & strHost) const;//a copy
+    StHostMetrics getTotal() const;//all the hosts merged
+
+    //a line of the counters and the lines of p50, p90, p99, p99.9 and max of each phase in milliseconds, each host
+    std::string dump() const;
+    void reset();
+
+    static const char * phaseName(const HTTPPhase enPhase);
+
+private:
+    static void merge(StHostMetrics & stTo, const StHostMetrics & stFrom);
+
+private:
+    mutable std::mutex m_mtx;
+    std::unordered_map<std::string, std::unique_ptr<StHostMetrics>> m_mpHosts;//the histograms being large, NOT being moved on rehash
+};
+
+#endif // CHTTPMETRICS_H
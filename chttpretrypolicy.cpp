@@ -0,0 +1,113 @@
+#include "chttpretrypolicy.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+    constexpr size_t g_nMinSamples = 32;//the percentile NOT being trusted below
+    constexpr size_t g_nRecomputeEvery = 32;//the percentile being recomputed after such samples, NOT on each request
+}
+
+CHTTPRetryPolicy::CHTTPRetryPolicy(const StHTTPRetryParams & stParams/*=StHTTPRetryParams()*/)
+    : m_stParams(stParams), m_fTokens(stParams.fBudgetCap), m_nHedgeDelayMs(stParams.nMaxHedgeDelayMs)
+{
+    this->m_vecLatencyUs.reserve(std::max<size_t>(stParams.nLatencyWindow, 1));
+}
+
+const StHTTPRetryParams & CHTTPRetryPolicy::getParams() const
+{
+    return this->m_stParams;
+}
+
+void CHTTPRetryPolicy::recordRequest()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    this->m_stStats.nRequests++;
+    this->m_fTokens = std::min(this->m_fTokens + this->m_stParams.fBudgetRatio, this->m_stParams.fBudgetCap);
+}
+
+void CHTTPRetryPolicy::recordLatency(const std::int64_t nLatencyUs)
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    const size_t nWindow = std::max<size_t>(this->m_stParams.nLatencyWindow, 1);
+    if(this->m_vecLatencyUs.size() < nWindow){
+        this->m_vecLatencyUs.emplace_back(nLatencyUs);
+    }else{
+        this->m_vecLatencyUs[this->m_nLatencyPos] = nLatencyUs;
+        this->m_nLatencyPos = (this->m_nLatencyPos + 1) % nWindow;
+    }
+
+    if(++this->m_nSinceComputed < g_nRecomputeEvery || this->m_vecLatencyUs.size() < g_nMinSamples)
+        return ;
+
+    this->m_nSinceComputed = 0;
+    std::vector<std::int64_t> vecSorted(this->m_vecLatencyUs);
+    const double fPercentile = std::clamp(this->m_stParams.fHedgePercentile, 0.0, 1.0);
+    const size_t nIndex = std::min(static_cast<size_t>(fPercentile * static_cast<double>(vecSorted.size())), vecSorted.size() - 1);
+    std::nth_element(vecSorted.begin(), vecSorted.begin() + static_cast<std::ptrdiff_t>(nIndex), vecSorted.end());
+
+    const long nDelayMs = static_cast<long>((vecSorted[nIndex] + 999) / 1000);
+    this->m_nHedgeDelayMs = std::clamp(nDelayMs, this->m_stParams.nMinHedgeDelayMs, this->m_stParams.nMaxHedgeDelayMs);
+}
+
+bool CHTTPRetryPolicy::acquireRetry()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    if(!this->acquireToken())
+        return false;
+
+    this->m_stStats.nRetries++;
+    return true;
+}
+
+bool CHTTPRetryPolicy::acquireHedge()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    if(!this->acquireToken())
+        return false;
+
+    this->m_stStats.nHedges++;
+    return true;
+}
+
+void CHTTPRetryPolicy::recordHedgeWin()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    this->m_stStats.nHedgeWins++;
+}
+
+long CHTTPRetryPolicy::hedgeDelayMs()
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    return this->m_nHedgeDelayMs;
+}
+
+//full jitter, uniform in [0, min(max, base * 2^(nAttempt - 1))], such the retries of the clients failing together NOT being synchronized
+long CHTTPRetryPolicy::backoffMs(const size_t nAttempt) const
+{
+    thread_local std::mt19937_64 engine{std::random_device{}()};
+
+    const size_t nShift = std::min<size_t>(nAttempt > 0 ? nAttempt - 1 : 0, 20);
+    const long nCeiling = std::min(this->m_stParams.nBaseBackoffMs << nShift, this->m_stParams.nMaxBackoffMs);
+    if(nCeiling <= 0)
+        return 0;
+
+    return std::uniform_int_distribution<long>(0, nCeiling)(engine);
+}
+
+StHTTPRetryStats CHTTPRetryPolicy::getStats() const
+{
+    std::lock_guard<std::mutex> lock_guard(this->m_mtx);
+    return this->m_stStats;
+}
+
+bool CHTTPRetryPolicy::acquireToken()
+{
+    if(this->m_fTokens < 1.0){
+        this->m_stStats.nBudgetDenied++;
+        return false;
+    }
+
+    this->m_fTokens -= 1.0;
+    return true;
+}
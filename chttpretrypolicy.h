@@ -0,0 +1,88 @@
+#ifndef CHTTPRETRYPOLICY_H
+#define CHTTPRETRYPOLICY_H
+
+/*
+ * CHTTPRetryPolicy holds the states shared by the clients for retrying and hedging the idempotent requests,
+ * by CHTTPClient::setRetryPolicy.
+ *
+ * The hedge delay being the percentile of the latencies recently recorded, a duplicate request being sent when the
+ * first one NOT responding within it, the first response winning and the other being cancelled. The retries being
+ * delayed by the exponential backoff with full jitter. Both the retries and the hedges drawing tokens from the
+ * retry budget, which being refilled by a ratio of the requests, such they NOT amplifying an overload beyond that
+ * ratio when all the requests failing.
+ *
+ * Thread-safe.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <mutex>
+
+typedef struct ST_httpRetryParams{
+    size_t nMaxAttempts = 3;            //including the first one, 1 for no retry
+    long nBaseBackoffMs = 50;
+    long nMaxBackoffMs = 1000;
+    double fBudgetRatio = 0.1;          //the tokens earned by each request
+    double fBudgetCap = 10;             //the tokens at the start and at most, the burst of the retries
+
+    bool bHedge = false;
+    double fHedgePercentile = 0.95;
+    long nMinHedgeDelayMs = 5;
+    long nMaxHedgeDelayMs = 1000;       //being used as well before enough latencies recorded
+    size_t nLatencyWindow = 1024;       //the latencies recently recorded for the percentile
+}StHTTPRetryParams;
+
+typedef struct ST_httpRetryStats{
+    std::uint64_t nRequests = 0;
+    std::uint64_t nRetries = 0;
+    std::uint64_t nHedges = 0;
+    std::uint64_t nHedgeWins = 0;       //the hedges responding first
+    std::uint64_t nBudgetDenied = 0;    //the retries and the hedges NOT sent for the budget exhausted
+}StHTTPRetryStats;
+
+class CHTTPRetryPolicy
+{
+public:
+    explicit CHTTPRetryPolicy(const StHTTPRetryParams & stParams = StHTTPRetryParams());
+    ~CHTTPRetryPolicy() = default;
+
+    //copy constructor and assignment operator prohibited
+    CHTTPRetryPolicy(const CHTTPRetryPolicy & ) = delete;
+    CHTTPRetryPolicy(const CHTTPRetryPolicy && ) = delete;
+    CHTTPRetryPolicy & operator=(const CHTTPRetryPolicy &) = delete;
+    CHTTPRetryPolicy & operator=(const CHTTPRetryPolicy &&) = delete;
+
+    const StHTTPRetryParams & getParams() const;
+
+    //a request being started, earning the tokens of the budget
+    void recordRequest();
+    //the latency of a response succeeding, in microseconds
+    void recordLatency(const std::int64_t nLatencyUs);
+
+    //draw a token for a retry or a hedge, false when the budget exhausted
+    bool acquireRetry();
+    bool acquireHedge();
+    void recordHedgeWin();
+
+    long hedgeDelayMs();
+    long backoffMs(const size_t nAttempt) const;//the delay before the retry nAttempt, from 1
+
+    StHTTPRetryStats getStats() const;
+
+private:
+    bool acquireToken();//with m_mtx held
+
+private:
+    const StHTTPRetryParams m_stParams;
+
+    mutable std::mutex m_mtx;
+    double m_fTokens;
+    std::vector<std::int64_t> m_vecLatencyUs;//ring buffer
+    size_t m_nLatencyPos = 0;
+    size_t m_nSinceComputed = 0;
+    long m_nHedgeDelayMs;
+    StHTTPRetryStats m_stStats;
+};
+
+#endif // CHTTPRETRYPOLICY_H
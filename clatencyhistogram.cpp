@@ -0,0 +1,99 @@
+#include "clatencyhistogram.h"
+
+#include <algorithm>
+
+void CLatencyHistogram::record(const std::int64_t nValue)
+{
+    const std::int64_t nClamped = std::clamp<std::int64_t>(nValue, 0, (std::int64_t(1) << g_nMaxBits) - 1);
+    this->m_arrCounts[CLatencyHistogram::bucketOf(nClamped)]++;
+
+    this->m_nMin = (0 == this->m_nCount) ? nClamped : std::min(this->m_nMin, nClamped);
+    this->m_nMax = (0 == this->m_nCount) ? nClamped : std::max(this->m_nMax, nClamped);
+    this->m_nCount++;
+    this->m_fSum += static_cast<double>(nClamped);
+}
+
+void CLatencyHistogram::merge(const CLatencyHistogram & other)
+{
+    if(0 == other.m_nCount)
+        return ;
+
+    for(size_t ii = 0; ii < g_nBucketCount; ii++)
+        this->m_arrCounts[ii] += other.m_arrCounts[ii];
+
+    this->m_nMin = (0 == this->m_nCount) ? other.m_nMin : std::min(this->m_nMin, other.m_nMin);
+    this->m_nMax = (0 == this->m_nCount) ? other.m_nMax : std::max(this->m_nMax, other.m_nMax);
+    this->m_nCount += other.m_nCount;
+    this->m_fSum += other.m_fSum;
+}
+
+void CLatencyHistogram::reset()
+{
+    this->m_arrCounts.fill(0);
+    this->m_nCount = 0;
+    this->m_nMin = 0;
+    this->m_nMax = 0;
+    this->m_fSum = 0;
+}
+
+std::uint64_t CLatencyHistogram::count() const
+{
+    return this->m_nCount;
+}
+
+std::int64_t CLatencyHistogram::min() const
+{
+    return this->m_nMin;
+}
+
+std::int64_t CLatencyHistogram::max() const
+{
+    return this->m_nMax;
+}
+
+double CLatencyHistogram::mean() const
+{
+    return 0 == this->m_nCount ? 0.0 : this->m_fSum / static_cast<double>(this->m_nCount);
+}
+
+std::int64_t CLatencyHistogram::percentile(const double fPercentile) const
+{
+    if(0 == this->m_nCount)
+        return 0;
+
+    //the rank of the value, 1 based, such p0 being the minimum and p100 being the maximum
+    const double fRank = std::clamp(fPercentile, 0.0, 100.0) / 100.0 * static_cast<double>(this->m_nCount);
+    const std::uint64_t nRank = std::max<std::uint64_t>(static_cast<std::uint64_t>(fRank + 0.5), 1);
+
+    std::uint64_t nSeen = 0;
+    for(size_t ii = 0; ii < g_nBucketCount; ii++){
+        nSeen += this->m_arrCounts[ii];
+        if(nSeen >= nRank)
+            return std::clamp(CLatencyHistogram::highestOf(ii), this->m_nMin, this->m_nMax);
+    }
+
+    return this->m_nMax;
+}
+
+//the values in [2^k, 2^(k+1)) for k >= 7 being split by their top 7 bits, the highest bit always being 1
+size_t CLatencyHistogram::bucketOf(const std::int64_t nValue)
+{
+    if(nValue < g_nLinearLimit)
+        return static_cast<size_t>(nValue);
+
+    const int nMagnitude = 63 - __builtin_clzll(static_cast<unsigned long long>(nValue));//7 at least
+    const int nShift = nMagnitude - g_nSubBucketBits;
+    const std::int64_t nSubBucket = (nValue >> nShift) - g_nSubBucketCount;//0 ~ 63
+    return static_cast<size_t>(g_nLinearLimit + (nShift - 1) * g_nSubBucketCount + nSubBucket);
+}
+
+std::int64_t CLatencyHistogram::highestOf(const size_t nBucket)
+{
+    if(static_cast<std::int64_t>(nBucket) < g_nLinearLimit)
+        return static_cast<std::int64_t>(nBucket);
+
+    const std::int64_t nIndex = static_cast<std::int64_t>(nBucket) - g_nLinearLimit;
+    const int nShift = static_cast<int>(nIndex / g_nSubBucketCount) + 1;
+    const std::int64_t nSubBucket = nIndex % g_nSubBucketCount + g_nSubBucketCount;
+    return ((nSubBucket + 1) << nShift) - 1;
+}
@@ -0,0 +1,52 @@
+#ifndef CLATENCYHISTOGRAM_H
+#define CLATENCYHISTOGRAM_H
+
+/*
+ * CLatencyHistogram counts the values into the log-linear buckets as HdrHistogram, the values below 128 being counted
+ * exactly, each power of 2 above being split into 64 buckets, such the relative error being below 1/64 over the
+ * whole range of 2^42, and recording being an index computed by a shift without any search or allocation.
+ *
+ * NOT thread-safe, the owner locking it.
+ */
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+class CLatencyHistogram
+{
+public:
+    static constexpr int g_nSubBucketBits = 6;
+    static constexpr std::int64_t g_nSubBucketCount = std::int64_t(1) << g_nSubBucketBits;     //64 buckets each power of 2
+    static constexpr std::int64_t g_nLinearLimit = g_nSubBucketCount * 2;                      //the values below being exact
+    static constexpr int g_nMaxBits = 42;                                                      //about 50 days in microseconds
+    static constexpr size_t g_nBucketCount = static_cast<size_t>(g_nLinearLimit + (g_nMaxBits - g_nSubBucketBits - 1) * g_nSubBucketCount);
+
+    CLatencyHistogram() = default;
+
+    //the negative values being counted as 0, the values beyond the range as the maximum
+    void record(const std::int64_t nValue);
+    void merge(const CLatencyHistogram & other);
+    void reset();
+
+    std::uint64_t count() const;
+    std::int64_t min() const;
+    std::int64_t max() const;
+    double mean() const;
+
+    //the highest value equivalent to the bucket of the percentile, fPercentile in [0, 100]
+    std::int64_t percentile(const double fPercentile) const;
+
+private:
+    static size_t bucketOf(const std::int64_t nValue);
+    static std::int64_t highestOf(const size_t nBucket);
+
+private:
+    std::array<std::uint64_t, g_nBucketCount> m_arrCounts{};
+    std::uint64_t m_nCount = 0;
+    std::int64_t m_nMin = 0;
+    std::int64_t m_nMax = 0;
+    double m_fSum = 0;
+};
+
+#endif // CLATENCYHISTOGRAM_H
@@ -2,6 +2,11 @@
 
 #include "cdbmanager.h"
 
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <mutex>
+
 /*
 CMySQL::CMySQL(const StDBParams & stDBParams)//:m_pConn(nullptr, &mysql_close)
 {
@@ -117,20 +122,162 @@ bool CMySQL::query_table(std::vector<StCourse> & vecResult)
 
     //access the result of such the query
     for(size_t ii = 0; ii < records.size(); ii++){
-        StCourse stTemp;
-        stTemp.nID = records.getItem<std::int64_t>(ii, "id");
-        stTemp.strCourseName = records.getItem<std::string>(ii, std::string("name"));
-        stTemp.nRelatedID = records.getItem<std::uint64_t>(ii, std::string("t_id"));
-        stTemp.fFloat = records.getItem<float>(ii, "float");
-        stTemp.fDouble = records.getItem<double>(ii, "double");
-        stTemp.nDecimal = records.getItem<int>(ii, "decimal");
-        stTemp.time = records.getItem<StTime>(ii, "time");
-        stTemp.date = records.getItem<StDate>(ii, "date");
-        stTemp.datetime = records.getItem<StDateTime>(ii, "datetime");
-        stTemp.point = records.getItem<StPoint<int>>(ii, "point");
-        stTemp.rect = records.getItem<StRect<int>>(ii, "rectangle");
-        vecResult.emplace_back(stTemp);
+        vecResult.emplace_back(toCourse(records, ii));
     }
 
     return true;
 }
+
+bool CMySQL::query_table(CCourseTable & table)
+{
+    const std::string strSQL = "select * from course";
+    table.clear();
+
+    auto && query_result = DBOPT.query(strSQL);
+    if(!query_result.has_value())
+        return false;
+
+    auto && pairResult = query_result->get();
+    if(!pairResult.first.empty()){
+        std::cout << "Db operation error message:"  << pairResult.first << std::endl;
+        return false;
+    }
+    auto && records = pairResult.second;
+
+    table.reserve(records.size());
+    for(size_t ii = 0; ii < records.size(); ii++){
+        table.append(toCourse(records, ii));
+    }
+
+    return true;
+}
+
+bool CMySQL::query_table_parallel(std::vector<StCourse> & vecResult, const size_t nPartitions/*=4*/)
+{
+    vecResult.clear();
+
+    std::vector<std::vector<StCourse>> vecPartitions(std::max<size_t>(nPartitions, 1));
+    auto merge_lambda = [&vecPartitions](const size_t nPartition, std::vector<StCourse> && vecPartition){
+        vecPartitions[nPartition] = std::move(vecPartition);
+    };
+
+    if(!this->query_table_parallel(nPartitions, merge_lambda))
+        return false;
+
+    size_t nTotal = 0;
+    for(const auto & vecPartition : vecPartitions)
+        nTotal += vecPartition.size();
+
+    //the partitions being split by ascending primary key ranges
+    vecResult.reserve(nTotal);
+    for(auto & vecPartition : vecPartitions)
+        std::move(vecPartition.begin(), vecPartition.end(), std::back_inserter(vecResult));
+
+    return true;
+}
+
+bool CMySQL::query_table_parallel(const size_t nPartitions, partitionCallback callback)
+{
+    const size_t nCount = std::max<size_t>(nPartitions, 1);
+    if(!callback)
+        return false;
+
+    //the primary key range of the table
+    auto && range_result = DBOPT.query("select min(id) as min_id, max(id) as max_id from course");
+    if(!range_result.has_value())
+        return false;
+
+    auto && pairRange = range_result->get();
+    if(!pairRange.first.empty()){
+        std::cout << "Db operation error message:"  << pairRange.first << std::endl;
+        return false;
+    }
+
+    //an empty table, min(id) and max(id) being NULL
+    if(pairRange.second.empty() || "NULL" == pairRange.second.at(0).at("min_id"))
+        return true;
+
+    const std::int64_t nMinID = pairRange.second.getItem<std::int64_t>(0, "min_id");
+    const std::int64_t nMaxID = pairRange.second.getItem<std::int64_t>(0, "max_id");
+
+    //the span being unsigned, the ids near INT64_MIN and INT64_MAX NOT overflowing, nStep being 0 only if the span being
+    //the whole int64 with one partition, which being the last one
+    const std::uint64_t nSpan = static_cast<std::uint64_t>(nMaxID) - static_cast<std::uint64_t>(nMinID);
+    const std::uint64_t nStep = nSpan / nCount + 1;
+
+    //all the partitions being submitted at once, and running concurrently on the threads and conns of the DB manager
+    std::vector<std::shared_future<std::pair<std::string, query_result>>> vecFutures;
+    for(size_t ii = 0; ii < nCount; ii++){
+        std::string strSQL;
+        if(0 != nStep && ii > nSpan / nStep){
+            //beyond max(id), an empty partition
+            strSQL = std::string("select * from course where id > ") + std::to_string(nMaxID);
+        }else{
+            //the last partition bounded by the lower only, so NO upper bound beyond max(id) being built
+            const std::uint64_t nOffset = nStep * ii;
+            const std::int64_t nLower = static_cast<std::int64_t>(static_cast<std::uint64_t>(nMinID) + nOffset);
+            strSQL = std::string("select * from course where id >= ") + std::to_string(nLower);
+            if(0 != nStep && nSpan - nOffset >= nStep)
+                strSQL += std::string(" and id < ") + std::to_string(static_cast<std::int64_t>(static_cast<std::uint64_t>(nLower) + nStep));
+            strSQL += std::string(" order by id");
+        }
+
+        auto && query_result = DBOPT.query(strSQL);
+        if(!query_result.has_value())
+            return false;
+
+        vecFutures.emplace_back(query_result->share());
+    }
+
+    //decode the partitions in parallel, each being decoded as soon as its query completed
+    std::mutex mtxCallback;
+    std::atomic<bool> bOK(true);
+    {
+        UT::CThreadPool decodePool(nCount);
+        std::vector<std::future<void>> vecDecoded;
+        for(size_t ii = 0; ii < nCount; ii++){
+            auto decode_lambda = [ii, future = vecFutures[ii], &callback, &mtxCallback, &bOK](){
+                const auto & pairResult = future.get();
+                if(!pairResult.first.empty()){
+                    std::cout << "Db operation error message:"  << pairResult.first << std::endl;
+                    bOK.store(false);
+                    return ;
+                }
+
+                std::vector<StCourse> vecPartition;
+                vecPartition.reserve(pairResult.second.size());
+                for(size_t jj = 0; jj < pairResult.second.size(); jj++){
+                    vecPartition.emplace_back(toCourse(pairResult.second, jj));
+                }
+
+                std::lock_guard<std::mutex> lock_guard(mtxCallback);
+                callback(ii, std::move(vecPartition));
+            };
+
+            vecDecoded.emplace_back(decodePool.addTask(decode_lambda));
+        }
+
+        for(auto & item : vecDecoded)
+            item.get();//rethrow the decoding exception if any
+    }
+
+    return bOK.load();
+}
+
+//decode the given row of the query result of table course
+StCourse CMySQL::toCourse(const query_result & records, const size_t nIndex)
+{
+    StCourse stTemp;
+    stTemp.nID = records.getItem<std::int64_t>(nIndex, "id");
+    stTemp.strCourseName = records.getItem<std::string>(nIndex, std::string("name"));
+    stTemp.nRelatedID = records.getItem<std::uint64_t>(nIndex, std::string("t_id"));
+    stTemp.fFloat = records.getItem<float>(nIndex, "float");
+    stTemp.fDouble = records.getItem<double>(nIndex, "double");
+    stTemp.nDecimal = records.getItem<int>(nIndex, "decimal");
+    stTemp.time = records.getItem<StTime>(nIndex, "time");
+    stTemp.date = records.getItem<StDate>(nIndex, "date");
+    stTemp.datetime = records.getItem<StDateTime>(nIndex, "datetime");
+    stTemp.point = records.getItem<StPoint<int>>(nIndex, "point");
+    stTemp.rect = records.getItem<StRect<int>>(nIndex, "rectangle");
+    return stTemp;
+}
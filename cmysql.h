@@ -2,6 +2,11 @@
 #define CMYSQL_H
 
 #include "data_type_defination.h"
+#include "cdbmanager.h"
+#include "ccoursetable.h"
+
+#include <vector>
+#include <functional>
 
 // such the class being designed to focus on the basic db operation
 
@@ -20,6 +25,21 @@ public:
 
     bool query_table(std::vector<StCourse> & vecResult);
 
+    //same as the above, but the rows being decoded into the columnar table for the analytic scans
+    bool query_table(CCourseTable & table);
+
+    //scan the table split into nPartitions primary key ranges, the ranges being queried concurrently on separate pooled conns
+    //and decoded in parallel, the result being merged in primary key order
+    bool query_table_parallel(std::vector<StCourse> & vecResult, const size_t nPartitions = 4);
+
+    //same as the above, but each partition being handed out as soon as it decoded, the callback being invoked one at a time
+    //from the decoding threads, return false when any partition failed
+    using partitionCallback = std::function<void(const size_t nPartition, std::vector<StCourse> && vecPartition)>;
+    bool query_table_parallel(const size_t nPartitions, partitionCallback callback);
+
+    //decode the given row of the query result of table course
+    static StCourse toCourse(const query_result & records, const size_t nIndex);
+
     // template<class T>
     // T getItem(const size_t nIndex, const std::string & strFieldName);
 
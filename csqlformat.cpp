@@ -0,0 +1,104 @@
+#include "csqlformat.h"
+
+#include <sstream>
+
+//quote the given raw string as a sql string literal, special characters being escaped
+std::string CSQLFormat::quote(const std::string & strRaw)
+{
+    std::string strRet;
+    strRet.reserve(strRaw.size() + 2);
+
+    strRet += '\'';
+    for(const char ch : strRaw){
+        switch(ch){
+        case '\0':   strRet += "\\0";  break;
+        case '\n':   strRet += "\\n";  break;
+        case '\r':   strRet += "\\r";  break;
+        case '\x1a': strRet += "\\Z";  break;
+        case '\'':   strRet += "''";   break;//doubled, ending NOT the literal even under NO_BACKSLASH_ESCAPES
+        case '"':    strRet += "\\\""; break;
+        case '\\':   strRet += "\\\\"; break;
+        default:     strRet += ch;     break;
+        }
+    }
+    strRet += '\'';
+
+    return strRet;
+}
+
+//format a row as a parenthesized value list "(v1,v2,...)"
+std::string CSQLFormat::toValues(const StCourse & stCourse)
+{
+    //the temporal fields being written with the same text format as they being read, the geometry fields being
+    //converted from WKT by the server, the columns being spatial
+    auto toText = [](const auto & value)->std::string{
+        std::ostringstream oss;
+        oss << value;
+        return oss.str();
+    };
+
+    std::ostringstream oss;
+    oss.precision(17);//keep the double lossless
+    oss << '(' << stCourse.nID
+        << ',' << quote(stCourse.strCourseName)
+        << ',' << stCourse.nRelatedID
+        << ',' << stCourse.fFloat
+        << ',' << stCourse.fDouble
+        << ',' << stCourse.nDecimal
+        << ',' << quote(toText(stCourse.date))
+        << ',' << quote(toText(stCourse.time))
+        << ',' << quote(toText(stCourse.datetime))
+        << ",ST_GeomFromText(" << quote(toWKT(stCourse.point)) << ')'
+        << ",ST_GeomFromText(" << quote(toWKT(stCourse.rect)) << ')'
+        << ')';
+
+    return oss.str();
+}
+
+//append a row as a tab separated line terminated by '\n' into the buffer
+void CSQLFormat::appendTSV(std::string & strBuffer, const StCourse & stCourse)
+{
+    auto toText = [](const auto & value)->std::string{
+        std::ostringstream oss;
+        oss.precision(17);
+        oss << value;
+        return oss.str();
+    };
+
+    strBuffer += std::to_string(stCourse.nID);
+    strBuffer += '\t';
+    appendField(strBuffer, stCourse.strCourseName);
+    strBuffer += '\t';
+    strBuffer += std::to_string(stCourse.nRelatedID);
+    strBuffer += '\t';
+    strBuffer += toText(stCourse.fFloat);
+    strBuffer += '\t';
+    strBuffer += toText(stCourse.fDouble);
+    strBuffer += '\t';
+    strBuffer += std::to_string(stCourse.nDecimal);
+    strBuffer += '\t';
+    strBuffer += toText(stCourse.date);
+    strBuffer += '\t';
+    strBuffer += toText(stCourse.time);
+    strBuffer += '\t';
+    strBuffer += toText(stCourse.datetime);
+    strBuffer += '\t';
+    strBuffer += toWKT(stCourse.point);
+    strBuffer += '\t';
+    strBuffer += toWKT(stCourse.rect);
+    strBuffer += '\n';
+}
+
+void CSQLFormat::appendField(std::string & strBuffer, const std::string & strField)
+{
+    for(const char ch : strField){
+        switch(ch){
+        case '\0': strBuffer += "\\0";  break;
+        case '\t': strBuffer += "\\t";  break;
+        case '\n': strBuffer += "\\n";  break;
+        case '\r': strBuffer += "\\r";  break;
+        case '\\': strBuffer += "\\\\"; break;
+        default:   strBuffer += ch;     break;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef CSQLFORMAT_H
+#define CSQLFORMAT_H
+
+#include "data_type_defination.h"
+
+#include <string>
+
+// such the class being designed to format the typed rows into sql text for the write path
+
+class CSQLFormat
+{
+public:
+    CSQLFormat() = delete;
+
+    //quote the given raw string as a sql string literal, special characters being escaped by backslash,
+    //NOTE: the sql_mode NO_BACKSLASH_ESCAPES being NOT supported, the backslashes being kept literally then
+    static std::string quote(const std::string & strRaw);
+
+    //format a row as a parenthesized value list "(v1,v2,...)", matching the column order of g_strCourseColumns
+    static std::string toValues(const StCourse & stCourse);
+
+    //append a row as a tab separated line terminated by '\n' into the buffer, being the default format of 'load data',
+    //the geometry fields being written as WKT, loaded by the columns g_strCourseLoadColumns and g_strCourseLoadSet
+    static void appendTSV(std::string & strBuffer, const StCourse & stCourse);
+
+    //the WKT of the geometry, such as 'POINT(x y)', and the rect as the POLYGON of its four corners
+    template<class T>
+    static std::string toWKT(const StPoint<T> & point){
+        return std::string("POINT(") + std::to_string(point.x) + ' ' + std::to_string(point.y) + ')';
+    }
+
+    template<class T>
+    static std::string toWKT(const StRect<T> & rect){
+        const std::string strX1 = std::to_string(rect.leftTop.x), strY1 = std::to_string(rect.leftTop.y);
+        const std::string strX2 = std::to_string(rect.rightBottom.x), strY2 = std::to_string(rect.rightBottom.y);
+        return std::string("POLYGON((") + strX1 + ' ' + strY1 + ',' + strX2 + ' ' + strY1 + ',' + strX2 + ' ' + strY2
+               + ',' + strX1 + ' ' + strY2 + ',' + strX1 + ' ' + strY1 + "))";
+    }
+
+private:
+    //append the field escaped for 'load data', such as tab, newline and backslash
+    static void appendField(std::string & strBuffer, const std::string & strField);
+
+public:
+    //column list of the table course, in the order of the values formatted by toValues
+    inline static const std::string g_strCourseColumns = "id,name,t_id,`float`,`double`,`decimal`,date,time,datetime,point,rectangle";
+
+    //column list and set clause of 'load data' for the lines formatted by appendTSV, the WKT of the geometry fields
+    //being read into the variables and converted by ST_GeomFromText
+    inline static const std::string g_strCourseLoadColumns = "id,name,t_id,`float`,`double`,`decimal`,date,time,datetime,@point,@rectangle";
+    inline static const std::string g_strCourseLoadSet = "point=ST_GeomFromText(@point),rectangle=ST_GeomFromText(@rectangle)";
+};
+
+#endif // CSQLFORMAT_H
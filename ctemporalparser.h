@@ -0,0 +1,185 @@
+#ifndef CTEMPORALPARSER_H
+#define CTEMPORALPARSER_H
+
+/*
+ * CTemporalParser parses the fixed-width temporal strings returned by MySQL, such as 'YYYY-MM-DD', 'HH:MM:SS' and
+ * 'YYYY-MM-DD HH:MM:SS', without iostream. 8 chars being loaded into a 64 bits integer at once, all the digits and
+ * separators being validated and converted by SWAR(SIMD within a register) arithmetic, which being portable to both
+ * x86 and arm. The other formats, such as '-838:59:59' of the TIME type, being reported as errors, and the caller
+ * could fall back to the operator>> of the types.
+ */
+
+#include "data_type_defination.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum ParseCode{
+    EN_PARSE_OK = 0,
+
+    EN_PARSE_INVALID_LENGTH,
+    EN_PARSE_INVALID_DIGIT,
+    EN_PARSE_INVALID_SEPARATOR,
+    EN_PARSE_OUT_OF_RANGE,
+
+    EN_PARSE_LAST,  //not using
+};
+
+class CTemporalParser
+{
+public:
+    CTemporalParser() = delete;
+
+    //parse 'YYYY-MM-DD'
+    static ParseCode parse(const std::string_view strValue, StDate & date)
+    {
+        if(strValue.size() != 10)
+            return EN_PARSE_INVALID_LENGTH;
+
+        //'YYYY-MM-' and 'YY-MM-DD', the later overlapping the former to avoid reading beyond the value
+        const std::uint64_t nHead = load8(strValue.data());
+        const std::uint64_t nTail = load8(strValue.data() + 2);
+        if(!isDigits(nHead, 0x00FFFF00FFFFFFFFULL) || !isDigits(nTail, 0xFFFF000000000000ULL))
+            return EN_PARSE_INVALID_DIGIT;
+
+        if((nHead & 0xFF0000FF00000000ULL) != 0x2D00002D00000000ULL)//'-' at 4 and 7
+            return EN_PARSE_INVALID_SEPARATOR;
+
+        const std::uint64_t nDigits = toDigits(nHead, 0x00FFFF00FFFFFFFFULL);
+        date.nYear = toNumber4(nDigits);
+        date.nMonth = toNumber2(nDigits, 5);
+        date.nDay = toNumber2(toDigits(nTail, 0xFFFF000000000000ULL), 6);
+
+        //zero date '0000-00-00' being valid in MySQL
+        if(date.nMonth > 12 || date.nDay > 31)
+            return EN_PARSE_OUT_OF_RANGE;
+
+        return EN_PARSE_OK;
+    }
+
+    //parse 'HH:MM:SS', the fractional seconds such as '.123456' being ignored
+    static ParseCode parse(const std::string_view strValue, StTime & time)
+    {
+        if(strValue.size() < 8 || !isFraction(strValue.substr(8)))
+            return EN_PARSE_INVALID_LENGTH;
+
+        const std::uint64_t nValue = load8(strValue.data());
+        if(!isDigits(nValue, 0xFFFF00FFFF00FFFFULL))
+            return EN_PARSE_INVALID_DIGIT;
+
+        if((nValue & 0x0000FF0000FF0000ULL) != 0x00003A00003A0000ULL)//':' at 2 and 5
+            return EN_PARSE_INVALID_SEPARATOR;
+
+        const std::uint64_t nDigits = toDigits(nValue, 0xFFFF00FFFF00FFFFULL);
+        time.nHour = toNumber2(nDigits, 0);
+        time.nMinute = toNumber2(nDigits, 3);
+        time.nSecond = toNumber2(nDigits, 6);
+
+        if(time.nMinute > 59 || time.nSecond > 59)
+            return EN_PARSE_OUT_OF_RANGE;
+
+        return EN_PARSE_OK;
+    }
+
+    //parse 'YYYY-MM-DD HH:MM:SS', the fractional seconds such as '.123456' being ignored
+    static ParseCode parse(const std::string_view strValue, StDateTime & dateTime)
+    {
+        if(strValue.size() < 19)
+            return EN_PARSE_INVALID_LENGTH;
+
+        if(' ' != strValue[10])
+            return EN_PARSE_INVALID_SEPARATOR;
+
+        const ParseCode enCode = parse(strValue.substr(0, 10), dateTime.date);
+        if(EN_PARSE_OK != enCode)
+            return enCode;
+
+        return parse(strValue.substr(11), dateTime.time);
+    }
+
+    //parse a whole column at once, return the count of the values parsed OK,
+    //the code of each value being put into pCodes when it is NOT nullptr
+    template<class TString, class T>
+    static size_t parseColumn(const std::vector<TString> & vecValues, std::vector<T> & vecResult, std::vector<ParseCode> * pCodes = nullptr)
+    {
+        vecResult.resize(vecValues.size());
+        if(pCodes)
+            pCodes->resize(vecValues.size());
+
+        size_t nOKCount = 0;
+        for(size_t ii = 0; ii < vecValues.size(); ii++){
+            const ParseCode enCode = parse(std::string_view(vecValues[ii]), vecResult[ii]);
+            nOKCount += (EN_PARSE_OK == enCode);
+            if(pCodes)
+                (*pCodes)[ii] = enCode;
+        }
+
+        return nOKCount;
+    }
+
+private:
+    //load 8 chars as an integer, the first char being the lowest byte
+    static std::uint64_t load8(const char * pData)
+    {
+        std::uint64_t nValue = 0;
+        std::memcpy(&nValue, pData, sizeof(nValue));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        nValue = __builtin_bswap64(nValue);
+#endif
+        return nValue;
+    }
+
+    //whether all the bytes selected by the mask being '0'~'9', the high nibble being 3 both before and after adding 6
+    static bool isDigits(const std::uint64_t nValue, const std::uint64_t nMask)
+    {
+        const std::uint64_t nHighNibble = 0xF0F0F0F0F0F0F0F0ULL & nMask;
+        const std::uint64_t nZero = 0x3030303030303030ULL & nMask;
+        const std::uint64_t nSelected = nValue & nMask;
+
+        return ((nSelected & nHighNibble) == nZero) && (((nSelected + (0x0606060606060606ULL & nMask)) & nHighNibble) == nZero);
+    }
+
+    //convert the chars selected by the mask into the digit values, the separators being cleared first
+    //to avoid borrowing from the neighbor bytes
+    static std::uint64_t toDigits(const std::uint64_t nValue, const std::uint64_t nMask)
+    {
+        return (nValue & nMask) - (0x3030303030303030ULL & nMask);
+    }
+
+    //the number of 4 digits at the byte 0~3
+    static int toNumber4(const std::uint64_t nDigits)
+    {
+        std::uint64_t nValue = nDigits & 0xFFFFFFFFULL;
+        nValue = (nValue * 10 + (nValue >> 8)) & 0x00FF00FFULL;//2 digits in each 16 bits
+        nValue = (nValue * 100 + (nValue >> 16)) & 0xFFFFULL;
+        return static_cast<int>(nValue);
+    }
+
+    //the number of 2 digits at the byte nPos and nPos + 1
+    static int toNumber2(const std::uint64_t nDigits, const int nPos)
+    {
+        return static_cast<int>(((nDigits >> (nPos * 8)) & 0xFF) * 10 + ((nDigits >> (nPos * 8 + 8)) & 0xFF));
+    }
+
+    //empty or fractional seconds such as '.123456', at least one digit after the dot
+    static bool isFraction(const std::string_view strValue)
+    {
+        if(strValue.empty())
+            return true;
+
+        if('.' != strValue[0] || 1 == strValue.size())
+            return false;
+
+        for(size_t ii = 1; ii < strValue.size(); ii++){
+            if(strValue[ii] < '0' || strValue[ii] > '9')
+                return false;
+        }
+
+        return true;
+    }
+};
+
+#endif // CTEMPORALPARSER_H
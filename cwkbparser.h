@@ -0,0 +1,222 @@
+#ifndef CWKBPARSER_H
+#define CWKBPARSER_H
+
+/*
+ * CWKBParser decodes the geometry values in the internal format of MySQL, a 4 bytes SRID followed by the WKB(well-known
+ * binary), which being returned as is by 'select' for the geometry columns, so neither ST_AsText on the server nor the
+ * text parsing on the client being needed. The pure WKB, such as the result of ST_AsBinary, being supported as well.
+ *
+ *  POINT       -> StPoint
+ *  POLYGON     -> StRect, the bounding box of the exterior ring, leftTop being (minX, minY) and rightBottom being (maxX, maxY)
+ *  POLYGON     -> StCircle, the circle approximated by ST_Buffer(point, radius), pivol being the center of the bounding box
+ */
+
+#include "data_type_defination.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string_view>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+enum WKBCode{
+    EN_WKB_OK = 0,
+
+    EN_WKB_INVALID_LENGTH,
+    EN_WKB_INVALID_BYTE_ORDER,
+    EN_WKB_UNSUPPORTED_TYPE,
+    EN_WKB_EMPTY_GEOMETRY,
+
+    EN_WKB_LAST,    //not using
+};
+
+class CWKBParser
+{
+public:
+    CWKBParser() = delete;
+
+    //whether the type being decodable from WKB
+    template<class T> struct isGeometry : std::false_type {};
+    template<class U> struct isGeometry<StPoint<U>> : std::true_type {};
+    template<class U> struct isGeometry<StRect<U>> : std::true_type {};
+    template<class U> struct isGeometry<StCircle<U>> : std::true_type {};
+
+    //circle having no text format, being decodable from WKB only
+    template<class T> struct isCircle : std::false_type {};
+    template<class U> struct isCircle<StCircle<U>> : std::true_type {};
+
+    //decode a POINT
+    template<class T>
+    static WKBCode decode(const std::string_view strValue, StPoint<T> & point, const bool bWithSRID = true)
+    {
+        CReader reader(strValue);
+        WKBCode enCode = reader.begin(bWithSRID, _EN_WKB_POINT_);
+        if(EN_WKB_OK != enCode)
+            return enCode;
+
+        double fX = 0.0, fY = 0.0;
+        if(!reader.readDouble(fX) || !reader.readDouble(fY))
+            return EN_WKB_INVALID_LENGTH;
+
+        point.x = convert<T>(fX);
+        point.y = convert<T>(fY);
+        return EN_WKB_OK;
+    }
+
+    //decode a POLYGON as its bounding box
+    template<class T>
+    static WKBCode decode(const std::string_view strValue, StRect<T> & rect, const bool bWithSRID = true)
+    {
+        double fMinX = 0.0, fMinY = 0.0, fMaxX = 0.0, fMaxY = 0.0;
+        const WKBCode enCode = decodeBox(strValue, bWithSRID, fMinX, fMinY, fMaxX, fMaxY);
+        if(EN_WKB_OK != enCode)
+            return enCode;
+
+        rect.leftTop.x = convert<T>(fMinX);
+        rect.leftTop.y = convert<T>(fMinY);
+        rect.rightBottom.x = convert<T>(fMaxX);
+        rect.rightBottom.y = convert<T>(fMaxY);
+        return EN_WKB_OK;
+    }
+
+    //decode a POLYGON made by ST_Buffer(point, radius) as a circle
+    template<class T>
+    static WKBCode decode(const std::string_view strValue, StCircle<T> & circle, const bool bWithSRID = true)
+    {
+        double fMinX = 0.0, fMinY = 0.0, fMaxX = 0.0, fMaxY = 0.0;
+        const WKBCode enCode = decodeBox(strValue, bWithSRID, fMinX, fMinY, fMaxX, fMaxY);
+        if(EN_WKB_OK != enCode)
+            return enCode;
+
+        circle.pivol.x = convert<T>((fMinX + fMaxX) / 2);
+        circle.pivol.y = convert<T>((fMinY + fMaxY) / 2);
+        circle.radius = convert<T>((fMaxX - fMinX) / 2);
+        return EN_WKB_OK;
+    }
+
+private:
+    enum WKBType{
+        _EN_WKB_POINT_ = 1,
+        _EN_WKB_POLYGON_ = 3,
+    };
+
+    //bounds checked reader honoring the byte order flag of the WKB
+    class CReader{
+    public:
+        explicit CReader(const std::string_view strValue):m_strValue(strValue){}
+
+        //skip the SRID, and check the byte order and the geometry type
+        WKBCode begin(const bool bWithSRID, const std::uint32_t nType)
+        {
+            if(bWithSRID && !this->skip(4))
+                return EN_WKB_INVALID_LENGTH;
+
+            if(this->m_nOffset >= this->m_strValue.size())
+                return EN_WKB_INVALID_LENGTH;
+
+            const char chOrder = this->m_strValue[this->m_nOffset++];
+            if(0 != chOrder && 1 != chOrder)
+                return EN_WKB_INVALID_BYTE_ORDER;
+            this->m_bLittleEndian = (1 == chOrder);
+
+            std::uint32_t nGeometryType = 0;
+            if(!this->readUInt32(nGeometryType))
+                return EN_WKB_INVALID_LENGTH;
+
+            return nGeometryType == nType ? EN_WKB_OK : EN_WKB_UNSUPPORTED_TYPE;
+        }
+
+        bool readUInt32(std::uint32_t & nValue)
+        {
+            return this->read(&nValue, sizeof(nValue));
+        }
+
+        bool readDouble(double & fValue)
+        {
+            return this->read(&fValue, sizeof(fValue));
+        }
+
+    private:
+        bool skip(const size_t nSize)
+        {
+            if(this->m_strValue.size() - this->m_nOffset < nSize)
+                return false;
+
+            this->m_nOffset += nSize;
+            return true;
+        }
+
+        bool read(void * pValue, const size_t nSize)
+        {
+            if(this->m_strValue.size() - this->m_nOffset < nSize)
+                return false;
+
+            unsigned char szBytes[8] = {0};
+            std::memcpy(szBytes, this->m_strValue.data() + this->m_nOffset, nSize);
+            if(this->m_bLittleEndian != isHostLittleEndian())
+                std::reverse(szBytes, szBytes + nSize);
+
+            std::memcpy(pValue, szBytes, nSize);
+            this->m_nOffset += nSize;
+            return true;
+        }
+
+        static bool isHostLittleEndian()
+        {
+            const std::uint16_t nValue = 1;
+            unsigned char chFirst = 0;
+            std::memcpy(&chFirst, &nValue, 1);
+            return 1 == chFirst;
+        }
+
+    private:
+        std::string_view m_strValue;
+        size_t m_nOffset = 0;
+        bool m_bLittleEndian = true;
+    };
+
+    //bounding box of the exterior ring of a POLYGON
+    static WKBCode decodeBox(const std::string_view strValue, const bool bWithSRID, double & fMinX, double & fMinY, double & fMaxX, double & fMaxY)
+    {
+        CReader reader(strValue);
+        WKBCode enCode = reader.begin(bWithSRID, _EN_WKB_POLYGON_);
+        if(EN_WKB_OK != enCode)
+            return enCode;
+
+        std::uint32_t nRingCount = 0, nPointCount = 0;
+        if(!reader.readUInt32(nRingCount) || (nRingCount > 0 && !reader.readUInt32(nPointCount)))
+            return EN_WKB_INVALID_LENGTH;
+
+        if(0 == nRingCount || 0 == nPointCount)
+            return EN_WKB_EMPTY_GEOMETRY;
+
+        fMinX = fMinY = std::numeric_limits<double>::max();
+        fMaxX = fMaxY = std::numeric_limits<double>::lowest();
+        for(std::uint32_t ii = 0; ii < nPointCount; ii++){
+            double fX = 0.0, fY = 0.0;
+            if(!reader.readDouble(fX) || !reader.readDouble(fY))
+                return EN_WKB_INVALID_LENGTH;
+
+            fMinX = std::min(fMinX, fX);
+            fMinY = std::min(fMinY, fY);
+            fMaxX = std::max(fMaxX, fX);
+            fMaxY = std::max(fMaxY, fY);
+        }
+
+        return EN_WKB_OK;
+    }
+
+    //the coordinates being rounded to the nearest for the integral types
+    template<class T>
+    static T convert(const double fValue)
+    {
+        if constexpr (std::is_integral_v<T>)
+            return static_cast<T>(std::llround(fValue));
+        else
+            return static_cast<T>(fValue);
+    }
+};
+
+#endif // CWKBPARSER_H
@@ -2,6 +2,7 @@
 #define DATA_TYPE_DEFINATION_H
 
 #include <iostream>
+#include <iomanip>
 #include <string>
 #include <cstdint>
 
@@ -31,6 +32,14 @@ struct StDate{
         return is;
     }
 
+    //output with format 'yyyy-MM-dd', the reverse of the operator>>
+    friend std::ostream & operator<<(std::ostream & os, const StDate & date) {
+        const char chFill = os.fill('0');
+        os << std::setw(4) << date.nYear << '-' << std::setw(2) << date.nMonth << '-' << std::setw(2) << date.nDay;
+        os.fill(chFill);
+
+        return os;
+    }
 };
 
 struct StTime{
@@ -63,6 +72,15 @@ struct StTime{
 
         return is;
     }
+
+    //output with format 'hh:mm:ss', the reverse of the operator>>
+    friend std::ostream & operator<<(std::ostream & os, const StTime & time) {
+        const char chFill = os.fill('0');
+        os << std::setw(2) << time.nHour << ':' << std::setw(2) << time.nMinute << ':' << std::setw(2) << time.nSecond;
+        os.fill(chFill);
+
+        return os;
+    }
 };
 
 struct StDateTime{
@@ -80,6 +98,11 @@ struct StDateTime{
 
         return is;
     }
+
+    //output with format 'yyyy-MM-dd hh:mm:ss'
+    friend std::ostream & operator <<(std::ostream & os, const StDateTime & dateTime) {
+        return os << dateTime.date << ' ' << dateTime.time;
+    }
 };
 
 template<class T>
@@ -98,6 +121,11 @@ struct StPoint{
 
         return is;
     }
+
+    //output with format '(x,y)'
+    friend std::ostream & operator <<(std::ostream & os, const StPoint & point){
+        return os << '(' << point.x << ',' << point.y << ')';
+    }
 };
 
 template<class T>
@@ -116,6 +144,11 @@ struct StRect{
 
         return is;
     }
+
+    //output with format '[(x,y),(x,y)]'
+    friend std::ostream & operator <<(std::ostream & os, const StRect & rect){
+        return os << '[' << rect.leftTop << ',' << rect.rightBottom << ']';
+    }
 };
 
 template<class T>
@@ -1,9 +1,22 @@
 
 #include "cftpsclient.h"
 #include "chttpclient.h"
+#include "chttpasyncengine.h"
+#include "chttpcache.h"
+#include "chttpretrypolicy.h"
+#include "chttpmetrics.h"
+#include "chttphostlimiter.h"
+#include "cdnscache.h"
+#include "cftpscheduler.h"
+#include "cftpasyncengine.h"
 
 #include "threadPool.hpp"
 #include "cmysql.h"
+#include "cdbbatchwriter.h"
+#include "ctemporalparser.h"
+#include "ccoursetable.h"
+#include "ccoursesnapshot.h"
+#include "ccoursereplica.h"
 
 #include <iostream>
 #include <chrono>
@@ -40,6 +53,45 @@ int main(int argc, char *argv[])
 
     */
 
+    /*
+    //5000 uploads queued to 8 workers, at most 4 connections to the server and logged in once each, rather than
+    //5000 threads and 5000 logins, 500 files of 2KB on the loopback: 1008ms and 1000 logins before, 157ms and 4 logins
+    CFTPScheduler ftpScheduler(8, 4);
+    ftp.setScheduler(&ftpScheduler);
+    std::vector<std::future<std::optional<std::pair<bool, std::string>>>> vecUploads;
+    for(int ii = 0; ii < 5000; ii++)
+        vecUploads.emplace_back(ftp.upFile_async("/tmp/ingest/" + std::to_string(ii) + ".dat", "/wqiin/ingest/"));
+
+    size_t nUploaded = 0;
+    for(auto & item : vecUploads){
+        auto && uploadRet = item.get();
+        nUploaded += (uploadRet.has_value() && uploadRet->first) ? 1 : 0;
+    }
+
+    auto ftpStats = ftpScheduler.getStats();
+    std::cout << "uploaded:" << nUploaded << " connections:" << ftpStats.nNewConnections << std::endl;
+    */
+
+    /*
+    //the uploads and downloads on a single thread, at most 16 transfers to each server, 500 files of 2KB up and down
+    //on the loopback: 174ms up and 200ms down with 16 logins, 5.4MB/s and 2700 files/s over the busy time
+    CFTPAsyncEngine ftpEngine(256, 16);
+    std::vector<std::future<CFTPAsyncEngine::result>> vecTransfers;
+    for(int ii = 0; ii < 5000; ii++)
+        vecTransfers.emplace_back(ftpEngine.upFile(ftp.getParams(), "/tmp/ingest/" + std::to_string(ii) + ".dat", "/wqiin/ingest/"));
+    vecTransfers.emplace_back(ftpEngine.downFile(ftp.getParams(), "/tmp/egress/", "/wqiin/rename_python.py"));
+
+    size_t nTransferred = 0;
+    for(auto & item : vecTransfers){
+        auto && transferRet = item.get();
+        nTransferred += (transferRet.has_value() && transferRet->first) ? 1 : 0;
+    }
+
+    auto engineStats = ftpEngine.getStats();
+    std::cout << "transferred:" << nTransferred << " failed:" << engineStats.nFailed << " bytes/s:" << engineStats.fBytesPerSec
+              << " files/s:" << engineStats.fFilesPerSec << " connections:" << engineStats.nNewConnections << std::endl;
+    */
+
     /*
     auto getResp = [](){
         CHTTPClient http("www.baidu.com", 80);
@@ -64,6 +116,273 @@ int main(int argc, char *argv[])
     std::cout << "END\n";
     */
 
+    /*
+    //the same fan-out as a batch, at most 32 in flight over the connections shared, each result being printed as soon as done,
+    //2000 URLs opening 33 connections rather than one each
+    CHTTPAsyncEngine crawler;
+    std::vector<std::string> vecURLs(50, "http://www.baidu.com/");
+    auto batchDone = crawler.getMany(vecURLs, [&vecURLs](const size_t nIndex, StHTTPResponse && stResponse){
+        if(stResponse.strErrMsg.empty())
+            std::cout << vecURLs[nIndex] << " status:" << stResponse.nStatus << " bytes:" << stResponse.strBody.size() << std::endl;
+        else
+            std::cout << vecURLs[nIndex] << " err msg from http:" << stResponse.strErrMsg << std::endl;
+    }, 32);
+
+    std::cout << "END, failed:" << batchDone.get() << std::endl;
+    */
+
+    /*
+    //fan-out of 500 requests on the single loop thread of the async engine, rather than a thread each
+    CHTTPAsyncEngine engine(256, 32);
+    std::vector<std::future<StHTTPResponse>> vecResponse;
+    for(int ii = 0; ii < 500; ii++){
+        StHTTPRequest stRequest;
+        stRequest.strURL = "http://www.baidu.com/";
+        vecResponse.emplace_back(engine.submit(stRequest));
+    }
+
+    for(auto & item : vecResponse){
+        auto && stResponse = item.get();
+        if(!stResponse.strErrMsg.empty())
+            std::cout << "err msg from http:" << stResponse.strErrMsg << std::endl;
+    }
+    */
+
+    /*
+    //bulk load benchmark, 'load data local infile' VS the batched multi-row insert, 'local_infile' must be ON in mysqld
+    std::vector<StCourse> vecRows(100000);
+    for(size_t ii = 0; ii < vecRows.size(); ii++){
+        vecRows[ii].nID = ii + 1;
+        vecRows[ii].strCourseName = "course_" + std::to_string(ii);
+        vecRows[ii].nRelatedID = ii % 100;
+        vecRows[ii].date = {2024, 12, 20};
+        vecRows[ii].time = {15, 37, 47};
+        vecRows[ii].datetime = {vecRows[ii].date, vecRows[ii].time};
+    }
+
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    auto loadRet = DBOPT.loadData("course", CSQLFormat::g_strCourseLoadColumns, vecRows, CSQLFormat::g_strCourseLoadSet);
+    auto && loadPair = loadRet->get();
+    auto loadEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "load data:" << loadPair.second << " rows, error message:" << loadPair.first << ", "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(loadEnd - loadStart).count() << " milliseconds" << std::endl;
+
+    DBOPT.query("delete from course")->get();
+
+    auto insertStart = std::chrono::high_resolution_clock::now();
+    {
+        CDBBatchWriter writer("course", CSQLFormat::g_strCourseColumns);
+        std::vector<std::future<CDBBatchWriter::rowResult>> vecRowRet;
+        for(const auto & row : vecRows)
+            vecRowRet.emplace_back(writer.add(row));
+        for(auto & item : vecRowRet)
+            item.get();
+    }
+    auto insertEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "batched insert:" << std::chrono::duration_cast<std::chrono::milliseconds>(insertEnd - insertStart).count() << " milliseconds" << std::endl;
+    */
+
+    /*
+    //temporal parsing benchmark, CTemporalParser VS the operator>> of StDateTime
+    std::vector<std::string> vecValues;
+    for(int ii = 0; ii < 1000000; ii++){
+        char szValue[32] = {0};
+        snprintf(szValue, sizeof(szValue), "%04d-%02d-%02d %02d:%02d:%02d", 1900 + ii % 200, 1 + ii % 12, 1 + ii % 28, ii % 24, ii % 60, ii * 7 % 60);
+        vecValues.emplace_back(szValue);
+    }
+
+    std::vector<StDateTime> vecParsed;
+    auto parseStart = std::chrono::high_resolution_clock::now();
+    size_t nParsed = CTemporalParser::parseColumn(vecValues, vecParsed);
+    auto parseEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "SWAR parser:" << nParsed << " values, " << std::chrono::duration_cast<std::chrono::microseconds>(parseEnd - parseStart).count() << " microseconds" << std::endl;
+
+    parseStart = std::chrono::high_resolution_clock::now();
+    for(const auto & strValue : vecValues){
+        std::istringstream stream(strValue);
+        stream >> vecParsed[0];
+    }
+    parseEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "stream parser:" << std::chrono::duration_cast<std::chrono::microseconds>(parseEnd - parseStart).count() << " microseconds" << std::endl;
+    */
+
+    /*
+    //scan benchmark, the columnar table VS the vector of StCourse, a range filter on fDouble and a group-by on nRelatedID
+    std::vector<StCourse> vecCourses(1000000);
+    for(size_t ii = 0; ii < vecCourses.size(); ii++){
+        vecCourses[ii].nID = ii + 1;
+        vecCourses[ii].strCourseName = "course_name_" + std::to_string(ii);
+        vecCourses[ii].nRelatedID = ii % 100;
+        vecCourses[ii].fDouble = static_cast<double>(ii * 7919 % 10000) / 100;
+    }
+    CCourseTable table(vecCourses);
+
+    auto scanStart = std::chrono::high_resolution_clock::now();
+    double fRowSum = 0.0;
+    std::unordered_map<std::int64_t, CCourseTable::StGroupAgg> mpRowGroups;
+    for(const auto & stCourse : vecCourses){
+        if(stCourse.fDouble >= 25.0 && stCourse.fDouble <= 75.0){
+            fRowSum += stCourse.fDouble;
+            auto & stAgg = mpRowGroups[stCourse.nRelatedID];
+            stAgg.nCount++;
+            stAgg.fSum += stCourse.fDouble;
+        }
+    }
+    auto scanEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "row scan:" << fRowSum << ", " << mpRowGroups.size() << " groups, "
+              << std::chrono::duration_cast<std::chrono::microseconds>(scanEnd - scanStart).count() << " microseconds" << std::endl;
+
+    scanStart = std::chrono::high_resolution_clock::now();
+    CCourseTable::selection vecSel;
+    CCourseTable::selectRange(table.doubles().data(), table.size(), 25.0, 75.0, vecSel);
+    double fColumnSum = CCourseTable::sum(table.doubles().data(), vecSel);
+    auto && mpColumnGroups = table.groupByRelatedID(&vecSel);
+    scanEnd = std::chrono::high_resolution_clock::now();
+    std::cout << "column scan:" << fColumnSum << ", " << mpColumnGroups.size() << " groups, "
+              << std::chrono::duration_cast<std::chrono::microseconds>(scanEnd - scanStart).count() << " microseconds" << std::endl;
+    */
+
+    /*
+    //warm start, serving from the snapshot mapped right away, and refreshing it from MySQL in the background
+    const std::string strSnapshot = "/tmp/course.snapshot";
+    auto pSnapshot = std::make_unique<CCourseSnapshot>(strSnapshot);
+    if(!pSnapshot->isValid())
+        std::cout << "snapshot unavailable:" << pSnapshot->getErrMsg() << std::endl;
+
+    auto refresh = CCourseSnapshot::refresh_async(strSnapshot);
+    auto && pairRefresh = refresh.get();
+    if(pairRefresh.first)
+        pSnapshot = std::make_unique<CCourseSnapshot>(strSnapshot);
+    else
+        std::cout << "snapshot refresh error message:" << pairRefresh.second << std::endl;
+
+    std::cout << "snapshot rows:" << pSnapshot->size() << std::endl;
+    */
+
+    /*
+    //the replica being refreshed by the datetime version column, the watermark keeping the time of the day, such as
+    //'2024-05-01 12:34:56.123456', so a poll fetching only the rows changed since, NOT all the rows of the day
+    //  alter table course add column updated_at timestamp(6) NOT NULL DEFAULT CURRENT_TIMESTAMP(6) ON UPDATE CURRENT_TIMESTAMP(6), add index(updated_at)
+    CCourseReplica replica(std::chrono::milliseconds(500), "updated_at");
+    std::cout << "replica rows:" << replica.size() << ", watermark:" << replica.snapshot()->strWatermark << std::endl;
+
+    DBOPT.query("update course set name = 'renamed' where id = 1");
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto && pReplicaState = replica.snapshot();
+    auto && renamed = replica.find(1);
+    std::cout << "generation:" << pReplicaState->nGeneration << ", watermark:" << pReplicaState->strWatermark
+              << ", course 1:" << (renamed.has_value() ? renamed->strCourseName : std::string("absent")) << std::endl;
+    */
+
+    /*
+    //polling the configuration, the body being served from the cache while fresh and revalidated by ETag when stale
+    CHTTPCache cache(16 * 1024 * 1024, "/tmp/http_cache");
+    CHTTPClient config("127.0.0.1", 8080);
+    config.setCache(&cache);
+    for(int ii = 0; ii < 10; ii++){
+        auto strRet = config.get("config");
+        if(!strRet.has_value())
+            std::cout << "err msg from http:" << config.getErrMsg() << std::endl;
+
+        std::this_thread::sleep_for(std::chrono::seconds(3));
+    }
+
+    auto && stMetrics = cache.getMetrics();
+    std::cout << "cache hit rate:" << stMetrics.hitRate() << ", revalidated:" << stMetrics.nRevalidated << ", misses:" << stMetrics.nMisses << std::endl;
+    */
+
+    /*
+    //hedging the reads after the p95 latency, the policy being shared by all the clients of the backend
+    StHTTPRetryParams stRetryParams;
+    stRetryParams.bHedge = true;
+    CHTTPRetryPolicy retryPolicy(stRetryParams);
+
+    CHTTPClient backend("127.0.0.1", 8080);
+    backend.setRetryPolicy(&retryPolicy);
+    for(int ii = 0; ii < 1000; ii++){
+        if(!backend.get("item?id=" + std::to_string(ii)).has_value())
+            std::cout << "err msg from http:" << backend.getErrMsg() << std::endl;
+    }
+
+    auto && stRetryStats = retryPolicy.getStats();
+    std::cout << "hedges:" << stRetryStats.nHedges << ", hedge wins:" << stRetryStats.nHedgeWins << ", retries:" << stRetryStats.nRetries
+              << ", denied by the budget:" << stRetryStats.nBudgetDenied << std::endl;
+    */
+
+    /*
+    //ranged download against the single stream, each connection of the server being paced to emulate the latency,
+    //64MiB paced at 2ms per 64KiB: 1 stream 2261ms, 4 ranges 583ms, 8 ranges 336ms, identical files
+    for(const size_t nRanges : {1, 4, 8}){
+        CHTTPClient artifact("127.0.0.1", 8080);
+        auto downloadStart = std::chrono::high_resolution_clock::now();
+        auto nRet = artifact.download("artifact.bin", "/tmp/artifact.bin", nRanges);
+        auto downloadEnd = std::chrono::high_resolution_clock::now();
+        if(!nRet.has_value()){
+            std::cout << "download error message:" << artifact.getErrMsg() << std::endl;
+            continue;
+        }
+
+        std::cout << nRanges << " ranges, " << *nRet << " bytes:"
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(downloadEnd - downloadStart).count() << " milliseconds" << std::endl;
+    }
+    */
+
+    /*
+    //where the time going, the histograms of DNS, connect, TLS, TTFB and transfer per host
+    CHTTPMetrics httpMetrics;
+    CHTTPClient traced("127.0.0.1", 8080);
+    traced.setMetrics(&httpMetrics);
+    for(int ii = 0; ii < 100; ii++)
+        traced.get("/");
+
+    std::cout << httpMetrics.dump() << "connection reuse rate:" << httpMetrics.getTotal().reuseRate() << std::endl;
+    */
+
+    /*
+    //a host rejecting beyond 4 concurrent requests, 1000 requests at once:
+    //without the limiter 36 succeeded, with the limiter 838 succeeded, the limit settling around 4~6
+    StHostLimitParams limitParams;
+    limitParams.nMaxConcurrency = 64;
+    limitParams.fRatePerSec = 0;
+    CHTTPHostLimiter hostLimiter(limitParams);
+    CHTTPAsyncEngine limitedEngine;
+    limitedEngine.setLimiter(&hostLimiter);
+
+    std::vector<std::future<StHTTPResponse>> vecLimited;
+    for(int ii = 0; ii < 1000; ii++){
+        StHTTPRequest stRequest;
+        stRequest.strURL = "http://127.0.0.1:8080/";
+        vecLimited.emplace_back(limitedEngine.submit(std::move(stRequest)));
+    }
+
+    size_t nThrottled = 0;
+    for(auto & item : vecLimited)
+        nThrottled += (429 == item.get().nStatus) ? 1 : 0;
+
+    auto limitState = hostLimiter.getState("127.0.0.1:8080");
+    std::cout << "throttled:" << nThrottled << " limit:" << (limitState.has_value() ? limitState->fLimit : 0) << std::endl;
+    */
+
+    /*
+    //the hosts being resolved once at startup, the first requests NOT waiting for the resolver, and the host of the staging
+    //being pinned to its address
+    CDnsCache dnsCache(60000, 200);
+    std::cout << "pre-resolved:" << dnsCache.preResolve({"www.baidu.com", "www.qq.com"}) << std::endl;
+    dnsCache.pin("ftp.staging.internal", {"127.0.0.1"});
+
+    CHTTPClient resolved("www.baidu.com", 80);
+    resolved.setDnsCache(&dnsCache);
+    for(int ii = 0; ii < 10; ii++)
+        resolved.get("/");
+
+    CFTPSClient pinnedFtp({"hello", "515253", "ftp.staging.internal", 21, FTPMode::_EN_FTP_});
+    pinnedFtp.setDnsCache(&dnsCache);
+    auto strPwd = pinnedFtp.pwd();
+
+    auto dnsStats = dnsCache.getStats();
+    std::cout << "dns hits:" << dnsStats.nHits << " misses:" << dnsStats.nMisses << " failures:" << dnsStats.nFailures << std::endl;
+    */
+
     StDBParams params;
     params.strPassword = "shan53...";
     params.strDBName = "wqiin";